@@ -0,0 +1,883 @@
+#include <JuceHeader.h>
+#include "NoiseGenerator.h"
+#include "EnvelopeGenerator.h"
+#include "LFOGenerator.h"
+#include "RandomModulator.h"
+#include "ControlRateModulation.h"
+#include "ModulationMatrix.h"
+#include "VoiceEngine.h"
+#include "MultiStageEnvelope.h"
+#include "StepSequencer.h"
+#include "PresetMorph.h"
+#include "FilterProcessor.h"
+#include "EffectsProcessor.h"
+#include "Oversampler.h"
+#include "Waveshaper.h"
+#include "ConvolutionReverb.h"
+#include "FDNReverb.h"
+#include "StereoDelay.h"
+#include "Compressor.h"
+#include "Phaser.h"
+#include "TruePeakLimiter.h"
+
+#include <iostream>
+
+//==============================================================================
+// Simple wall-clock benchmark harness for the DSP classes.
+//
+// Each benchmark processes a fixed amount of audio and reports the average
+// cost per sample frame and the resulting real-time factor at 48 kHz.
+namespace
+{
+    constexpr double benchSampleRate = 48000.0;
+    constexpr int benchSeconds = 20;
+
+    void fillWithNoise(juce::AudioBuffer<float>& buffer, juce::Random& random)
+    {
+        for (int channel = 0; channel < buffer.getNumChannels(); ++channel)
+        {
+            float* data = buffer.getWritePointer(channel);
+            for (int sample = 0; sample < buffer.getNumSamples(); ++sample)
+                data[sample] = random.nextFloat() * 2.0f - 1.0f;
+        }
+    }
+
+    // Runs processBlock() over benchSeconds of audio in blocks of blockSize
+    // and prints the average cost per sample frame.
+    template <typename ProcessFn>
+    void runBenchmark(const juce::String& name, int blockSize, ProcessFn&& processBlock)
+    {
+        juce::AudioBuffer<float> source(2, blockSize);
+        juce::AudioBuffer<float> buffer(2, blockSize);
+        juce::Random random(1234);
+        fillWithNoise(source, random);
+
+        const int numBlocks = static_cast<int>(benchSampleRate * benchSeconds) / blockSize;
+
+        // Warm up caches and let any lazily computed state settle
+        for (int block = 0; block < 64; ++block)
+        {
+            buffer.makeCopyOf(source, true);
+            processBlock(buffer);
+        }
+
+        juce::int64 elapsedTicks = 0;
+        for (int block = 0; block < numBlocks; ++block)
+        {
+            buffer.makeCopyOf(source, true);
+
+            const auto start = juce::Time::getHighResolutionTicks();
+            processBlock(buffer);
+            elapsedTicks += juce::Time::getHighResolutionTicks() - start;
+        }
+
+        const double seconds = juce::Time::highResolutionTicksToSeconds(elapsedTicks);
+        const double nsPerFrame = seconds * 1.0e9 / (static_cast<double>(numBlocks) * blockSize);
+        const double realtimeFactor = benchSeconds / juce::jmax(seconds, 1.0e-9);
+
+        std::cout << name.paddedRight(' ', 40)
+                  << " block " << juce::String(blockSize).paddedLeft(' ', 5)
+                  << "  " << juce::String(nsPerFrame, 2).paddedLeft(' ', 9) << " ns/frame"
+                  << "  " << juce::String(realtimeFactor, 1).paddedLeft(' ', 9) << "x realtime"
+                  << std::endl;
+    }
+
+    //==============================================================================
+    // Filter + drive + bitcrush at each oversampling factor, as run by the plugin
+    void benchmarkOversampling()
+    {
+        std::cout << "\n-- Oversampled nonlinear section --" << std::endl;
+
+        const int blockSize = 512;
+
+        for (int factor = Oversampler::Factor1x; factor < Oversampler::NumFactors; ++factor)
+        {
+            Oversampler oversampler;
+            FilterProcessor filter;
+            EffectsProcessor effects;
+
+            oversampler.setFactor(static_cast<Oversampler::Factor>(factor));
+            oversampler.prepareToPlay(benchSampleRate, blockSize, 2);
+
+            const int multiplier = oversampler.getOversamplingMultiplier();
+            filter.prepareToPlay(benchSampleRate * multiplier, blockSize * multiplier);
+            effects.prepareToPlay(benchSampleRate * multiplier, blockSize * multiplier);
+            effects.setOversamplingFactor(multiplier);
+
+            filter.setCutoffFrequency(2000.0f);
+            filter.setResonance(0.9f);
+            effects.setDrive(0.8f);
+            effects.setBitcrush(8.0f);
+
+            runBenchmark("Nonlinear section " + juce::String(multiplier) + "x", blockSize,
+                         [&](juce::AudioBuffer<float>& buffer)
+                         {
+                             auto oversampledBuffer = oversampler.processSamplesUp(buffer, buffer.getNumSamples());
+                             filter.processBlock(oversampledBuffer, oversampledBuffer.getNumSamples());
+                             effects.processNonlinearBlock(oversampledBuffer, oversampledBuffer.getNumSamples());
+                             oversampler.processSamplesDown(buffer, buffer.getNumSamples());
+                         });
+
+            std::cout << "    latency: " << oversampler.getLatencySamples() << " samples" << std::endl;
+        }
+    }
+
+    //==============================================================================
+    // Reference copy of the original per-sample EffectsProcessor loop, kept so
+    // the block kernels can be compared against it
+    struct PerSampleEffects
+    {
+        float drive = 0.0f;
+        float bitDepth = 16.0f;
+        float stereoWidth = 1.0f;
+        float bitCrushPhase = 0.0f;
+        float bitCrushLastSampleL = 0.0f;
+        float bitCrushLastSampleR = 0.0f;
+
+        void processBlock(juce::AudioBuffer<float>& buffer, int numSamples)
+        {
+            for (int sample = 0; sample < numSamples; ++sample)
+            {
+                float left = applyBitCrush(applyDrive(buffer.getSample(0, sample)), 0);
+                float right = applyBitCrush(applyDrive(buffer.getSample(1, sample)), 1);
+                applyStereoWidth(left, right);
+                buffer.setSample(0, sample, left);
+                buffer.setSample(1, sample, right);
+            }
+        }
+
+        float applyDrive(float sample)
+        {
+            if (drive <= 0.0f)
+                return sample;
+
+            const float driveAmount = 1.0f + drive * 9.0f;
+            return std::tanh(sample * driveAmount) / (0.5f * drive + 0.5f);
+        }
+
+        float applyBitCrush(float sample, int channel)
+        {
+            if (bitDepth >= 16.0f)
+                return sample;
+
+            const int levels = static_cast<int>(std::pow(2.0f, bitDepth) - 1.0f);
+            const float crushedSample = std::round(sample * levels) / static_cast<float>(levels);
+
+            if (bitDepth <= 8.0f)
+            {
+                const float srReductionFactor = 0.5f * (8.0f - bitDepth) / 8.0f;
+                bitCrushPhase += 1.0f / (1.0f + srReductionFactor * 40.0f);
+
+                if (bitCrushPhase >= 1.0f)
+                {
+                    bitCrushPhase -= 1.0f;
+                    (channel == 0 ? bitCrushLastSampleL : bitCrushLastSampleR) = crushedSample;
+                }
+
+                return (channel == 0) ? bitCrushLastSampleL : bitCrushLastSampleR;
+            }
+
+            return crushedSample;
+        }
+
+        void applyStereoWidth(float& left, float& right)
+        {
+            if (std::abs(stereoWidth - 1.0f) < 0.01f)
+                return;
+
+            const float mid = (left + right) * 0.5f;
+            const float side = (left - right) * 0.5f * stereoWidth;
+            left = mid + side;
+            right = mid - side;
+        }
+    };
+
+    //==============================================================================
+    // Per-sample reference loop against the block kernels
+    void benchmarkEffectsKernels()
+    {
+        std::cout << "\n-- EffectsProcessor: per-sample vs block kernels --" << std::endl;
+
+        struct Setting { const char* name; float drive; float bitDepth; float width; };
+        const Setting settings[] = {
+            { "all stages", 0.6f, 10.0f, 1.5f },
+            { "drive only", 0.6f, 16.0f, 1.0f },
+            { "all bypassed", 0.0f, 16.0f, 1.0f }
+        };
+
+        for (const auto& setting : settings)
+        {
+            for (int blockSize : { 64, 256, 1024 })
+            {
+                PerSampleEffects reference;
+                reference.drive = setting.drive;
+                reference.bitDepth = setting.bitDepth;
+                reference.stereoWidth = setting.width;
+
+                runBenchmark(juce::String("per-sample, ") + setting.name, blockSize,
+                             [&](juce::AudioBuffer<float>& buffer)
+                             {
+                                 reference.processBlock(buffer, buffer.getNumSamples());
+                             });
+
+                EffectsProcessor effects;
+                effects.prepareToPlay(benchSampleRate, blockSize);
+                effects.setDrive(setting.drive);
+                effects.setBitcrush(setting.bitDepth);
+                effects.setStereoWidth(setting.width);
+
+                runBenchmark(juce::String("block, ") + setting.name, blockSize,
+                             [&](juce::AudioBuffer<float>& buffer)
+                             {
+                                 effects.processBlock(buffer, buffer.getNumSamples());
+                             });
+            }
+        }
+    }
+
+    //==============================================================================
+    // Quantiser alone vs decimation, which quantises only on hold boundaries
+    void benchmarkBitCrusher()
+    {
+        std::cout << "\n-- Bit crusher decimation --" << std::endl;
+
+        const int blockSize = 512;
+
+        for (float rate : { 1.0f, 2.0f, 8.0f, 32.0f })
+        {
+            EffectsProcessor effects;
+            effects.prepareToPlay(benchSampleRate, blockSize);
+            effects.setBitcrush(6.0f);
+            effects.setCrushRate(rate);
+
+            runBenchmark("6-bit, rate / " + juce::String(rate, 0), blockSize,
+                         [&](juce::AudioBuffer<float>& buffer)
+                         {
+                             effects.processNonlinearBlock(buffer, buffer.getNumSamples());
+                         });
+        }
+    }
+
+    //==============================================================================
+    // Plain tanh against the ADAA modes; compare with the oversampled section
+    // above for the cost of the alternative
+    // Holds the input well past the antiderivatives' |x| = 40 range at full
+    // drive and checks every mode still saturates to about +-1
+    bool checkHotDrive()
+    {
+        constexpr int blockSize = 512;
+        constexpr int holdLength = 64;
+        bool passed = true;
+
+        for (int mode = EffectsProcessor::DriveStandard; mode < EffectsProcessor::NumDriveModes; ++mode)
+        {
+            EffectsProcessor effects;
+            effects.prepareToPlay(benchSampleRate, blockSize);
+            effects.setDrive(1.0f);
+            effects.setDriveMode(static_cast<EffectsProcessor::DriveMode>(mode));
+
+            juce::AudioBuffer<float> buffer(2, blockSize);
+            for (int channel = 0; channel < 2; ++channel)
+                for (int sample = 0; sample < blockSize; ++sample)
+                {
+                    // Wobbles, so the divided differences are exercised
+                    const float level = 6.0f + 0.5f * std::sin(0.3f * static_cast<float>(sample));
+                    buffer.setSample(channel, sample, ((sample / holdLength) & 1) != 0 ? -level : level);
+                }
+
+            effects.processNonlinearBlock(buffer, blockSize);
+
+            // Skip the first samples of each hold, where ADAA is between levels
+            for (int sample = 0; sample < blockSize; ++sample)
+            {
+                const float expected = ((sample / holdLength) & 1) != 0 ? -1.0f : 1.0f;
+                if (sample % holdLength >= 4 && std::abs(buffer.getSample(0, sample) - expected) > 0.01f)
+                {
+                    std::cout << "FAIL: drive mode " << mode << " gives " << buffer.getSample(0, sample)
+                              << " at sample " << sample << ", expected " << expected << std::endl;
+                    passed = false;
+                    break;
+                }
+            }
+        }
+
+        return passed;
+    }
+
+    void benchmarkDriveModes()
+    {
+        std::cout << "\n-- Drive modes --" << std::endl;
+
+        const int blockSize = 512;
+
+        PerSampleEffects reference;
+        reference.drive = 0.8f;
+
+        runBenchmark("std::tanh (per-sample reference)", blockSize,
+                     [&](juce::AudioBuffer<float>& buffer)
+                     {
+                         reference.processBlock(buffer, buffer.getNumSamples());
+                     });
+
+        const char* modeNames[] = { "Standard", "ADAA 1st order", "ADAA 2nd order" };
+
+        for (int mode = EffectsProcessor::DriveStandard; mode < EffectsProcessor::NumDriveModes; ++mode)
+        {
+            EffectsProcessor effects;
+            effects.prepareToPlay(benchSampleRate, blockSize);
+            effects.setDrive(0.8f);
+            effects.setDriveMode(static_cast<EffectsProcessor::DriveMode>(mode));
+
+            runBenchmark(juce::String("drive, ") + modeNames[mode], blockSize,
+                         [&](juce::AudioBuffer<float>& buffer)
+                         {
+                             effects.processNonlinearBlock(buffer, buffer.getNumSamples());
+                         });
+        }
+    }
+
+    void benchmarkDriveCurves()
+    {
+        std::cout << "\n-- Drive curves (table lookup) --" << std::endl;
+
+        const int blockSize = 512;
+        const char* curveNames[] = { "Tanh", "Soft Clip", "Hard Clip", "Tube", "Foldback", "Diode" };
+
+        for (int curve = Waveshaper::Tanh; curve < Waveshaper::NumCurves; ++curve)
+        {
+            Waveshaper shaper;
+            shaper.setCurve(static_cast<Waveshaper::Curve>(curve));
+            shaper.setDrive(0.8f);
+            shaper.applyPendingTable();
+
+            runBenchmark(juce::String("waveshaper, ") + curveNames[curve], blockSize,
+                         [&](juce::AudioBuffer<float>& buffer)
+                         {
+                             for (int channel = 0; channel < buffer.getNumChannels(); ++channel)
+                                 shaper.processBlock(buffer.getWritePointer(channel), buffer.getNumSamples());
+                         });
+        }
+    }
+
+    void benchmarkStereoModes()
+    {
+        std::cout << "\n-- Noise generator stereo modes --" << std::endl;
+
+        const int blockSize = 512;
+        const char* typeNames[] = { "White", "Pink", "Brown", "Digital", "Analog" };
+        const char* modeNames[] = { "Independent", "Decorrelated" };
+
+        for (int type = NoiseGenerator::WhiteNoise; type < NoiseGenerator::NumNoiseTypes; ++type)
+        {
+            for (int mode = NoiseGenerator::StereoIndependent; mode < NoiseGenerator::NumStereoModes; ++mode)
+            {
+                NoiseGenerator generator;
+                generator.prepareToPlay(benchSampleRate, blockSize);
+                generator.setNoiseType(static_cast<NoiseGenerator::NoiseType>(type));
+                generator.setStereoMode(static_cast<NoiseGenerator::StereoMode>(mode));
+                generator.setDecorrelation(0.8f);
+
+                runBenchmark(juce::String(typeNames[type]) + ", " + modeNames[mode], blockSize,
+                             [&](juce::AudioBuffer<float>& buffer)
+                             {
+                                 generator.processBlock(buffer, buffer.getNumSamples());
+                             });
+            }
+        }
+    }
+
+    void benchmarkConvolutionReverb()
+    {
+        std::cout << "\n-- Convolution reverb (audio thread share, 2 s IR) --" << std::endl;
+
+        const int blockSize = 512;
+        const char* modeNames[] = { "zero latency", "low latency" };
+
+        for (int mode = ConvolutionReverb::HeadZeroLatency; mode < ConvolutionReverb::NumHeadModes; ++mode)
+        {
+            for (int headSize = ConvolutionReverb::minHeadSize; headSize <= ConvolutionReverb::maxHeadSize; headSize *= 4)
+            {
+                ConvolutionReverb reverb;
+                reverb.setHeadSize(headSize);
+                reverb.setHeadMode(static_cast<ConvolutionReverb::HeadMode>(mode));
+                reverb.setDecay(2.0f);
+                reverb.setMix(0.5f);
+                reverb.prepareToPlay(benchSampleRate, blockSize);
+
+                // The tail thread runs alongside but isn't paced in real time
+                // here, so only the head convolution is measured reliably
+                runBenchmark(juce::String("head ") + juce::String(headSize) + ", " + modeNames[mode], blockSize,
+                             [&](juce::AudioBuffer<float>& buffer)
+                             {
+                                 reverb.processBlock(buffer, buffer.getNumSamples());
+                             });
+            }
+        }
+    }
+
+    void benchmarkFDNReverb()
+    {
+        std::cout << "\n-- FDN reverb --" << std::endl;
+
+        for (int blockSize : { 64, 512 })
+        {
+            FDNReverb reverb;
+            reverb.setMix(0.5f);
+            reverb.setDecay(2.0f);
+            reverb.prepareToPlay(benchSampleRate, blockSize);
+
+            runBenchmark("8 lines, block " + juce::String(blockSize), blockSize,
+                         [&](juce::AudioBuffer<float>& buffer)
+                         {
+                             reverb.processBlock(buffer, buffer.getNumSamples());
+                         });
+        }
+    }
+
+    void benchmarkStereoDelay()
+    {
+        std::cout << "\n-- Stereo delay --" << std::endl;
+
+        for (bool pingPong : { false, true })
+        {
+            StereoDelay delay;
+            delay.setMix(0.5f);
+            delay.setFeedback(0.6f);
+            delay.setPingPong(pingPong);
+            delay.prepareToPlay(benchSampleRate, 512);
+
+            runBenchmark(juce::String(pingPong ? "ping-pong" : "stereo") + ", static time", 512,
+                         [&](juce::AudioBuffer<float>& buffer)
+                         {
+                             delay.processBlock(buffer, buffer.getNumSamples());
+                         });
+        }
+
+        // Worst case: the tempo changes every block, so a crossfade is
+        // always running
+        StereoDelay delay;
+        delay.setMix(0.5f);
+        delay.setFeedback(0.6f);
+        delay.prepareToPlay(benchSampleRate, 512);
+        double tempo = 120.0;
+
+        runBenchmark("stereo, tempo changing", 512,
+                     [&](juce::AudioBuffer<float>& buffer)
+                     {
+                         tempo = tempo > 140.0 ? 120.0 : tempo + 0.5;
+                         delay.setTempo(tempo);
+                         delay.processBlock(buffer, buffer.getNumSamples());
+                     });
+    }
+
+    void benchmarkCompressor()
+    {
+        std::cout << "\n-- Compressor --" << std::endl;
+
+        // The sliding maximum should keep the cost flat as the window grows
+        for (float lookaheadMs : { 0.0f, 1.0f, 10.0f })
+        {
+            Compressor compressor;
+            compressor.setMode(Compressor::ModeCompress);
+            compressor.setThreshold(-24.0f);
+            compressor.setLookahead(lookaheadMs);
+            compressor.prepareToPlay(benchSampleRate, 512);
+
+            runBenchmark("compress, lookahead " + juce::String(lookaheadMs, 1) + " ms", 512,
+                         [&](juce::AudioBuffer<float>& buffer)
+                         {
+                             compressor.processBlock(buffer, buffer.getNumSamples());
+                         });
+        }
+
+        Compressor compressor;
+        compressor.setMode(Compressor::ModeDuck);
+        compressor.prepareToPlay(benchSampleRate, 512);
+
+        runBenchmark("duck", 512,
+                     [&](juce::AudioBuffer<float>& buffer)
+                     {
+                         compressor.processBlock(buffer, buffer.getNumSamples());
+                     });
+    }
+
+    void benchmarkPhaser()
+    {
+        std::cout << "\n-- Phaser --" << std::endl;
+
+        for (int numStages : { 4, 8, 12 })
+        {
+            Phaser phaser;
+            phaser.setMix(0.5f);
+            phaser.setStages(numStages);
+            phaser.prepareToPlay(benchSampleRate, 512);
+
+            runBenchmark(juce::String(numStages) + " stages", 512,
+                         [&](juce::AudioBuffer<float>& buffer)
+                         {
+                             phaser.processBlock(buffer, buffer.getNumSamples());
+                         });
+        }
+    }
+
+    void benchmarkLimiter()
+    {
+        std::cout << "\n-- True-peak limiter --" << std::endl;
+
+        // With full-scale noise about half the samples are true-peak
+        // candidates at a 0 dB ceiling, and nearly all of them at -12 dB
+        for (float ceilingDb : { 0.0f, -12.0f })
+        {
+            TruePeakLimiter limiter;
+            limiter.setEnabled(true);
+            limiter.setCeiling(ceilingDb);
+            limiter.prepareToPlay(benchSampleRate, 512);
+
+            runBenchmark("ceiling " + juce::String(ceilingDb, 0) + " dB", 512,
+                         [&](juce::AudioBuffer<float>& buffer)
+                         {
+                             limiter.processBlock(buffer, buffer.getNumSamples());
+                         });
+        }
+    }
+
+    void benchmarkEnvelope()
+    {
+        std::cout << "\n-- Envelope --" << std::endl;
+
+        // Held in Sustain: one constant gain per block
+        EnvelopeGenerator sustained;
+        sustained.setParameters(1.0f, 1.0f, 0.7f, 100.0f);
+        sustained.prepareToPlay(benchSampleRate, 512);
+        sustained.noteOn(60, 1.0f);
+
+        runBenchmark("sustain", 512,
+                     [&](juce::AudioBuffer<float>& buffer)
+                     {
+                         sustained.processBlock(buffer, buffer.getNumSamples());
+                     });
+
+        // Retriggered every block, so every block has ramps and transitions
+        EnvelopeGenerator retriggered;
+        retriggered.setParameters(2.0f, 5.0f, 0.5f, 100.0f);
+        retriggered.prepareToPlay(benchSampleRate, 512);
+
+        runBenchmark("retriggered", 512,
+                     [&](juce::AudioBuffer<float>& buffer)
+                     {
+                         retriggered.noteOn(60, 1.0f);
+                         retriggered.processBlock(buffer, buffer.getNumSamples());
+                     });
+    }
+
+    void benchmarkVoices()
+    {
+        std::cout << "\n-- Polyphonic voices --" << std::endl;
+
+        // Held notes, so the cost is the per-sample lanes alone
+        for (int numVoices : { 1, 8, VoiceEngine::maxVoices })
+        {
+            VoiceEngine voices;
+            voices.setParameters(1.0f, 1.0f, 0.7f, 100.0f);
+            voices.prepareToPlay(benchSampleRate, 512);
+
+            for (int voice = 0; voice < numVoices; ++voice)
+                voices.noteOn(48 + voice, 0.8f);
+
+            runBenchmark(juce::String(numVoices) + " voices", 512,
+                         [&](juce::AudioBuffer<float>& buffer)
+                         {
+                             voices.renderBlock(buffer, buffer.getNumSamples());
+                         });
+        }
+    }
+
+    void benchmarkMultiStageEnvelope()
+    {
+        std::cout << "\n-- Multi-stage envelope --" << std::endl;
+
+        // Short looping segments, so every block crosses several of them.
+        // The cost per sample should not depend on the segment count.
+        for (int numSegments : { 4, MultiStageEnvelope::maxSegments })
+        {
+            MultiStageEnvelope::Segment segments[MultiStageEnvelope::maxSegments];
+            for (int i = 0; i < numSegments; ++i)
+                segments[i] = { (i % 2) == 0 ? 1.0f : 0.2f, 2.0f, 0.5f };
+
+            MultiStageEnvelope envelope;
+            envelope.setShape(segments, numSegments, 0, numSegments - 1);
+            envelope.prepareToPlay(benchSampleRate, 512);
+            envelope.noteOn(60, 1.0f);
+
+            runBenchmark(juce::String(numSegments) + " segments", 512,
+                         [&](juce::AudioBuffer<float>& buffer)
+                         {
+                             envelope.processBlock(buffer, buffer.getNumSamples());
+                         });
+        }
+    }
+
+    void benchmarkStepSequencer()
+    {
+        std::cout << "\n-- Step sequencer --" << std::endl;
+
+        // Short steps at a fast tempo put several gate changes in each block
+        for (auto division : { LFOGenerator::Sixteenth, LFOGenerator::SixtyFourth })
+        {
+            StepSequencer sequencer;
+            sequencer.prepareToPlay(benchSampleRate, 512);
+            sequencer.setHostBPM(180.0);
+            sequencer.setStepDivision(division);
+
+            runBenchmark(division == LFOGenerator::Sixteenth ? "1/16 steps" : "1/64 steps", 512,
+                         [&](juce::AudioBuffer<float>& buffer)
+                         {
+                             const int numSamples = buffer.getNumSamples();
+                             float* gain = buffer.getWritePointer(1);
+
+                             sequencer.renderGain(gain, numSamples);
+                             juce::FloatVectorOperations::multiply(buffer.getWritePointer(0), gain, numSamples);
+                         });
+        }
+    }
+
+    void benchmarkLFOShapes()
+    {
+        std::cout << "\n-- LFO shapes --" << std::endl;
+
+        const char* shapeNames[] = { "sine", "triangle", "saw", "square", "sample & hold", "smooth random" };
+
+        for (int shape = 0; shape < LFOGenerator::NumShapes; ++shape)
+        {
+            LFOGenerator lfo;
+            lfo.setShape(static_cast<LFOGenerator::LFOShape>(shape));
+            lfo.setRate(20.0f);
+            lfo.setDepth(1.0f);
+            lfo.prepareToPlay(benchSampleRate, 512);
+
+            // One modulation channel per block
+            runBenchmark(shapeNames[shape], 512,
+                         [&](juce::AudioBuffer<float>& buffer)
+                         {
+                             lfo.processBlock(buffer.getWritePointer(0), buffer.getNumSamples());
+                         });
+        }
+    }
+
+    void benchmarkRandomModulation()
+    {
+        std::cout << "\n-- Random sources (every 32 samples) --" << std::endl;
+
+        const char* modeNames[] = { "smooth random", "drift", "logistic", "lorenz" };
+
+        for (int mode = 0; mode < RandomModulator::NumModes; ++mode)
+        {
+            RandomModulator source;
+            source.setMode(static_cast<RandomModulator::Mode>(mode));
+            source.setRate(5.0f);
+            source.prepareToPlay(benchSampleRate / 32, 512);
+
+            ControlRateModulation modulation;
+            modulation.prepareToPlay(benchSampleRate, 512);
+
+            // Ticks at the control rate, ramped to a gain per sample
+            runBenchmark(modeNames[mode], 512,
+                         [&](juce::AudioBuffer<float>& buffer)
+                         {
+                             const int numSamples = buffer.getNumSamples();
+                             source.processBlock(modulation.getTickValues(0), modulation.beginBlock(numSamples));
+                             modulation.renderRamp(0, buffer.getWritePointer(1));
+                             modulation.endBlock();
+                         });
+        }
+    }
+
+    void benchmarkControlRateModulation()
+    {
+        std::cout << "\n-- LFO to filter cutoff --" << std::endl;
+
+        // An interval of 1 recomputes the filter every sample, for comparison
+        for (int interval : { 1, 16, 32, 64 })
+        {
+            ControlRateModulation modulation;
+            modulation.prepareToPlay(benchSampleRate, 512);
+            if (interval > 1)
+                modulation.setControlInterval(interval);
+
+            LFOGenerator lfo;
+            lfo.setRate(2.0f);
+            lfo.setDepth(1.0f);
+            lfo.prepareToPlay(benchSampleRate / interval, 512);
+
+            FilterProcessor filter;
+            filter.prepareToPlay(benchSampleRate, 512);
+            filter.setCutoffFrequency(2000.0f);
+
+            float lfoValues[512];
+
+            runBenchmark(interval == 1 ? juce::String("per sample") : "every " + juce::String(interval) + " samples", 512,
+                         [&](juce::AudioBuffer<float>& buffer)
+                         {
+                             const int numSamples = buffer.getNumSamples();
+
+                             if (interval == 1)
+                             {
+                                 lfo.processBlock(lfoValues, numSamples);
+
+                                 for (int i = 0; i < numSamples; ++i)
+                                 {
+                                     juce::AudioBuffer<float> sample(buffer.getArrayOfWritePointers(), 2, i, 1);
+                                     filter.applyModulation(lfoValues[i]);
+                                     filter.processBlock(sample, 1);
+                                 }
+                                 return;
+                             }
+
+                             lfo.processBlock(modulation.getTickValues(0), modulation.beginBlock(numSamples));
+
+                             for (int index = 0; index < modulation.getNumIntervals(); ++index)
+                             {
+                                 const int length = modulation.getIntervalLength(index);
+                                 if (length == 0)
+                                     continue;
+
+                                 juce::AudioBuffer<float> range(buffer.getArrayOfWritePointers(), 2,
+                                                                modulation.getIntervalStart(index), length);
+                                 filter.applyModulation(modulation.getIntervalValue(0, index));
+                                 filter.processBlock(range, length);
+                             }
+
+                             modulation.endBlock();
+                         });
+        }
+    }
+
+    void benchmarkModulationMatrix()
+    {
+        std::cout << "\n-- Modulation matrix (per sample) --" << std::endl;
+
+        for (int numRoutes : { 1, 4, 8 })
+        {
+            ModulationMatrix matrix;
+            for (int slot = 0; slot < numRoutes; ++slot)
+                matrix.setSlot(slot, slot % ModulationMatrix::NumSources,
+                               static_cast<ModulationMatrix::Destination>(slot % ModulationMatrix::NumDestinations), 0.5f);
+            matrix.applyPendingRouting();
+
+            juce::AudioBuffer<float> sources(ModulationMatrix::NumSources, 512);
+            juce::AudioBuffer<float> destinations(ModulationMatrix::NumDestinations, 512);
+            juce::Random random(99);
+            fillWithNoise(sources, random);
+
+            runBenchmark(juce::String(numRoutes) + (numRoutes == 1 ? " route" : " routes"), 512,
+                         [&](juce::AudioBuffer<float>& buffer)
+                         {
+                             matrix.process(sources.getArrayOfReadPointers(), destinations.getArrayOfWritePointers(),
+                                            buffer.getNumSamples());
+                         });
+        }
+    }
+
+    void benchmarkPresetMorph()
+    {
+        std::cout << "\n-- Preset morph (every 32 samples) --" << std::endl;
+
+        // Two snapshots differing in every target, including filter type
+        float snapshotA[PresetMorph::NumTargets];
+        float snapshotB[PresetMorph::NumTargets];
+        for (int target = 0; target < PresetMorph::NumTargets; ++target)
+        {
+            snapshotA[target] = 100.0f;
+            snapshotB[target] = 1000.0f;
+        }
+        snapshotA[PresetMorph::FilterType] = FilterProcessor::LowPass;
+        snapshotB[PresetMorph::FilterType] = FilterProcessor::HighPass;
+
+        for (bool crossfade : { false, true })
+        {
+            PresetMorph morph;
+            morph.setSnapshot(0, snapshotA);
+            morph.setSnapshot(1, snapshotB);
+            morph.applyPendingSnapshots();
+
+            FilterProcessor filter;
+            FilterProcessor otherFilter;
+            filter.prepareToPlay(benchSampleRate, 512);
+            otherFilter.prepareToPlay(benchSampleRate, 512);
+            filter.setFilterType(FilterProcessor::LowPass);
+            otherFilter.setFilterType(FilterProcessor::HighPass);
+
+            juce::AudioBuffer<float> otherBuffer(2, 512);
+            float values[PresetMorph::NumTargets];
+            float position = 0.0f;
+
+            // A full sweep every second, with the second filter path when
+            // crossfading
+            runBenchmark(crossfade ? "crossfaded filter types" : "continuous targets only", 32,
+                         [&](juce::AudioBuffer<float>& buffer)
+                         {
+                             const int numSamples = buffer.getNumSamples();
+
+                             position += static_cast<float>(numSamples / benchSampleRate);
+                             if (position > 1.0f)
+                                 position -= 1.0f;
+
+                             morph.process(position, values);
+
+                             const float cutoff = PresetMorph::getTargetValue(PresetMorph::Cutoff, values[PresetMorph::Cutoff]);
+                             filter.setCutoffFrequency(cutoff);
+                             filter.processBlock(buffer, numSamples);
+
+                             if (!crossfade)
+                                 return;
+
+                             otherFilter.setCutoffFrequency(cutoff);
+
+                             for (int channel = 0; channel < 2; ++channel)
+                                 otherBuffer.copyFrom(channel, 0, buffer, channel, 0, numSamples);
+
+                             otherFilter.processBlock(otherBuffer, numSamples);
+
+                             for (int channel = 0; channel < 2; ++channel)
+                             {
+                                 buffer.applyGain(channel, 0, numSamples, 1.0f - position);
+                                 buffer.addFrom(channel, 0, otherBuffer, channel, 0, numSamples, position);
+                             }
+                         });
+        }
+    }
+}
+
+//==============================================================================
+int main()
+{
+    std::cout << "Noise Lab DSP benchmarks (" << benchSampleRate << " Hz, "
+              << benchSeconds << " s of stereo audio per run)" << std::endl;
+
+    if (!checkHotDrive())
+        return 1;
+
+    benchmarkOversampling();
+    benchmarkEffectsKernels();
+    benchmarkBitCrusher();
+    benchmarkDriveModes();
+    benchmarkDriveCurves();
+    benchmarkStereoModes();
+    benchmarkConvolutionReverb();
+    benchmarkFDNReverb();
+    benchmarkStereoDelay();
+    benchmarkCompressor();
+    benchmarkPhaser();
+    benchmarkLimiter();
+    benchmarkEnvelope();
+    benchmarkVoices();
+    benchmarkMultiStageEnvelope();
+    benchmarkStepSequencer();
+    benchmarkLFOShapes();
+    benchmarkRandomModulation();
+    benchmarkControlRateModulation();
+    benchmarkModulationMatrix();
+    benchmarkPresetMorph();
+
+    return 0;
+}
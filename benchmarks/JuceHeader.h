@@ -0,0 +1,7 @@
+#pragma once
+
+// Reduced module set for the benchmark harness: the DSP classes only need
+// the audio basics and dsp modules, not the plugin client or GUI.
+#include <juce_audio_basics/juce_audio_basics.h>
+#include <juce_core/juce_core.h>
+#include <juce_dsp/juce_dsp.h>
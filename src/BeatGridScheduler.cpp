@@ -0,0 +1,137 @@
+#include "BeatGridScheduler.h"
+
+//==============================================================================
+BeatGridScheduler::BeatGridScheduler()
+    : sampleRate(44100.0)
+    , grid(Beat)            // Default: every beat
+    , offset(0.0f)
+    , swing(0.0f)
+    , beatsPerBar(4.0)      // Default: 4/4
+    , expectedPosition(0.0)
+    , hasExpectedPosition(false)
+{
+    for (auto& triggerOffset : triggerOffsets)
+        triggerOffset = 0;
+}
+
+BeatGridScheduler::~BeatGridScheduler()
+{
+}
+
+//==============================================================================
+void BeatGridScheduler::prepareToPlay(double newSampleRate, int /*samplesPerBlock*/)
+{
+    sampleRate = newSampleRate;
+    reset();
+}
+
+void BeatGridScheduler::reset()
+{
+    expectedPosition = 0.0;
+    hasExpectedPosition = false;
+}
+
+int BeatGridScheduler::findTriggers(double ppqPosition, double barStartPosition, double bpm, int numSamples)
+{
+    if (numSamples <= 0 || bpm <= 0.0)
+    {
+        hasExpectedPosition = false;
+        return 0;
+    }
+
+    const double beatsPerSample = bpm / (60.0 * sampleRate);
+
+    // Follow on from the last block unless the host has moved elsewhere.
+    // Hosts round their positions, so allow a sample either way.
+    const bool followsOn = hasExpectedPosition && std::abs(ppqPosition - expectedPosition) < beatsPerSample;
+    const double start = followsOn ? expectedPosition : ppqPosition;
+
+    const double end = start + numSamples * beatsPerSample;
+    expectedPosition = end;
+    hasExpectedPosition = true;
+
+    // A fresh start also takes a point just before it, so one the host
+    // position has been rounded past still fires on the first sample
+    const double firstPoint = followsOn ? start : start - 0.5 * beatsPerSample;
+
+    const double step = getStepLength();
+    const double origin = barStartPosition + offset.load() * step;
+    const double swingDelay = swing.load() * 0.5 * step;
+
+    // From the point before the block, as swing may move it inside
+    auto index = static_cast<juce::int64>(std::floor((firstPoint - origin) / step)) - 1;
+    int numTriggers = 0;
+
+    while (numTriggers < maxTriggersPerBlock)
+    {
+        const double point = origin + static_cast<double>(index) * step + ((index & 1) != 0 ? swingDelay : 0.0);
+        ++index;
+
+        if (point < firstPoint)
+            continue;
+
+        if (point >= end)
+            break;
+
+        const int sample = static_cast<int>(std::ceil((point - start) / beatsPerSample));
+        triggerOffsets[numTriggers++] = juce::jlimit(0, numSamples - 1, sample);
+    }
+
+    return numTriggers;
+}
+
+int BeatGridScheduler::getTriggerOffset(int index) const
+{
+    return triggerOffsets[juce::jlimit(0, maxTriggersPerBlock - 1, index)];
+}
+
+//==============================================================================
+void BeatGridScheduler::setGrid(Grid newGrid)
+{
+    grid.store(juce::jlimit(0, NumGrids - 1, static_cast<int>(newGrid)));
+}
+
+void BeatGridScheduler::setOffset(float fractionOfStep)
+{
+    offset.store(juce::jlimit(0.0f, 1.0f, fractionOfStep));
+}
+
+void BeatGridScheduler::setSwing(float amount)
+{
+    swing.store(juce::jlimit(0.0f, 1.0f, amount));
+}
+
+void BeatGridScheduler::setTimeSignature(int numerator, int denominator)
+{
+    if (numerator > 0 && denominator > 0)
+        beatsPerBar.store(numerator * 4.0 / denominator);
+}
+
+BeatGridScheduler::Grid BeatGridScheduler::getGrid() const
+{
+    return static_cast<Grid>(grid.load());
+}
+
+float BeatGridScheduler::getOffset() const
+{
+    return offset.load();
+}
+
+float BeatGridScheduler::getSwing() const
+{
+    return swing.load();
+}
+
+//==============================================================================
+double BeatGridScheduler::getStepLength() const
+{
+    switch (getGrid())
+    {
+        case Bar:       return beatsPerBar.load();
+        case Eighth:    return 0.5;
+        case Sixteenth: return 0.25;
+        case Beat:
+        case NumGrids:
+        default:        return 1.0;
+    }
+}
@@ -0,0 +1,78 @@
+#pragma once
+
+#include <JuceHeader.h>
+#include <atomic>
+
+//==============================================================================
+/**
+ * Finds the points of a beat grid that fall inside each block, for host
+ * sync retriggering.
+ *
+ * The grid is worked out from the host position once per block: bars from
+ * the position of the last bar start and the time signature, the shorter
+ * divisions counted from the same bar line. Each point can be offset by a
+ * fraction of the grid step, and every second point delayed for swing.
+ *
+ * Consecutive blocks share their boundary exactly, so a point on it fires
+ * once. If the host position doesn't follow on from the last block, as
+ * after a loop or a relocation, the grid restarts from the new position.
+ */
+class BeatGridScheduler
+{
+public:
+    //==============================================================================
+    enum Grid
+    {
+        Bar = 0,
+        Beat,
+        Eighth,
+        Sixteenth,
+        NumGrids
+    };
+
+    static constexpr int maxTriggersPerBlock = 64;
+
+    //==============================================================================
+    BeatGridScheduler();
+    ~BeatGridScheduler();
+
+    //==============================================================================
+    void prepareToPlay(double sampleRate, int samplesPerBlock);
+    void reset();
+
+    // Finds the grid points in the next numSamples, given the host position
+    // at the start of the block. Returns how many there are.
+    int findTriggers(double ppqPosition, double barStartPosition, double bpm, int numSamples);
+
+    // Sample offset of a trigger in the block, in ascending order
+    int getTriggerOffset(int index) const;
+
+    //==============================================================================
+    // Can be called from any thread
+    void setGrid(Grid grid);
+    void setOffset(float fractionOfStep);
+    void setSwing(float amount);
+    void setTimeSignature(int numerator, int denominator);
+
+    Grid getGrid() const;
+    float getOffset() const;
+    float getSwing() const;
+
+private:
+    //==============================================================================
+    double sampleRate;
+
+    std::atomic<int> grid;
+    std::atomic<float> offset;   // 0 to 1 of a step
+    std::atomic<float> swing;    // 0 to 1, delaying every second point by up to half a step
+    std::atomic<double> beatsPerBar;
+
+    // Where the last block ended, so the next can follow on from it
+    double expectedPosition;
+    bool hasExpectedPosition;
+
+    int triggerOffsets[maxTriggersPerBlock];
+
+    //==============================================================================
+    double getStepLength() const;
+};
@@ -0,0 +1,359 @@
+#include "Compressor.h"
+
+//==============================================================================
+namespace
+{
+    constexpr float kneeWidthDb = 6.0f;
+    constexpr float duckAttackFraction = 0.02f;   // of the division, to avoid a click on the beat
+
+    constexpr double duckDivisionBeats[Compressor::NumDuckDivisions] = { 0.25, 0.5, 1.0, 2.0, 4.0 };
+}
+
+//==============================================================================
+Compressor::Compressor()
+    : sampleRate(44100.0)
+    , maxBlockSize(512)
+    , mode(ModeOff)
+    , activeMode(ModeOff)
+    , threshold(-18.0f)
+    , ratio(4.0f)
+    , attack(5.0f)
+    , release(150.0f)
+    , lookahead(0.0f)
+    , makeupGain(0.0f)
+    , duckDivision(DuckQuarter)
+    , duckDepth(0.6f)
+    , hostBPM(120.0)
+    , beatPosition(0.0)
+    , lookaheadMask(0)
+    , lookaheadWritePosition(0)
+    , lookaheadSamples(0)
+    , envelopeDb(0.0f)
+    , lastGain(1.0f)
+{
+}
+
+Compressor::~Compressor()
+{
+}
+
+//==============================================================================
+void Compressor::prepareToPlay(double newSampleRate, int samplesPerBlock)
+{
+    sampleRate = newSampleRate;
+    maxBlockSize = juce::jmax(1, samplesPerBlock);
+
+    const int maxLookaheadSamples = static_cast<int>(std::ceil(maxLookaheadMs * 0.001 * sampleRate));
+
+    // Room for the longest lookahead behind a whole block
+    const int ringSize = juce::nextPowerOfTwo(maxLookaheadSamples + maxBlockSize + 1);
+    lookaheadBuffer.setSize(2, ringSize);
+    lookaheadMask = ringSize - 1;
+
+    detectorBuffer.setSize(1, maxBlockSize);
+    peakDetector.prepare(maxLookaheadSamples + 1);
+
+    activeMode = mode;
+    lookaheadSamples = juce::jlimit(0, maxLookaheadSamples, static_cast<int>(std::round(lookahead * 0.001 * sampleRate)));
+    peakDetector.setWindowLength(lookaheadSamples + 1);
+
+    reset();
+}
+
+void Compressor::processBlock(juce::AudioBuffer<float>& buffer, int numSamples)
+{
+    if (numSamples <= 0 || lookaheadBuffer.getNumSamples() == 0)
+        return;
+
+    float* left = buffer.getWritePointer(0);
+    float* right = buffer.getNumChannels() > 1 ? buffer.getWritePointer(1) : nullptr;
+    const double beatsPerSample = hostBPM / (60.0 * sampleRate);
+
+    // The scratch buffers hold one prepared block, so split larger ones
+    for (int offset = 0; offset < numSamples; offset += maxBlockSize)
+    {
+        const int chunk = juce::jmin(maxBlockSize, numSamples - offset);
+        float* chunkRight = right != nullptr ? right + offset : nullptr;
+
+        if (activeMode == ModeCompress)
+            processCompress(left + offset, chunkRight, chunk);
+        else if (activeMode == ModeDuck)
+            processDuck(left + offset, chunkRight, chunk);
+
+        beatPosition += chunk * beatsPerSample;
+    }
+}
+
+void Compressor::reset()
+{
+    lookaheadBuffer.clear();
+    lookaheadWritePosition = 0;
+    peakDetector.reset();
+    envelopeDb = 0.0f;
+    lastGain = 1.0f;
+}
+
+bool Compressor::applyPendingLatency()
+{
+    const int maxLookaheadSamples = static_cast<int>(std::ceil(maxLookaheadMs * 0.001 * sampleRate));
+    const int newLookahead = juce::jlimit(0, maxLookaheadSamples, static_cast<int>(std::round(lookahead * 0.001 * sampleRate)));
+
+    if (mode == activeMode && newLookahead == lookaheadSamples)
+        return false;
+
+    const int previousLatency = getLatencySamples();
+
+    activeMode = mode;
+    lookaheadSamples = newLookahead;
+    peakDetector.setWindowLength(lookaheadSamples + 1);
+    reset();
+
+    return getLatencySamples() != previousLatency;
+}
+
+int Compressor::getLatencySamples() const
+{
+    // Only compress mode delays the audio
+    return activeMode == ModeCompress ? lookaheadSamples : 0;
+}
+
+//==============================================================================
+void Compressor::setMode(Mode newMode)
+{
+    mode = static_cast<Mode>(juce::jlimit(0, static_cast<int>(NumModes) - 1, static_cast<int>(newMode)));
+}
+
+void Compressor::setThreshold(float thresholdDb)
+{
+    threshold = juce::jlimit(-60.0f, 0.0f, thresholdDb);
+}
+
+void Compressor::setRatio(float newRatio)
+{
+    ratio = juce::jlimit(1.0f, 20.0f, newRatio);
+}
+
+void Compressor::setAttack(float attackMs)
+{
+    attack = juce::jlimit(0.1f, 100.0f, attackMs);
+}
+
+void Compressor::setRelease(float releaseMs)
+{
+    release = juce::jlimit(10.0f, 1000.0f, releaseMs);
+}
+
+void Compressor::setLookahead(float lookaheadMs)
+{
+    lookahead = juce::jlimit(0.0f, maxLookaheadMs, lookaheadMs);
+}
+
+void Compressor::setMakeupGain(float makeupDb)
+{
+    makeupGain = juce::jlimit(0.0f, 24.0f, makeupDb);
+}
+
+void Compressor::setDuckDivision(DuckDivision division)
+{
+    duckDivision = static_cast<DuckDivision>(juce::jlimit(0, static_cast<int>(NumDuckDivisions) - 1, static_cast<int>(division)));
+}
+
+void Compressor::setDuckDepth(float depth)
+{
+    duckDepth = juce::jlimit(0.0f, 1.0f, depth);
+}
+
+Compressor::Mode Compressor::getMode() const
+{
+    return mode;
+}
+
+float Compressor::getThreshold() const
+{
+    return threshold;
+}
+
+float Compressor::getRatio() const
+{
+    return ratio;
+}
+
+float Compressor::getAttack() const
+{
+    return attack;
+}
+
+float Compressor::getRelease() const
+{
+    return release;
+}
+
+float Compressor::getLookahead() const
+{
+    return lookahead;
+}
+
+float Compressor::getMakeupGain() const
+{
+    return makeupGain;
+}
+
+Compressor::DuckDivision Compressor::getDuckDivision() const
+{
+    return duckDivision;
+}
+
+float Compressor::getDuckDepth() const
+{
+    return duckDepth;
+}
+
+void Compressor::setHostBPM(double bpm)
+{
+    if (bpm > 0.0)
+        hostBPM = bpm;
+}
+
+void Compressor::setHostPPQPosition(double ppqPosition)
+{
+    beatPosition = ppqPosition;
+}
+
+//==============================================================================
+void Compressor::processCompress(float* left, float* right, int numSamples)
+{
+    // Stereo-linked peak, then the maximum over the lookahead window
+    float* detector = detectorBuffer.getWritePointer(0);
+
+    if (right != nullptr)
+    {
+        for (int i = 0; i < numSamples; ++i)
+            detector[i] = juce::jmax(std::abs(left[i]), std::abs(right[i]));
+    }
+    else
+    {
+        juce::FloatVectorOperations::abs(detector, left, numSamples);
+    }
+
+    peakDetector.processBlock(detector, detector, numSamples);
+
+    delayBlock(left, 0, numSamples);
+    if (right != nullptr)
+        delayBlock(right, 1, numSamples);
+
+    lookaheadWritePosition = (lookaheadWritePosition + numSamples) & lookaheadMask;
+
+    const float makeup = juce::Decibels::decibelsToGain(makeupGain);
+    const float samplesPerMs = static_cast<float>(sampleRate * 0.001);
+
+    for (int start = 0; start < numSamples; start += controlInterval)
+    {
+        const int length = juce::jmin(controlInterval, numSamples - start);
+
+        // Gain computer, once per control interval
+        const float peak = juce::FloatVectorOperations::findMaximum(detector + start, length);
+        const float targetDb = computeGainReduction(juce::Decibels::gainToDecibels(peak, -100.0f));
+
+        const float time = targetDb < envelopeDb ? attack : release;
+        const float coefficient = std::exp(-static_cast<float>(length) / (time * samplesPerMs));
+        envelopeDb = targetDb + coefficient * (envelopeDb - targetDb);
+
+        // Ramp to the new gain across the interval
+        const float gain = juce::Decibels::decibelsToGain(envelopeDb) * makeup;
+        const float step = (gain - lastGain) / static_cast<float>(length);
+
+        for (int i = 0; i < length; ++i)
+        {
+            const float rampGain = lastGain + step * static_cast<float>(i + 1);
+            left[start + i] *= rampGain;
+            if (right != nullptr)
+                right[start + i] *= rampGain;
+        }
+
+        lastGain = gain;
+    }
+}
+
+void Compressor::processDuck(float* left, float* right, int numSamples)
+{
+    const double beatsPerSample = hostBPM / (60.0 * sampleRate);
+    const double divisionBeats = duckDivisionBeats[duckDivision];
+
+    for (int start = 0; start < numSamples; start += controlInterval)
+    {
+        const int length = juce::jmin(controlInterval, numSamples - start);
+
+        // Gain at the end of this interval
+        const double position = (beatPosition + (start + length) * beatsPerSample) / divisionBeats;
+        const float gain = duckGain(static_cast<float>(position - std::floor(position)));
+        const float step = (gain - lastGain) / static_cast<float>(length);
+
+        for (int i = 0; i < length; ++i)
+        {
+            const float rampGain = lastGain + step * static_cast<float>(i + 1);
+            left[start + i] *= rampGain;
+            if (right != nullptr)
+                right[start + i] *= rampGain;
+        }
+
+        lastGain = gain;
+    }
+}
+
+void Compressor::delayBlock(float* data, int channel, int numSamples)
+{
+    if (lookaheadSamples == 0)
+        return;
+
+    float* ring = lookaheadBuffer.getWritePointer(channel);
+    const int ringSize = lookaheadMask + 1;
+
+    // Write the block, then read it back lookaheadSamples later. The ring
+    // holds a block plus the maximum lookahead, so nothing read is
+    // overwritten first.
+    const int writeFirst = juce::jmin(numSamples, ringSize - lookaheadWritePosition);
+    juce::FloatVectorOperations::copy(ring + lookaheadWritePosition, data, writeFirst);
+    if (writeFirst < numSamples)
+        juce::FloatVectorOperations::copy(ring, data + writeFirst, numSamples - writeFirst);
+
+    const int readPosition = (lookaheadWritePosition - lookaheadSamples) & lookaheadMask;
+    const int readFirst = juce::jmin(numSamples, ringSize - readPosition);
+    juce::FloatVectorOperations::copy(data, ring + readPosition, readFirst);
+    if (readFirst < numSamples)
+        juce::FloatVectorOperations::copy(data + readFirst, ring, numSamples - readFirst);
+}
+
+float Compressor::computeGainReduction(float levelDb) const
+{
+    // Soft knee around the threshold
+    const float over = levelDb - threshold;
+    const float slope = 1.0f / ratio - 1.0f;
+
+    if (2.0f * over < -kneeWidthDb)
+        return 0.0f;
+
+    if (2.0f * std::abs(over) <= kneeWidthDb)
+    {
+        const float x = over + kneeWidthDb * 0.5f;
+        return slope * x * x / (2.0f * kneeWidthDb);
+    }
+
+    return slope * over;
+}
+
+float Compressor::duckGain(float phase) const
+{
+    // A quick dip on the division, then a curved recovery across the rest
+    float dip;
+    if (phase < duckAttackFraction)
+    {
+        dip = phase / duckAttackFraction;
+    }
+    else
+    {
+        const float recovery = 1.0f - (phase - duckAttackFraction) / (1.0f - duckAttackFraction);
+        dip = recovery * recovery;
+    }
+
+    return 1.0f - duckDepth * dip;
+}
@@ -0,0 +1,131 @@
+#pragma once
+
+#include <JuceHeader.h>
+#include "SlidingMaximum.h"
+
+//==============================================================================
+/**
+ * Lookahead compressor with a tempo-synced ducking mode, for pumping
+ * presets like "Air Pump".
+ *
+ * Compress mode detects the stereo-linked peak a block at a time. A sliding
+ * maximum over the lookahead window tells the gain computer about a peak
+ * before the delayed audio reaches it. The gain computer runs once per
+ * control interval, and the gain is ramped linearly between control points.
+ *
+ * Duck mode ignores the input and dips the gain on every beat division,
+ * following the host position, like a sidechain from a kick on the grid.
+ *
+ * Lookahead and mode changes that move the latency are applied by
+ * applyPendingLatency() on the audio thread, so the host can be told.
+ */
+class Compressor
+{
+public:
+    //==============================================================================
+    enum Mode
+    {
+        ModeOff = 0,
+        ModeCompress,
+        ModeDuck,
+        NumModes
+    };
+
+    enum DuckDivision
+    {
+        Duck16th = 0,
+        Duck8th,
+        DuckQuarter,
+        DuckHalf,
+        DuckWhole,
+        NumDuckDivisions
+    };
+
+    static constexpr float maxLookaheadMs = 10.0f;
+    static constexpr int controlInterval = 32;   // samples per gain computer update
+
+    //==============================================================================
+    Compressor();
+    ~Compressor();
+
+    //==============================================================================
+    void prepareToPlay(double sampleRate, int samplesPerBlock);
+    void processBlock(juce::AudioBuffer<float>& buffer, int numSamples);
+    void reset();
+
+    // Applies a mode or lookahead change made since the last call. Returns
+    // true if the latency changed.
+    bool applyPendingLatency();
+    int getLatencySamples() const;
+
+    //==============================================================================
+    void setMode(Mode mode);
+    void setThreshold(float thresholdDb);
+    void setRatio(float ratio);
+    void setAttack(float attackMs);
+    void setRelease(float releaseMs);
+    void setLookahead(float lookaheadMs);
+    void setMakeupGain(float makeupDb);
+    void setDuckDivision(DuckDivision division);
+    void setDuckDepth(float depth);
+
+    Mode getMode() const;
+    float getThreshold() const;
+    float getRatio() const;
+    float getAttack() const;
+    float getRelease() const;
+    float getLookahead() const;
+    float getMakeupGain() const;
+    DuckDivision getDuckDivision() const;
+    float getDuckDepth() const;
+
+    // Host timing for the ducking mode
+    void setHostBPM(double bpm);
+    void setHostPPQPosition(double ppqPosition);
+
+private:
+    //==============================================================================
+    void processCompress(float* left, float* right, int numSamples);
+    void processDuck(float* left, float* right, int numSamples);
+
+    // Writes the block into the lookahead ring and reads it back delayed
+    void delayBlock(float* data, int channel, int numSamples);
+
+    // Gain reduction in dB (zero or negative) for a detected level in dB
+    float computeGainReduction(float levelDb) const;
+
+    // Ducking gain at a position within the division, 0 to 1
+    float duckGain(float phase) const;
+
+    //==============================================================================
+    double sampleRate;
+    int maxBlockSize;
+
+    Mode mode;
+    Mode activeMode;           // the mode the latency was last reported for
+    float threshold;           // dB
+    float ratio;
+    float attack;              // ms
+    float release;             // ms
+    float lookahead;           // ms
+    float makeupGain;          // dB
+    DuckDivision duckDivision;
+    float duckDepth;           // 0 to 1
+
+    double hostBPM;
+    double beatPosition;       // quarter notes, advanced between host updates
+
+    // Lookahead delay, one power-of-two ring per channel
+    juce::AudioBuffer<float> lookaheadBuffer;
+    int lookaheadMask;
+    int lookaheadWritePosition;
+    int lookaheadSamples;
+
+    SlidingMaximum peakDetector;
+    juce::AudioBuffer<float> detectorBuffer;   // one channel of detected peaks
+
+    // Smoothed gain reduction in dB, and the linear gain at the last control
+    // point, where the next ramp starts
+    float envelopeDb;
+    float lastGain;
+};
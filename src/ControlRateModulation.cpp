@@ -0,0 +1,172 @@
+#include "ControlRateModulation.h"
+
+//==============================================================================
+ControlRateModulation::ControlRateModulation()
+    : sampleRate(44100.0)
+    , controlInterval(32)     // Default: 32 samples
+    , blockSize(0)
+    , firstTick(0)
+    , numTicks(0)
+    , samplesToNextTick(0)
+{
+    reset();
+}
+
+ControlRateModulation::~ControlRateModulation()
+{
+}
+
+//==============================================================================
+void ControlRateModulation::prepareToPlay(double newSampleRate, int samplesPerBlock)
+{
+    sampleRate = newSampleRate;
+
+    // Enough ticks for a block at the shortest interval
+    const int maxTicks = juce::jmax(1, samplesPerBlock) / minInterval + 2;
+    for (auto& values : tickValues)
+        values.assign(static_cast<size_t>(maxTicks), 0.0f);
+
+    reset();
+}
+
+void ControlRateModulation::reset()
+{
+    blockSize = 0;
+    firstTick = 0;
+    numTicks = 0;
+    samplesToNextTick = 0;
+
+    for (int lane = 0; lane < maxLanes; ++lane)
+    {
+        rampValue[lane] = 0.0f;
+        rampIncrement[lane] = 0.0f;
+        rampTarget[lane] = 0.0f;
+    }
+}
+
+void ControlRateModulation::setControlInterval(int numSamples)
+{
+    const int interval = juce::nextPowerOfTwo(juce::jlimit(minInterval, maxInterval, numSamples));
+    if (interval == controlInterval)
+        return;
+
+    controlInterval = interval;
+
+    // Hold each lane where it is until the next tick
+    samplesToNextTick = 0;
+    for (int lane = 0; lane < maxLanes; ++lane)
+    {
+        rampTarget[lane] = rampValue[lane];
+        rampIncrement[lane] = 0.0f;
+    }
+}
+
+int ControlRateModulation::getControlInterval() const
+{
+    return controlInterval;
+}
+
+double ControlRateModulation::getControlRate() const
+{
+    return sampleRate / controlInterval;
+}
+
+//==============================================================================
+int ControlRateModulation::beginBlock(int numSamples)
+{
+    blockSize = numSamples;
+    firstTick = samplesToNextTick;
+    numTicks = firstTick < numSamples ? 1 + (numSamples - 1 - firstTick) / controlInterval : 0;
+
+    // Only if the host sends more than it prepared for
+    if (static_cast<size_t>(numTicks) > tickValues[0].size())
+    {
+        for (auto& values : tickValues)
+            values.resize(static_cast<size_t>(numTicks), 0.0f);
+    }
+
+    return numTicks;
+}
+
+float* ControlRateModulation::getTickValues(int lane)
+{
+    return tickValues[lane].data();
+}
+
+void ControlRateModulation::endBlock()
+{
+    if (numTicks == 0)
+    {
+        for (int lane = 0; lane < maxLanes; ++lane)
+            rampValue[lane] += rampIncrement[lane] * static_cast<float>(blockSize);
+
+        samplesToNextTick -= blockSize;
+        return;
+    }
+
+    // The last interval starts at its previous tick's value
+    const int lastTick = firstTick + (numTicks - 1) * controlInterval;
+    const float samplesIntoLast = static_cast<float>(blockSize - lastTick);
+
+    for (int lane = 0; lane < maxLanes; ++lane)
+    {
+        const float* values = tickValues[lane].data();
+        const float start = numTicks > 1 ? values[numTicks - 2] : rampTarget[lane];
+
+        rampTarget[lane] = values[numTicks - 1];
+        rampIncrement[lane] = (rampTarget[lane] - start) / static_cast<float>(controlInterval);
+        rampValue[lane] = start + rampIncrement[lane] * samplesIntoLast;
+    }
+
+    samplesToNextTick = lastTick + controlInterval - blockSize;
+}
+
+//==============================================================================
+void ControlRateModulation::renderRamp(int lane, float* output) const
+{
+    const float* values = tickValues[lane].data();
+
+    // The rest of the interval in progress
+    const int head = juce::jmin(firstTick, blockSize);
+    for (int i = 0; i < head; ++i)
+        output[i] = rampValue[lane] + rampIncrement[lane] * static_cast<float>(i + 1);
+
+    float start = rampTarget[lane];
+    const float scale = 1.0f / static_cast<float>(controlInterval);
+
+    for (int tick = 0; tick < numTicks; ++tick)
+    {
+        const int offset = firstTick + tick * controlInterval;
+        const int length = juce::jmin(controlInterval, blockSize - offset);
+        const float increment = (values[tick] - start) * scale;
+
+        for (int i = 0; i < length; ++i)
+            output[offset + i] = start + increment * static_cast<float>(i + 1);
+
+        start = values[tick];
+    }
+}
+
+int ControlRateModulation::getNumIntervals() const
+{
+    return numTicks + 1;
+}
+
+int ControlRateModulation::getIntervalStart(int interval) const
+{
+    return interval == 0 ? 0 : firstTick + (interval - 1) * controlInterval;
+}
+
+int ControlRateModulation::getIntervalLength(int interval) const
+{
+    if (interval == 0)
+        return juce::jmin(firstTick, blockSize);
+
+    const int start = getIntervalStart(interval);
+    return juce::jmin(controlInterval, blockSize - start);
+}
+
+float ControlRateModulation::getIntervalValue(int lane, int interval) const
+{
+    return interval == 0 ? rampTarget[lane] : tickValues[lane][static_cast<size_t>(interval - 1)];
+}
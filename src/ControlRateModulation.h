@@ -0,0 +1,82 @@
+#pragma once
+
+#include <JuceHeader.h>
+#include <vector>
+
+//==============================================================================
+/**
+ * Control-rate grid for modulation sources.
+ *
+ * Sources are evaluated once per control interval of N samples, on a grid
+ * that carries across blocks, so a source always advances by exactly N
+ * samples per tick whatever the host block size. At each tick a source
+ * writes the value it will have at the end of the interval that starts
+ * there.
+ *
+ * Audio-rate consumers read a lane through renderRamp, which interpolates
+ * linearly from tick to tick. Stepped consumers, such as filter
+ * coefficients, walk the block's intervals and update once per interval.
+ *
+ * Per block: beginBlock, then each source fills getTickValues for its lane,
+ * then the consumers read, then endBlock.
+ */
+class ControlRateModulation
+{
+public:
+    //==============================================================================
+    static constexpr int maxLanes = 16;
+    static constexpr int minInterval = 16;
+    static constexpr int maxInterval = 64;
+
+    //==============================================================================
+    ControlRateModulation();
+    ~ControlRateModulation();
+
+    //==============================================================================
+    void prepareToPlay(double sampleRate, int samplesPerBlock);
+    void reset();
+
+    // Power of two from minInterval to maxInterval. Restarts the grid.
+    void setControlInterval(int numSamples);
+    int getControlInterval() const;
+    double getControlRate() const;
+
+    //==============================================================================
+    // Places the ticks for the next numSamples and returns how many there
+    // are, each needing one value per lane
+    int beginBlock(int numSamples);
+    float* getTickValues(int lane);
+
+    // Advances every lane to the end of the block
+    void endBlock();
+
+    //==============================================================================
+    // Writes the block's values per sample, ramping between ticks
+    void renderRamp(int lane, float* output) const;
+
+    // The block as intervals holding one value each. The first is the rest
+    // of the interval in progress, and may be empty.
+    int getNumIntervals() const;
+    int getIntervalStart(int interval) const;
+    int getIntervalLength(int interval) const;
+    float getIntervalValue(int lane, int interval) const;
+
+private:
+    //==============================================================================
+    double sampleRate;
+    int controlInterval;
+
+    // The current block
+    int blockSize;
+    int firstTick;          // offset of the block's first tick
+    int numTicks;
+    int samplesToNextTick;  // carried to the next block
+
+    // Per lane: the value at the start of the block, the increment of the
+    // interval in progress and the value it ends on
+    float rampValue[maxLanes];
+    float rampIncrement[maxLanes];
+    float rampTarget[maxLanes];
+
+    std::vector<float> tickValues[maxLanes];
+};
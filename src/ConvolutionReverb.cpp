@@ -0,0 +1,879 @@
+#include "ConvolutionReverb.h"
+
+//==============================================================================
+namespace
+{
+    constexpr int numEngineChannels = 2;
+    constexpr int tailPartitionMultiple = 8;      // T = 8B, or more for large host blocks
+    constexpr int numTailSlots = 4;               // tail blocks in flight
+    constexpr double maxImpulseLengthSeconds = 10.0;
+    constexpr double engineFadeSeconds = 0.1;
+
+    int ordinalLog2(int powerOfTwo)
+    {
+        int order = 0;
+        while ((1 << order) < powerOfTwo)
+            ++order;
+        return order;
+    }
+
+    // acc += a * b over interleaved complex bins
+    void multiplyAccumulate(float* acc, const float* a, const float* b, int numBins)
+    {
+        for (int bin = 0; bin < numBins; ++bin)
+        {
+            const float re = a[2 * bin] * b[2 * bin] - a[2 * bin + 1] * b[2 * bin + 1];
+            const float im = a[2 * bin] * b[2 * bin + 1] + a[2 * bin + 1] * b[2 * bin];
+            acc[2 * bin] += re;
+            acc[2 * bin + 1] += im;
+        }
+    }
+
+    // Spectrum of numTaps taps zero-padded to the FFT size (two partitions)
+    void partitionSpectrum(const juce::dsp::FFT& fft, const float* taps, int numTaps,
+                           int partitionSize, float* spectrum, float* workspace)
+    {
+        const int fftSize = 2 * partitionSize;
+        juce::FloatVectorOperations::clear(workspace, 2 * fftSize);
+        juce::FloatVectorOperations::copy(workspace, taps, numTaps);
+
+        fft.performRealOnlyForwardTransform(workspace, true);
+        juce::FloatVectorOperations::copy(spectrum, workspace, 2 * (partitionSize + 1));
+    }
+}
+
+//==============================================================================
+/**
+ * One configuration of the convolution: IR spectra for the head and tail, and
+ * all the state needed to run them. Everything is allocated on construction.
+ *
+ * Both levels use uniformly partitioned overlap-save convolution with a
+ * frequency-domain delay line. The audio thread runs the head and hands each
+ * completed tail block to the tail thread through a small ring of slots;
+ * the result for block j is needed one tail block after it is submitted.
+ */
+struct ConvolutionReverb::Engine
+{
+    Engine(const juce::AudioBuffer<float>& impulseResponse, int newHeadSize, int newTailSize, bool directHead)
+        : headSize(newHeadSize)
+        , tailSize(newTailSize)
+        , useDirectHead(directHead)
+        , latency(directHead ? 0 : newHeadSize)
+        , impulseLength(impulseResponse.getNumSamples())
+        , headFFT(ordinalLog2(2 * newHeadSize))
+        , tailFFT(ordinalLog2(2 * newTailSize))
+    {
+        const int headBins = headSize + 1;
+        const int tailBins = tailSize + 1;
+
+        // The head covers [headStart, 2T), the tail [2T, impulseLength)
+        const int headStart = useDirectHead ? headSize : 0;
+        const int headEnd = juce::jmin(impulseLength, 2 * tailSize);
+        numHeadPartitions = juce::jmax(0, (headEnd - headStart + headSize - 1) / headSize);
+        numTailPartitions = juce::jmax(0, (impulseLength - 2 * tailSize + tailSize - 1) / tailSize);
+
+        directTaps.assign(static_cast<size_t>(numEngineChannels * headSize), 0.0f);
+        headFilter.assign(static_cast<size_t>(numEngineChannels * numHeadPartitions * 2 * headBins), 0.0f);
+        headSpectra.assign(headFilter.size(), 0.0f);
+        headFrame.assign(static_cast<size_t>(numEngineChannels * 2 * headSize), 0.0f);
+        headOutput.assign(static_cast<size_t>(numEngineChannels * headSize), 0.0f);
+        headWorkspace.assign(static_cast<size_t>(4 * headSize), 0.0f);
+        headAccumulator.assign(static_cast<size_t>(2 * headBins), 0.0f);
+
+        if (numTailPartitions > 0)
+        {
+            tailFilter.assign(static_cast<size_t>(numEngineChannels * numTailPartitions * 2 * tailBins), 0.0f);
+            tailSpectra.assign(tailFilter.size(), 0.0f);
+            tailFrame.assign(static_cast<size_t>(numEngineChannels * 2 * tailSize), 0.0f);
+            tailWorkspace.assign(static_cast<size_t>(4 * tailSize), 0.0f);
+            tailAccumulator.assign(static_cast<size_t>(2 * tailBins), 0.0f);
+            tailInputSlots.assign(static_cast<size_t>(numTailSlots * numEngineChannels * tailSize), 0.0f);
+            tailOutputSlots.assign(tailInputSlots.size(), 0.0f);
+            tailCollect.assign(static_cast<size_t>(numEngineChannels * tailSize), 0.0f);
+            tailRing.assign(static_cast<size_t>(numEngineChannels * 2 * tailSize), 0.0f);
+        }
+
+        // Partition the IR, with a mono IR feeding both channels
+        for (int channel = 0; channel < numEngineChannels; ++channel)
+        {
+            const float* ir = impulseResponse.getReadPointer(juce::jmin(channel, impulseResponse.getNumChannels() - 1));
+
+            if (useDirectHead)
+                juce::FloatVectorOperations::copy(&directTaps[static_cast<size_t>(channel * headSize)],
+                                                  ir, juce::jmin(headSize, impulseLength));
+
+            for (int partition = 0; partition < numHeadPartitions; ++partition)
+            {
+                const int start = headStart + partition * headSize;
+                partitionSpectrum(headFFT, ir + start, juce::jmin(headSize, headEnd - start), headSize,
+                                  headFilterPartition(channel, partition), headWorkspace.data());
+            }
+
+            for (int partition = 0; partition < numTailPartitions; ++partition)
+            {
+                const int start = 2 * tailSize + partition * tailSize;
+                partitionSpectrum(tailFFT, ir + start, juce::jmin(tailSize, impulseLength - start), tailSize,
+                                  tailFilterPartition(channel, partition), tailWorkspace.data());
+            }
+        }
+
+        reset();
+    }
+
+    //==============================================================================
+    // Only called when neither the audio nor the tail thread is using the engine
+    void reset()
+    {
+        std::fill(headSpectra.begin(), headSpectra.end(), 0.0f);
+        std::fill(headFrame.begin(), headFrame.end(), 0.0f);
+        std::fill(headOutput.begin(), headOutput.end(), 0.0f);
+        std::fill(tailSpectra.begin(), tailSpectra.end(), 0.0f);
+        std::fill(tailFrame.begin(), tailFrame.end(), 0.0f);
+        std::fill(tailCollect.begin(), tailCollect.end(), 0.0f);
+        std::fill(tailRing.begin(), tailRing.end(), 0.0f);
+
+        headPosition = 0;
+        headSpectraPosition = 0;
+        tailCollectPosition = 0;
+        tailSpectraPosition = 0;
+        tailBlockIndex = 0;
+        time = 0;
+        submittedTailBlocks = 0;
+        completedTailBlocks = 0;
+    }
+
+    // Silence needed to flush the head and tail history and the tail
+    // hand-over, after which the engine state is all zeros again
+    int getRingOutSamples() const
+    {
+        return impulseLength + latency + 4 * tailSize;
+    }
+
+    //==============================================================================
+    // Audio thread. Convolves the input (or silence if input is null) into
+    // output, and returns true if a tail block was handed to the tail thread.
+    bool process(const float* const* input, float* const* output, int numChannels, int numSamples)
+    {
+        bool submitted = false;
+        int done = 0;
+
+        while (done < numSamples)
+        {
+            // Work up to the next head block boundary
+            const int chunk = juce::jmin(numSamples - done, headSize - headPosition);
+
+            for (int channel = 0; channel < juce::jmin(numChannels, numEngineChannels); ++channel)
+            {
+                float* frame = &headFrame[static_cast<size_t>(channel * 2 * headSize + headSize + headPosition)];
+                float* wet = output[channel] + done;
+
+                if (input != nullptr)
+                    juce::FloatVectorOperations::copy(frame, input[channel] + done, chunk);
+                else
+                    juce::FloatVectorOperations::clear(frame, chunk);
+
+                if (numTailPartitions > 0)
+                    juce::FloatVectorOperations::copy(&tailCollect[static_cast<size_t>(channel * tailSize + tailCollectPosition)],
+                                                      frame, chunk);
+
+                juce::FloatVectorOperations::copy(wet, &headOutput[static_cast<size_t>(channel * headSize + headPosition)], chunk);
+
+                // Direct-form FIR for the first partition, one tap at a time
+                // over the chunk so the inner loop vectorises. The frame holds
+                // the previous block, so frame - tap is always in range.
+                if (useDirectHead)
+                {
+                    const float* taps = &directTaps[static_cast<size_t>(channel * headSize)];
+
+                    for (int tap = 0; tap < juce::jmin(headSize, impulseLength); ++tap)
+                        juce::FloatVectorOperations::addWithMultiply(wet, frame - tap, taps[tap], chunk);
+                }
+
+                if (numTailPartitions > 0)
+                {
+                    const float* ring = &tailRing[static_cast<size_t>(channel * 2 * tailSize)];
+                    const juce::int64 ringMask = 2 * tailSize - 1;
+
+                    for (int i = 0; i < chunk; ++i)
+                        wet[i] += ring[(time - latency + i) & ringMask];
+                }
+            }
+
+            headPosition += chunk;
+            tailCollectPosition += chunk;
+            time += chunk;
+            done += chunk;
+
+            if (headPosition == headSize)
+            {
+                processHeadBlock();
+                headPosition = 0;
+            }
+
+            if (numTailPartitions > 0 && tailCollectPosition == tailSize)
+            {
+                exchangeTailBlock();
+                tailCollectPosition = 0;
+                submitted = true;
+            }
+        }
+
+        return submitted;
+    }
+
+    //==============================================================================
+    // Tail thread. Processes every submitted block in order.
+    void processPendingTailBlocks()
+    {
+        const int tailBins = tailSize + 1;
+
+        for (;;)
+        {
+            const juce::int64 block = completedTailBlocks.load(std::memory_order_relaxed);
+
+            if (block >= submittedTailBlocks.load(std::memory_order_acquire))
+                return;
+
+            const int slot = static_cast<int>(block % numTailSlots);
+
+            for (int channel = 0; channel < numEngineChannels; ++channel)
+            {
+                float* frame = &tailFrame[static_cast<size_t>(channel * 2 * tailSize)];
+                juce::FloatVectorOperations::copy(frame + tailSize, tailInputSlot(slot, channel), tailSize);
+
+                convolvePartitions(tailFFT, frame, tailSize, numTailPartitions, tailSpectraPosition,
+                                   &tailSpectra[static_cast<size_t>(channel * numTailPartitions * 2 * tailBins)],
+                                   &tailFilter[static_cast<size_t>(channel * numTailPartitions * 2 * tailBins)],
+                                   tailWorkspace.data(), tailAccumulator.data(), tailOutputSlot(slot, channel));
+            }
+
+            tailSpectraPosition = (tailSpectraPosition + 1) % numTailPartitions;
+            completedTailBlocks.store(block + 1, std::memory_order_release);
+        }
+    }
+
+    //==============================================================================
+    const int headSize;
+    const int tailSize;
+    const bool useDirectHead;
+    const int latency;
+    const int impulseLength;
+
+    int numHeadPartitions;
+    int numTailPartitions;
+
+private:
+    //==============================================================================
+    // Overlap-save step shared by both levels: transform the two-block frame
+    // into the delay line, sum the partition products, and keep the last
+    // block of the inverse transform. The frame then slides by one block.
+    static void convolvePartitions(const juce::dsp::FFT& fft, float* frame, int partitionSize,
+                                   int numPartitions, int spectraPosition, float* spectra,
+                                   const float* filter, float* workspace, float* accumulator, float* output)
+    {
+        const int numBins = partitionSize + 1;
+        const int spectrumSize = 2 * numBins;
+
+        juce::FloatVectorOperations::copy(workspace, frame, 2 * partitionSize);
+        juce::FloatVectorOperations::clear(workspace + 2 * partitionSize, 2 * partitionSize);
+        fft.performRealOnlyForwardTransform(workspace, true);
+        juce::FloatVectorOperations::copy(spectra + spectrumOffset(spectraPosition, spectrumSize), workspace, spectrumSize);
+
+        // Partition p pairs with the input spectrum from p blocks ago
+        juce::FloatVectorOperations::clear(accumulator, spectrumSize);
+
+        for (int partition = 0; partition < numPartitions; ++partition)
+        {
+            const int slot = (spectraPosition - partition + numPartitions) % numPartitions;
+            multiplyAccumulate(accumulator, spectra + spectrumOffset(slot, spectrumSize),
+                               filter + spectrumOffset(partition, spectrumSize), numBins);
+        }
+
+        juce::FloatVectorOperations::copy(workspace, accumulator, spectrumSize);
+        fft.performRealOnlyInverseTransform(workspace);
+        juce::FloatVectorOperations::copy(output, workspace + partitionSize, partitionSize);
+
+        juce::FloatVectorOperations::copy(frame, frame + partitionSize, partitionSize);
+    }
+
+    static size_t spectrumOffset(int index, int spectrumSize)
+    {
+        return static_cast<size_t>(index) * static_cast<size_t>(spectrumSize);
+    }
+
+    void processHeadBlock()
+    {
+        const int headBins = headSize + 1;
+
+        for (int channel = 0; channel < numEngineChannels; ++channel)
+        {
+            float* frame = &headFrame[static_cast<size_t>(channel * 2 * headSize)];
+            float* output = &headOutput[static_cast<size_t>(channel * headSize)];
+
+            // With the direct FIR covering the whole IR there is nothing to do
+            if (numHeadPartitions == 0)
+            {
+                juce::FloatVectorOperations::copy(frame, frame + headSize, headSize);
+                continue;
+            }
+
+            convolvePartitions(headFFT, frame, headSize, numHeadPartitions, headSpectraPosition,
+                               &headSpectra[static_cast<size_t>(channel * numHeadPartitions * 2 * headBins)],
+                               &headFilter[static_cast<size_t>(channel * numHeadPartitions * 2 * headBins)],
+                               headWorkspace.data(), headAccumulator.data(), output);
+        }
+
+        if (numHeadPartitions > 0)
+            headSpectraPosition = (headSpectraPosition + 1) % numHeadPartitions;
+    }
+
+    // Called after tail block j has been collected. The result for block j-1
+    // covers the next T samples of the ring; if the tail thread missed its
+    // deadline that stretch is left silent rather than waiting.
+    void exchangeTailBlock()
+    {
+        const juce::int64 j = tailBlockIndex;
+        const juce::int64 completed = completedTailBlocks.load(std::memory_order_acquire);
+        const size_t ringOffset = static_cast<size_t>(((j + 1) * tailSize) & (2 * tailSize - 1));
+
+        for (int channel = 0; channel < numEngineChannels; ++channel)
+        {
+            float* ring = &tailRing[static_cast<size_t>(channel * 2 * tailSize) + ringOffset];
+
+            if (j >= 1 && completed >= j)
+                juce::FloatVectorOperations::copy(ring, tailOutputSlot(static_cast<int>((j - 1) % numTailSlots), channel), tailSize);
+            else
+                juce::FloatVectorOperations::clear(ring, tailSize);
+        }
+
+        // The slot is only overwritten once the tail thread has moved past
+        // the block that last used it
+        if (completed > j - numTailSlots)
+        {
+            for (int channel = 0; channel < numEngineChannels; ++channel)
+                juce::FloatVectorOperations::copy(tailInputSlot(static_cast<int>(j % numTailSlots), channel),
+                                                  &tailCollect[static_cast<size_t>(channel * tailSize)], tailSize);
+        }
+
+        submittedTailBlocks.store(j + 1, std::memory_order_release);
+        ++tailBlockIndex;
+    }
+
+    float* headFilterPartition(int channel, int partition)
+    {
+        return &headFilter[static_cast<size_t>((channel * numHeadPartitions + partition) * 2 * (headSize + 1))];
+    }
+
+    float* tailFilterPartition(int channel, int partition)
+    {
+        return &tailFilter[static_cast<size_t>((channel * numTailPartitions + partition) * 2 * (tailSize + 1))];
+    }
+
+    float* tailInputSlot(int slot, int channel)
+    {
+        return &tailInputSlots[static_cast<size_t>((slot * numEngineChannels + channel) * tailSize)];
+    }
+
+    float* tailOutputSlot(int slot, int channel)
+    {
+        return &tailOutputSlots[static_cast<size_t>((slot * numEngineChannels + channel) * tailSize)];
+    }
+
+    //==============================================================================
+    juce::dsp::FFT headFFT;
+    juce::dsp::FFT tailFFT;
+
+    // Head, audio thread only
+    std::vector<float> directTaps;
+    std::vector<float> headFilter;
+    std::vector<float> headSpectra;
+    std::vector<float> headFrame;
+    std::vector<float> headOutput;
+    std::vector<float> headWorkspace;
+    std::vector<float> headAccumulator;
+    int headPosition = 0;
+    int headSpectraPosition = 0;
+
+    // Tail, tail thread only
+    std::vector<float> tailFilter;
+    std::vector<float> tailSpectra;
+    std::vector<float> tailFrame;
+    std::vector<float> tailWorkspace;
+    std::vector<float> tailAccumulator;
+    int tailSpectraPosition = 0;
+
+    // Tail hand-over, indexed by block number modulo numTailSlots
+    std::vector<float> tailInputSlots;
+    std::vector<float> tailOutputSlots;
+    std::atomic<juce::int64> submittedTailBlocks { 0 };
+    std::atomic<juce::int64> completedTailBlocks { 0 };
+
+    // Tail collection and playback, audio thread only. The ring holds two
+    // tail blocks so the low latency mode can read B samples behind.
+    std::vector<float> tailCollect;
+    std::vector<float> tailRing;
+    int tailCollectPosition = 0;
+    juce::int64 tailBlockIndex = 0;
+    juce::int64 time = 0;
+};
+
+//==============================================================================
+class ConvolutionReverb::TailThread : public juce::Thread
+{
+public:
+    explicit TailThread(ConvolutionReverb& reverbToServe)
+        : juce::Thread("Reverb Tail")
+        , reverb(reverbToServe)
+    {
+    }
+
+    void run() override
+    {
+        while (!threadShouldExit())
+        {
+            // Woken by the audio thread after each tail block; the timeout is
+            // only a safety net
+            wait(20);
+
+            std::lock_guard<std::mutex> lock(reverb.engineLock);
+
+            if (auto* engine = reverb.activeEngine.load())
+                engine->processPendingTailBlocks();
+
+            if (auto* engine = reverb.fadingEngine.load())
+                engine->processPendingTailBlocks();
+        }
+    }
+
+private:
+    ConvolutionReverb& reverb;
+};
+
+//==============================================================================
+class ConvolutionReverb::BuilderThread : public juce::Thread
+{
+public:
+    explicit BuilderThread(ConvolutionReverb& reverbToServe)
+        : juce::Thread("Reverb Builder")
+        , reverb(reverbToServe)
+    {
+    }
+
+    void run() override
+    {
+        while (!threadShouldExit())
+        {
+            wait(100);
+
+            reverb.deleteRetiredEngine();
+
+            if (reverb.rebuildRequested.exchange(false))
+            {
+                std::lock_guard<std::mutex> lock(reverb.buildLock);
+
+                // An engine the audio thread hasn't picked up yet is stale
+                if (auto* stale = reverb.pendingEngine.exchange(reverb.buildEngine().release()))
+                    delete stale;
+            }
+        }
+    }
+
+private:
+    ConvolutionReverb& reverb;
+};
+
+//==============================================================================
+ConvolutionReverb::ConvolutionReverb()
+    : sampleRate(44100.0)
+    , maxBlockSize(512)
+    , mix(0.0f)                 // Default: 0% (off)
+    , decay(2.0f)               // Default: 2 seconds
+    , headSize(128)
+    , headMode(HeadZeroLatency)
+    , userImpulseResponseSampleRate(44100.0)
+    , activeEngine(nullptr)
+    , fadingEngine(nullptr)
+    , pendingEngine(nullptr)
+    , retiredEngine(nullptr)
+    , rebuildRequested(false)
+    , fadeSamplesRemaining(0)
+    , fadeLength(1)
+    , ringOutRemaining(0)
+    , dryDelayPosition(0)
+    , dryDelayMask(0)
+{
+    tailThread = std::make_unique<TailThread>(*this);
+    builderThread = std::make_unique<BuilderThread>(*this);
+
+    tailThread->startThread();
+    builderThread->startThread();
+}
+
+ConvolutionReverb::~ConvolutionReverb()
+{
+    builderThread->stopThread(2000);
+    tailThread->stopThread(2000);
+
+    delete activeEngine.exchange(nullptr);
+    delete fadingEngine.exchange(nullptr);
+    delete pendingEngine.exchange(nullptr);
+    delete retiredEngine.exchange(nullptr);
+}
+
+//==============================================================================
+void ConvolutionReverb::prepareToPlay(double newSampleRate, int samplesPerBlock)
+{
+    std::lock_guard<std::mutex> buildGuard(buildLock);
+
+    sampleRate = newSampleRate;
+    maxBlockSize = samplesPerBlock;
+    fadeLength = juce::jmax(1, static_cast<int>(engineFadeSeconds * sampleRate));
+    fadeSamplesRemaining = 0;
+
+    // One sample longer than the largest latency, so that latency still
+    // reads behind the write position
+    const int dryDelaySize = juce::nextPowerOfTwo(maxHeadSize + 1);
+    dryDelayBuffer.setSize(numEngineChannels, dryDelaySize);
+    dryDelayMask = dryDelaySize - 1;
+    wetBuffer.setSize(numEngineChannels, samplesPerBlock);
+    fadingWetBuffer.setSize(numEngineChannels, samplesPerBlock);
+
+    // Any engine built or being built for the old rate is stale. The build
+    // lock is held, so the builder can't publish another one meanwhile.
+    rebuildRequested = false;
+    delete pendingEngine.exchange(nullptr);
+
+    auto engine = buildEngine();
+
+    {
+        std::lock_guard<std::mutex> lock(engineLock);
+        delete activeEngine.exchange(engine.release());
+        delete fadingEngine.exchange(nullptr);
+        delete retiredEngine.exchange(nullptr);
+    }
+
+    reset();
+}
+
+void ConvolutionReverb::processBlock(juce::AudioBuffer<float>& buffer, int numSamples)
+{
+    auto* engine = activeEngine.load();
+    const float wetGain = mix.load();
+
+    const int numChannels = juce::jmin(buffer.getNumChannels(), numEngineChannels);
+
+    if (engine == nullptr)
+        return;
+
+    // With the reverb off only the dry delay runs, so the reported latency
+    // still holds. The engine keeps running on silence until its tail has
+    // rung out, so raising the mix later doesn't replay a frozen tail.
+    if (wetGain <= 0.0f && fadeSamplesRemaining == 0)
+    {
+        for (int channel = 0; channel < numChannels; ++channel)
+            processDryDelay(buffer.getWritePointer(channel), channel, numSamples, engine->latency);
+
+        dryDelayPosition = (dryDelayPosition + numSamples) & dryDelayMask;
+
+        if (ringOutRemaining > 0)
+        {
+            bool tailBlockSubmitted = false;
+
+            for (int start = 0; start < numSamples; start += wetBuffer.getNumSamples())
+                tailBlockSubmitted |= engine->process(nullptr, wetBuffer.getArrayOfWritePointers(), numChannels,
+                                                      juce::jmin(numSamples - start, wetBuffer.getNumSamples()));
+
+            ringOutRemaining = juce::jmax(0, ringOutRemaining - numSamples);
+
+            if (tailBlockSubmitted)
+                tailThread->notify();
+        }
+
+        return;
+    }
+
+    ringOutRemaining = engine->getRingOutSamples();
+
+    auto* fading = fadingEngine.load();
+    bool tailBlockSubmitted = false;
+
+    // The scratch buffers are sized for the prepared block size, so larger
+    // host blocks are processed in pieces
+    for (int start = 0; start < numSamples; start += wetBuffer.getNumSamples())
+    {
+        const int chunk = juce::jmin(numSamples - start, wetBuffer.getNumSamples());
+
+        float* input[numEngineChannels] = {};
+        for (int channel = 0; channel < numChannels; ++channel)
+            input[channel] = buffer.getWritePointer(channel, start);
+
+        tailBlockSubmitted |= engine->process(input, wetBuffer.getArrayOfWritePointers(), numChannels, chunk);
+
+        // The previous engine rings out on silence while its level ramps down
+        if (fading != nullptr)
+        {
+            tailBlockSubmitted |= fading->process(nullptr, fadingWetBuffer.getArrayOfWritePointers(), numChannels, chunk);
+
+            const int fadeChunk = juce::jmin(chunk, fadeSamplesRemaining);
+            const float startGain = static_cast<float>(fadeSamplesRemaining) / static_cast<float>(fadeLength);
+            const float endGain = static_cast<float>(fadeSamplesRemaining - fadeChunk) / static_cast<float>(fadeLength);
+
+            for (int channel = 0; channel < numChannels; ++channel)
+            {
+                float* wet = wetBuffer.getWritePointer(channel);
+                const float* fadingWet = fadingWetBuffer.getReadPointer(channel);
+
+                for (int i = 0; i < fadeChunk; ++i)
+                    wet[i] += fadingWet[i] * (startGain + (endGain - startGain) * static_cast<float>(i) / static_cast<float>(fadeChunk));
+            }
+
+            fadeSamplesRemaining -= fadeChunk;
+        }
+
+        for (int channel = 0; channel < numChannels; ++channel)
+        {
+            float* data = input[channel];
+
+            processDryDelay(data, channel, chunk, engine->latency);
+
+            juce::FloatVectorOperations::multiply(data, 1.0f - wetGain, chunk);
+            juce::FloatVectorOperations::addWithMultiply(data, wetBuffer.getReadPointer(channel), wetGain, chunk);
+        }
+
+        dryDelayPosition = (dryDelayPosition + chunk) & dryDelayMask;
+    }
+
+    if (tailBlockSubmitted)
+        tailThread->notify();
+
+    // Hand the faded-out engine to the builder thread for deletion
+    if (fading != nullptr && fadeSamplesRemaining == 0 && retiredEngine.load() == nullptr)
+    {
+        retiredEngine.store(fadingEngine.exchange(nullptr));
+        builderThread->notify();
+    }
+}
+
+void ConvolutionReverb::reset()
+{
+    std::lock_guard<std::mutex> lock(engineLock);
+
+    if (auto* engine = activeEngine.load())
+        engine->reset();
+
+    if (auto* engine = fadingEngine.load())
+        engine->reset();
+
+    dryDelayBuffer.clear();
+    dryDelayPosition = 0;
+    ringOutRemaining = 0;
+}
+
+bool ConvolutionReverb::applyPendingEngine()
+{
+    // Wait for any fade in progress to finish and be handed off first
+    if (pendingEngine.load() == nullptr || fadingEngine.load() != nullptr)
+        return false;
+
+    auto* next = pendingEngine.exchange(nullptr);
+
+    if (next == nullptr)
+        return false;
+
+    fadingEngine.store(activeEngine.exchange(next));
+    fadeSamplesRemaining = fadeLength;
+
+    return true;
+}
+
+//==============================================================================
+void ConvolutionReverb::setMix(float newMix)
+{
+    mix = juce::jlimit(0.0f, 1.0f, newMix);
+}
+
+void ConvolutionReverb::setDecay(float seconds)
+{
+    seconds = juce::jlimit(0.1f, static_cast<float>(maxImpulseLengthSeconds), seconds);
+
+    if (seconds != decay.exchange(seconds))
+        requestRebuild();
+}
+
+void ConvolutionReverb::setHeadSize(int samples)
+{
+    samples = juce::jlimit(minHeadSize, maxHeadSize, juce::nextPowerOfTwo(samples));
+
+    if (samples != headSize.exchange(samples))
+        requestRebuild();
+}
+
+void ConvolutionReverb::setHeadMode(HeadMode mode)
+{
+    if (static_cast<int>(mode) != headMode.exchange(static_cast<int>(mode)))
+        requestRebuild();
+}
+
+float ConvolutionReverb::getMix() const
+{
+    return mix.load();
+}
+
+float ConvolutionReverb::getDecay() const
+{
+    return decay.load();
+}
+
+int ConvolutionReverb::getHeadSize() const
+{
+    return headSize.load();
+}
+
+ConvolutionReverb::HeadMode ConvolutionReverb::getHeadMode() const
+{
+    return static_cast<HeadMode>(headMode.load());
+}
+
+void ConvolutionReverb::loadImpulseResponse(const juce::AudioBuffer<float>& impulseResponse, double irSampleRate)
+{
+    {
+        std::lock_guard<std::mutex> lock(impulseResponseLock);
+        userImpulseResponse.makeCopyOf(impulseResponse);
+        userImpulseResponseSampleRate = irSampleRate;
+    }
+
+    requestRebuild();
+}
+
+//==============================================================================
+int ConvolutionReverb::getLatencySamples() const
+{
+    auto* engine = activeEngine.load();
+    return engine != nullptr ? engine->latency : 0;
+}
+
+double ConvolutionReverb::getTailLengthSeconds() const
+{
+    auto* engine = activeEngine.load();
+    return engine != nullptr ? engine->impulseLength / sampleRate : 0.0;
+}
+
+//==============================================================================
+std::unique_ptr<ConvolutionReverb::Engine> ConvolutionReverb::buildEngine()
+{
+    const int maxLength = static_cast<int>(maxImpulseLengthSeconds * sampleRate);
+    juce::AudioBuffer<float> impulseResponse;
+
+    {
+        std::lock_guard<std::mutex> lock(impulseResponseLock);
+
+        if (userImpulseResponse.getNumSamples() > 0)
+        {
+            // Resample the loaded IR to the current rate
+            const double ratio = userImpulseResponseSampleRate / sampleRate;
+            const int length = juce::jlimit(1, maxLength, static_cast<int>(userImpulseResponse.getNumSamples() / ratio));
+
+            impulseResponse.setSize(userImpulseResponse.getNumChannels(), length);
+
+            for (int channel = 0; channel < userImpulseResponse.getNumChannels(); ++channel)
+            {
+                if (ratio == 1.0)
+                {
+                    impulseResponse.copyFrom(channel, 0, userImpulseResponse, channel, 0, length);
+                    continue;
+                }
+
+                juce::LagrangeInterpolator interpolator;
+                interpolator.process(ratio, userImpulseResponse.getReadPointer(channel),
+                                     impulseResponse.getWritePointer(channel), length);
+            }
+        }
+    }
+
+    if (impulseResponse.getNumSamples() == 0)
+    {
+        // Synthetic IR: exponentially decaying noise reaching -60 dB at the
+        // decay time, decorrelated between channels, with a short fade-in
+        const double decaySeconds = decay.load();
+        const int length = juce::jlimit(1, maxLength, static_cast<int>(decaySeconds * sampleRate));
+        const int fadeInLength = juce::jmax(1, static_cast<int>(0.002 * sampleRate));
+        const double decayPerSample = std::exp(-6.907755278982137 / (decaySeconds * sampleRate));
+
+        impulseResponse.setSize(numEngineChannels, length);
+
+        for (int channel = 0; channel < numEngineChannels; ++channel)
+        {
+            juce::Random random(0x5eed + channel);
+            float* ir = impulseResponse.getWritePointer(channel);
+            double envelope = 1.0;
+
+            for (int i = 0; i < length; ++i)
+            {
+                const float fadeIn = juce::jmin(1.0f, static_cast<float>(i) / static_cast<float>(fadeInLength));
+                ir[i] = (2.0f * random.nextFloat() - 1.0f) * static_cast<float>(envelope) * fadeIn;
+                envelope *= decayPerSample;
+            }
+        }
+    }
+
+    // Normalise to unit energy, so the wet level matches the dry level for
+    // broadband input whatever the decay time
+    double maxEnergy = 0.0;
+
+    for (int channel = 0; channel < impulseResponse.getNumChannels(); ++channel)
+    {
+        double energy = 0.0;
+        const float* ir = impulseResponse.getReadPointer(channel);
+
+        for (int i = 0; i < impulseResponse.getNumSamples(); ++i)
+            energy += static_cast<double>(ir[i]) * ir[i];
+
+        maxEnergy = juce::jmax(maxEnergy, energy);
+    }
+
+    if (maxEnergy > 0.0)
+        impulseResponse.applyGain(static_cast<float>(1.0 / std::sqrt(maxEnergy)));
+
+    // Each tail result is due one tail block after submission, but the tail
+    // thread is only woken between host blocks. Keeping T at least two host
+    // blocks long leaves it at least one block period of time.
+    const int head = headSize.load();
+    const int tail = juce::jmax(head * tailPartitionMultiple, 2 * juce::nextPowerOfTwo(maxBlockSize));
+
+    return std::make_unique<Engine>(impulseResponse, head, tail, headMode.load() == HeadZeroLatency);
+}
+
+void ConvolutionReverb::requestRebuild()
+{
+    rebuildRequested = true;
+
+    if (builderThread != nullptr)
+        builderThread->notify();
+}
+
+void ConvolutionReverb::deleteRetiredEngine()
+{
+    if (retiredEngine.load() == nullptr)
+        return;
+
+    // Taking the lock guarantees the tail thread isn't still inside it
+    std::lock_guard<std::mutex> lock(engineLock);
+    delete retiredEngine.exchange(nullptr);
+}
+
+void ConvolutionReverb::processDryDelay(float* data, int channel, int numSamples, int latency)
+{
+    if (latency == 0)
+        return;
+
+    float* delayLine = dryDelayBuffer.getWritePointer(channel);
+
+    for (int i = 0; i < numSamples; ++i)
+    {
+        const int writePosition = (dryDelayPosition + i) & dryDelayMask;
+        const int readPosition = (writePosition - latency) & dryDelayMask;
+
+        delayLine[writePosition] = data[i];
+        data[i] = delayLine[readPosition];
+    }
+}
@@ -0,0 +1,138 @@
+#pragma once
+
+#include <JuceHeader.h>
+#include <atomic>
+#include <mutex>
+
+//==============================================================================
+/**
+ * Partitioned FFT convolution reverb.
+ *
+ * The impulse response is split into a head and a tail. The head, covering
+ * the first 2T samples, is convolved on the audio thread with uniform
+ * partitions of the head size B. The tail is convolved with larger partitions
+ * of T = 8B samples (or two host blocks, if longer) on a background thread,
+ * which has a whole tail block of time to deliver each result.
+ *
+ * In zero latency mode the first B taps run as a direct-form FIR and the
+ * partitions start at B, so nothing is delayed. In low latency mode the
+ * partitions start at 0 and the output is delayed by B samples.
+ *
+ * All IR preparation (synthesis, resampling, partition FFTs) happens on a
+ * builder thread. Finished engines are swapped in on the audio thread by
+ * applyPendingEngine(), and the previous engine rings out with its input
+ * muted while it fades.
+ */
+class ConvolutionReverb
+{
+public:
+    //==============================================================================
+    enum HeadMode
+    {
+        HeadZeroLatency = 0,   // direct FIR for the first partition
+        HeadLowLatency,        // all partitions by FFT, B samples of latency
+        NumHeadModes
+    };
+
+    static constexpr int minHeadSize = 64;
+    static constexpr int maxHeadSize = 1024;
+
+    //==============================================================================
+    ConvolutionReverb();
+    ~ConvolutionReverb();
+
+    //==============================================================================
+    // Builds the first engine synchronously, so it must not be called while
+    // processBlock may be running.
+    void prepareToPlay(double sampleRate, int samplesPerBlock);
+    void processBlock(juce::AudioBuffer<float>& buffer, int numSamples);
+    void reset();
+
+    // Swaps in an engine built since the last call. Returns true if it did,
+    // as the latency may have changed.
+    bool applyPendingEngine();
+
+    //==============================================================================
+    // Can be called from any thread. Changes that need a new engine are
+    // built in the background.
+    void setMix(float mix);
+    void setDecay(float seconds);
+    void setHeadSize(int samples);
+    void setHeadMode(HeadMode mode);
+
+    float getMix() const;
+    float getDecay() const;
+    int getHeadSize() const;
+    HeadMode getHeadMode() const;
+
+    //==============================================================================
+    // Replaces the synthetic decaying-noise impulse response. Call from the
+    // message thread; the IR is resampled and partitioned on the builder
+    // thread. An empty buffer reverts to the synthetic IR.
+    void loadImpulseResponse(const juce::AudioBuffer<float>& impulseResponse, double irSampleRate);
+
+    //==============================================================================
+    int getLatencySamples() const;
+    double getTailLengthSeconds() const;
+
+private:
+    //==============================================================================
+    struct Engine;
+    class TailThread;
+    class BuilderThread;
+
+    // Renders the IR and partitions it. Called with buildLock held, from the
+    // builder thread or prepareToPlay.
+    std::unique_ptr<Engine> buildEngine();
+    void requestRebuild();
+    void deleteRetiredEngine();
+
+    void processDryDelay(float* data, int channel, int numSamples, int latency);
+
+    //==============================================================================
+    double sampleRate;
+    int maxBlockSize;
+
+    std::atomic<float> mix;
+    std::atomic<float> decay;      // seconds to -60 dB for the synthetic IR
+    std::atomic<int> headSize;
+    std::atomic<int> headMode;
+
+    // User IR, shared between the message and builder threads only
+    std::mutex impulseResponseLock;
+    juce::AudioBuffer<float> userImpulseResponse;
+    double userImpulseResponseSampleRate;
+
+    // The audio thread owns activeEngine and fadingEngine; the tail thread
+    // reads them while holding engineLock. Built engines arrive through
+    // pendingEngine, and replaced ones leave through retiredEngine to be
+    // deleted by the builder thread once engineLock shows the tail thread
+    // is done with them.
+    std::atomic<Engine*> activeEngine;
+    std::atomic<Engine*> fadingEngine;
+    std::atomic<Engine*> pendingEngine;
+    std::atomic<Engine*> retiredEngine;
+
+    std::mutex engineLock;
+    std::mutex buildLock;
+    std::atomic<bool> rebuildRequested;
+
+    // Crossfade from the previous engine after a swap
+    int fadeSamplesRemaining;
+    int fadeLength;
+
+    // Silence still to feed the active engine after the mix drops to zero
+    int ringOutRemaining;
+
+    // Dry path delay matching the head latency, and wet scratch buffers
+    juce::AudioBuffer<float> dryDelayBuffer;
+    int dryDelayPosition;
+    int dryDelayMask;
+    juce::AudioBuffer<float> wetBuffer;
+    juce::AudioBuffer<float> fadingWetBuffer;
+
+    std::unique_ptr<TailThread> tailThread;
+    std::unique_ptr<BuilderThread> builderThread;
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(ConvolutionReverb)
+};
@@ -1,15 +1,121 @@
 #include "EffectsProcessor.h"
+#include <cstring>
+
+//==============================================================================
+// Rational (Pade 7/6) approximation of tanh. Clamping the input keeps it within
+// 1e-4 of std::tanh over the whole range, and unlike std::tanh it has no
+// library call or branches, so loops using it auto-vectorise.
+static inline float fastTanh(float x)
+{
+    x = juce::jlimit(-4.97f, 4.97f, x);
+    
+    const float x2 = x * x;
+    const float numerator = x * (135135.0f + x2 * (17325.0f + x2 * (378.0f + x2)));
+    const float denominator = 135135.0f + x2 * (62370.0f + x2 * (3150.0f + x2 * 28.0f));
+    
+    return juce::jlimit(-1.0f, 1.0f, numerator / denominator);
+}
+
+//==============================================================================
+// Antiderivatives of tanh for the ADAA drive modes. With a = |x| and
+// v = exp(-2a) they split into a closed-form part and a bounded residual:
+//
+//   F1(x) = log(cosh(x)) = a - ln2 + ln(1 + v)
+//   F2(x) = sign(x) * (a^2 / 2 - a ln2 + Li2(-v) / 2 + pi^2 / 24)
+//
+// exp, ln(1 + v) and Li2(-v) are evaluated with polynomials over [0, 1]
+// (fitted as v * poly(v) so the residuals vanish exactly for large |x|).
+// Keeping the large closed-form terms separate stops them from swamping the
+// residual differences in the divided differences.
+
+// 2^y for y in [-126, 0], exact exponent plus a degree-5 mantissa polynomial
+static inline float fastExp2(float y)
+{
+    int exponent = static_cast<int>(y);
+    exponent -= (static_cast<float>(exponent) > y) ? 1 : 0;
+    const float f = y - static_cast<float>(exponent);
+    
+    const float mantissa = 9.999998957631346e-01f + f * (6.931546200033226e-01f + f * (2.401407700917055e-01f
+                         + f * (5.586328265956227e-02f + f * (8.946214666036241e-03f + f * 1.895107291106797e-03f))));
+    
+    const std::int32_t bits = (exponent + 127) << 23;
+    float scale;
+    std::memcpy(&scale, &bits, sizeof(scale));
+    return mantissa * scale;
+}
+
+static inline double fastExp2(double y)
+{
+    std::int64_t exponent = static_cast<std::int64_t>(y);
+    exponent -= (static_cast<double>(exponent) > y) ? 1 : 0;
+    const double f = y - static_cast<double>(exponent);
+    
+    const double mantissa = 9.999999999999801e-01 + f * (6.931471805637521e-01 + f * (2.402265068354921e-01
+                          + f * (5.550411023332823e-02 + f * (9.618118988771442e-03 + f * (1.333393264039274e-03
+                          + f * (1.539511839473562e-04 + f * (1.536900722385326e-05 + f * (1.225559281010646e-06
+                          + f * 1.443641667719931e-07))))))));
+    
+    const std::int64_t bits = (exponent + 1023) << 52;
+    double scale;
+    std::memcpy(&scale, &bits, sizeof(scale));
+    return mantissa * scale;
+}
+
+// ln(1 + exp(-2|x|)), the bounded part of log(cosh(x))
+static inline float logCoshResidual(float x)
+{
+    const float a = juce::jmin(std::abs(x), 40.0f);
+    const float v = fastExp2(-2.885390081777927f * a); // exp(-2a)
+    
+    return v * (9.999998102178e-01f + v * (-4.999744938483e-01f + v * (3.327617657147e-01f + v * (-2.449961172437e-01f
+              + v * (1.775702399194e-01f + v * (-1.078536791680e-01f + v * (4.421419233608e-02f + v * -8.574676204380e-03f)))))));
+}
+
+// First and second antiderivatives of tanh, in double precision
+static inline void tanhAntiderivatives(double x, double& ad1, double& ad2)
+{
+    constexpr double ln2 = 0.6931471805599453;
+    constexpr double pi2Over24 = 0.4112335167120566;
+    
+    // Only the exponential is clamped; the closed-form terms need the real
+    // |x| or hot inputs stop moving the antiderivatives
+    const double a = std::abs(x);
+    const double v = fastExp2(-2.885390081777927 * juce::jmin(a, 40.0)); // exp(-2a)
+    
+    const double log1pv = v * (9.999999953849e-01 + v * (-4.999990399276e-01 + v * (3.333000403518e-01
+                        + v * (-2.495455887087e-01 + v * (1.967811725574e-01 + v * (-1.531186310104e-01
+                        + v * (1.061426468556e-01 + v * (-5.706420074924e-02 + v * (1.990716092048e-02
+                        + v * -3.256378471851e-03)))))))));
+    
+    const double li2 = v * (-9.999999994486e-01 + v * (2.499998856996e-01 + v * (-1.111071656177e-01
+                     + v * (6.244647537840e-02 + v * (-3.962401162411e-02 + v * (2.621400875358e-02
+                     + v * (-1.624516286081e-02 + v * (8.131727421605e-03 + v * (-2.714956794880e-03
+                     + v * 4.321660802816e-04)))))))));
+    
+    ad1 = a - ln2 + log1pv;
+    ad2 = (x < 0.0 ? -1.0 : 1.0) * (0.5 * a * a - a * ln2 + 0.5 * li2 + pi2Over24);
+}
+
+// Round half away from zero like std::round, but as a truncating conversion
+// that vectorises
+static inline float roundToLevel(float x)
+{
+    return static_cast<float>(static_cast<int>(x + (x < 0.0f ? -0.5f : 0.5f)));
+}
 
 //==============================================================================
 EffectsProcessor::EffectsProcessor()
     : sampleRate(44100.0)
+    , oversamplingFactor(1)
     , drive(0.0f)         // Default: 0%
+    , driveMode(DriveStandard)
     , bitDepth(16.0f)     // Default: 16-bit (no reduction)
+    , crushRate(1.0f)     // Default: full sample rate
     , stereoWidth(1.0f)   // Default: 100% (normal stereo)
-    , bitCrushPhase(0.0f)
-    , bitCrushLastSampleL(0.0f)
-    , bitCrushLastSampleR(0.0f)
+    , crushLevels(65535.0f)
+    , crushLevelSize(1.0f / 65535.0f)
 {
+    reset();
 }
 
 EffectsProcessor::~EffectsProcessor()
@@ -25,58 +131,146 @@ void EffectsProcessor::prepareToPlay(double newSampleRate, int /*samplesPerBlock
 
 void EffectsProcessor::processBlock(juce::AudioBuffer<float>& buffer, int numSamples)
 {
-    // Stereo width requires at least 2 channels
-    const bool stereo = buffer.getNumChannels() >= 2;
+    processNonlinearBlock(buffer, numSamples);
+    processStereoBlock(buffer, numSamples);
+}
+
+void EffectsProcessor::processNonlinearBlock(juce::AudioBuffer<float>& buffer, int numSamples)
+{
+    const int numChannels = juce::jmin(buffer.getNumChannels(), 2);
+    float* const* channels = buffer.getArrayOfWritePointers();
     
-    for (int sample = 0; sample < numSamples; ++sample)
+    // Each stage runs as a separate pass over the whole block, and disabled
+    // stages are skipped entirely rather than tested on every sample
+    if (drive > 0.0f && waveshaper.getCurve() != Waveshaper::Tanh)
     {
-        // Get left channel sample
-        float left = buffer.getSample(0, sample);
-        
-        // Apply drive
-        left = applyDrive(left);
+        waveshaper.applyPendingTable();
         
-        // Apply bit crush
-        left = applyBitCrush(left, 0);
-        
-        // Handle stereo if available
-        if (stereo)
-        {
-            float right = buffer.getSample(1, sample);
-            right = applyDrive(right);
-            right = applyBitCrush(right, 1);
-            
-            // Apply stereo width
-            applyStereoWidth(left, right);
-            
-            // Write back to buffer
-            buffer.setSample(0, sample, left);
-            buffer.setSample(1, sample, right);
-        }
-        else
+        for (int channel = 0; channel < numChannels; ++channel)
+            waveshaper.processBlock(channels[channel], numSamples);
+    }
+    else if (drive > 0.0f)
+    {
+        for (int channel = 0; channel < numChannels; ++channel)
         {
-            // Mono case
-            buffer.setSample(0, sample, left);
+            switch (driveMode)
+            {
+                case DriveADAA1:
+                    applyDriveADAA1Block(channels[channel], channel, numSamples);
+                    break;
+                    
+                case DriveADAA2:
+                    applyDriveADAA2Block(channels[channel], channel, numSamples);
+                    break;
+                    
+                case DriveStandard:
+                default:
+                    applyDriveBlock(channels[channel], numSamples);
+                    break;
+            }
         }
     }
+    
+    // Decimation quantises only the held samples, so the quantiser only runs
+    // as a separate full-rate pass when there is no rate reduction
+    if (crushRate > 1.0f)
+    {
+        for (int channel = 0; channel < numChannels; ++channel)
+            applyDecimateBlock(channels[channel], channel, numSamples);
+    }
+    else if (bitDepth < 16.0f)
+    {
+        for (int channel = 0; channel < numChannels; ++channel)
+            applyQuantiseBlock(channels[channel], numSamples);
+    }
+}
+
+void EffectsProcessor::processStereoBlock(juce::AudioBuffer<float>& buffer, int numSamples)
+{
+    // Stereo width requires at least 2 channels, and has no effect at 100%
+    if (buffer.getNumChannels() < 2 || std::abs(stereoWidth - 1.0f) < 0.01f)
+        return;
+    
+    applyStereoWidthBlock(buffer.getWritePointer(0), buffer.getWritePointer(1), numSamples);
 }
 
 void EffectsProcessor::reset()
 {
-    bitCrushPhase = 0.0f;
-    bitCrushLastSampleL = 0.0f;
-    bitCrushLastSampleR = 0.0f;
+    for (int channel = 0; channel < 2; ++channel)
+    {
+        driveState[channel] = DriveADAAState();
+        driveState[channel].residual1 = logCoshResidual(0.0f);
+        
+        crushPhase[channel] = 0.0f;
+        crushHeldSample[channel] = 0.0f;
+    }
 }
 
 //==============================================================================
 void EffectsProcessor::setDrive(float newDrive)
 {
     drive = juce::jlimit(0.0f, 1.0f, newDrive);
+    waveshaper.setDrive(drive);
+}
+
+void EffectsProcessor::setMorphDrives(float driveA, float driveB)
+{
+    waveshaper.setMorphDrives(driveA, driveB);
+}
+
+void EffectsProcessor::setMorphedDrive(float newDrive, float morphPosition)
+{
+    drive = juce::jlimit(0.0f, 1.0f, newDrive);
+    waveshaper.setMorphPosition(morphPosition);
+}
+
+void EffectsProcessor::endDriveMorph()
+{
+    waveshaper.endMorph();
+}
+
+void EffectsProcessor::setParameterDrive(float newDrive)
+{
+    waveshaper.setDrive(newDrive);
+}
+
+void EffectsProcessor::setDriveMode(DriveMode mode)
+{
+    if (mode != driveMode)
+    {
+        // The ADAA history is only valid for the mode that wrote it
+        for (auto& state : driveState)
+        {
+            state = DriveADAAState();
+            state.residual1 = logCoshResidual(0.0f);
+        }
+    }
+    
+    driveMode = mode;
+}
+
+void EffectsProcessor::setDriveCurve(Waveshaper::Curve curve)
+{
+    waveshaper.setCurve(curve);
 }
 
 void EffectsProcessor::setBitcrush(float newBitDepth)
 {
     bitDepth = juce::jlimit(1.0f, 16.0f, newBitDepth);
+    
+    // Calculate the number of levels based on bit depth
+    crushLevels = static_cast<float>(static_cast<int>(std::pow(2.0f, bitDepth) - 1.0f));
+    crushLevelSize = 1.0f / crushLevels;
+}
+
+void EffectsProcessor::setCrushRate(float reductionFactor)
+{
+    crushRate = juce::jlimit(1.0f, 64.0f, reductionFactor);
+}
+
+void EffectsProcessor::setOversamplingFactor(int factor)
+{
+    oversamplingFactor = juce::jmax(1, factor);
 }
 
 void EffectsProcessor::setStereoWidth(float width)
@@ -89,93 +283,224 @@ float EffectsProcessor::getDrive() const
     return drive;
 }
 
+EffectsProcessor::DriveMode EffectsProcessor::getDriveMode() const
+{
+    return driveMode;
+}
+
+Waveshaper::Curve EffectsProcessor::getDriveCurve() const
+{
+    return waveshaper.getCurve();
+}
+
 float EffectsProcessor::getBitcrush() const
 {
     return bitDepth;
 }
 
+float EffectsProcessor::getCrushRate() const
+{
+    return crushRate;
+}
+
 float EffectsProcessor::getStereoWidth() const
 {
     return stereoWidth;
 }
 
 //==============================================================================
-float EffectsProcessor::applyDrive(float sample)
+void EffectsProcessor::applyDriveBlock(float* data, int numSamples)
 {
-    // Simple tanh distortion with variable drive
-    if (drive <= 0.0f)
-        return sample;
-    
     // Scale drive from 0-1 to a more useful range
     const float driveAmount = 1.0f + drive * 9.0f; // 1 to 10
     
-    // Apply soft clipping with variable drive
-    float driven = std::tanh(sample * driveAmount);
-    
     // Compensate for volume increase when adding drive
-    driven /= (0.5f * drive + 0.5f);
+    const float makeupGain = 1.0f / (0.5f * drive + 0.5f);
     
-    return driven;
+    // Soft clipping with variable drive
+    for (int i = 0; i < numSamples; ++i)
+        data[i] = fastTanh(data[i] * driveAmount) * makeupGain;
 }
 
-float EffectsProcessor::applyBitCrush(float sample, int channel)
+// Both ADAA kernels work through the block in chunks on the stack: the
+// antiderivatives are evaluated for every input first, then the divided
+// differences are taken in a second pass. Neither pass has a loop-carried
+// dependency, and the ill-conditioned fallbacks are computed alongside and
+// selected per sample, so both loops vectorise.
+static constexpr int adaaChunkSize = 64;
+
+void EffectsProcessor::applyDriveADAA1Block(float* data, int channel, int numSamples)
 {
-    // If bit depth is maximum, no effect
-    if (bitDepth >= 16.0f)
-        return sample;
+    // Below this input difference the divided difference loses too much
+    // precision and the midpoint is used instead
+    constexpr float tolerance = 1.0e-3f;
     
-    // Calculate the number of levels based on bit depth
-    const int levels = static_cast<int>(std::pow(2.0f, bitDepth) - 1.0f);
+    const float driveAmount = 1.0f + drive * 9.0f;
+    const float makeupGain = 1.0f / (0.5f * drive + 0.5f);
+    auto& state = driveState[channel];
     
-    // Apply bit reduction
-    const float crushedSample = std::round(sample * levels) / static_cast<float>(levels);
+    float x[adaaChunkSize + 1];
+    float residual[adaaChunkSize + 1];
     
-    // At very low bit depths, also apply sample rate reduction for a more digital sound
-    if (bitDepth <= 8.0f)
+    for (int start = 0; start < numSamples; start += adaaChunkSize)
     {
-        // Map 1-8 bit depth to sample rate reduction factor 
-        // (lower bit depth = more sample rate reduction)
-        const float srReductionFactor = 0.5f * (8.0f - bitDepth) / 8.0f; // 0 to 0.5
+        const int chunkSize = juce::jmin(adaaChunkSize, numSamples - start);
+        float* output = data + start;
         
-        // Calculate phase increment for sample rate reduction
-        const float phaseIncrement = 1.0f / (1.0f + srReductionFactor * 40.0f); // 1 to 1/20
+        x[0] = state.x1;
+        residual[0] = state.residual1;
         
-        // Update phase
-        bitCrushPhase += phaseIncrement;
+        for (int i = 0; i < chunkSize; ++i)
+        {
+            x[i + 1] = output[i] * driveAmount;
+            residual[i + 1] = logCoshResidual(x[i + 1]);
+        }
         
-        // Check if we need to update the output sample
-        if (bitCrushPhase >= 1.0f)
+        for (int i = 0; i < chunkSize; ++i)
         {
-            bitCrushPhase -= 1.0f;
+            const float delta = x[i + 1] - x[i];
+            const bool illConditioned = std::abs(delta) < tolerance;
             
-            // Update the held sample
-            if (channel == 0)
-                bitCrushLastSampleL = crushedSample;
-            else
-                bitCrushLastSampleR = crushedSample;
+            // (F1(x[n]) - F1(x[n-1])) / (x[n] - x[n-1]), the ln2 terms cancel
+            const float difference = (std::abs(x[i + 1]) - std::abs(x[i])) + (residual[i + 1] - residual[i]);
+            const float slope = difference / (illConditioned ? 1.0f : delta);
+            const float midpoint = fastTanh(0.5f * (x[i + 1] + x[i]));
+            
+            output[i] = (illConditioned ? midpoint : slope) * makeupGain;
         }
         
-        // Return the held sample
-        return (channel == 0) ? bitCrushLastSampleL : bitCrushLastSampleR;
+        state.x1 = x[chunkSize];
+        state.residual1 = residual[chunkSize];
     }
+}
+
+void EffectsProcessor::applyDriveADAA2Block(float* data, int channel, int numSamples)
+{
+    constexpr double tolerance = 1.0e-4;
+    
+    const double driveAmount = 1.0 + drive * 9.0;
+    const float makeupGain = 1.0f / (0.5f * drive + 0.5f);
+    auto& state = driveState[channel];
+    
+    // Index i + 2 holds the current input, i + 1 and i the two before it
+    double x[adaaChunkSize + 2];
+    double ad1[adaaChunkSize + 2];
+    double ad2[adaaChunkSize + 2];
+    double slope[adaaChunkSize + 1];
     
-    return crushedSample;
+    for (int start = 0; start < numSamples; start += adaaChunkSize)
+    {
+        const int chunkSize = juce::jmin(adaaChunkSize, numSamples - start);
+        float* output = data + start;
+        
+        x[0] = state.x2d;
+        x[1] = state.x1d;
+        ad1[1] = state.ad1;
+        ad2[1] = state.ad2;
+        slope[0] = state.slope1;
+        
+        for (int i = 0; i < chunkSize; ++i)
+        {
+            x[i + 2] = static_cast<double>(output[i]) * driveAmount;
+            tanhAntiderivatives(x[i + 2], ad1[i + 2], ad2[i + 2]);
+        }
+        
+        // First divided differences of F2, falling back to the trapezoid
+        // average of F1 when the inputs are too close together
+        for (int i = 0; i < chunkSize; ++i)
+        {
+            const double delta = x[i + 2] - x[i + 1];
+            const bool illConditioned = std::abs(delta) < tolerance;
+            
+            const double divided = (ad2[i + 2] - ad2[i + 1]) / (illConditioned ? 1.0 : delta);
+            slope[i + 1] = illConditioned ? 0.5 * (ad1[i + 2] + ad1[i + 1]) : divided;
+        }
+        
+        // Second divided difference. When x[n] ~ x[n-2] it tends to tanh of
+        // the kernel's centroid, (2 * mean(x[n], x[n-2]) + x[n-1]) / 3.
+        for (int i = 0; i < chunkSize; ++i)
+        {
+            const double span = x[i + 2] - x[i];
+            const bool illConditioned = std::abs(span) < tolerance;
+            
+            const double divided = 2.0 * (slope[i + 1] - slope[i]) / (illConditioned ? 1.0 : span);
+            const float centroid = fastTanh(static_cast<float>((x[i + 2] + x[i] + x[i + 1]) / 3.0));
+            
+            output[i] = (illConditioned ? centroid : static_cast<float>(divided)) * makeupGain;
+        }
+        
+        state.x2d = x[chunkSize];
+        state.x1d = x[chunkSize + 1];
+        state.ad1 = ad1[chunkSize + 1];
+        state.ad2 = ad2[chunkSize + 1];
+        state.slope1 = slope[chunkSize];
+    }
 }
 
-void EffectsProcessor::applyStereoWidth(float& left, float& right)
+void EffectsProcessor::applyQuantiseBlock(float* data, int numSamples)
 {
-    // If stereo width is normal (1.0), no effect
-    if (std::abs(stereoWidth - 1.0f) < 0.01f)
+    // 16-bit is the "off" position of the bit depth control
+    if (bitDepth >= 16.0f)
         return;
     
-    // Calculate mid and side components
-    float mid = (left + right) * 0.5f;
-    float side = (left - right) * 0.5f;
+    for (int i = 0; i < numSamples; ++i)
+        data[i] = roundToLevel(data[i] * crushLevels) * crushLevelSize;
+}
+
+void EffectsProcessor::applyDecimateBlock(float* data, int channel, int numSamples)
+{
+    // One hold period lasts crushRate base-rate samples, so scale the phase
+    // increment down when running oversampled
+    const float phaseIncrement = 1.0f / (crushRate * static_cast<float>(oversamplingFactor));
+    const bool quantise = bitDepth < 16.0f;
+    
+    float phase = crushPhase[channel];
+    float held = crushHeldSample[channel];
+    int i = 0;
+    
+    while (i < numSamples)
+    {
+        // Number of samples that keep the current held value before the
+        // phase wraps and a new input sample is taken
+        const int samplesToHold = juce::jmax(0, static_cast<int>(std::ceil((1.0f - phase) / phaseIncrement)) - 1);
+        
+        if (samplesToHold >= numSamples - i)
+        {
+            // No hold boundary left in this block
+            const int remaining = numSamples - i;
+            juce::FloatVectorOperations::fill(data + i, held, remaining);
+            phase += phaseIncrement * static_cast<float>(remaining);
+            break;
+        }
+        
+        juce::FloatVectorOperations::fill(data + i, held, samplesToHold);
+        i += samplesToHold;
+        
+        // Hold boundary: the quantiser only runs here
+        held = quantise ? roundToLevel(data[i] * crushLevels) * crushLevelSize : data[i];
+        data[i] = held;
+        ++i;
+        
+        phase += phaseIncrement * static_cast<float>(samplesToHold + 1) - 1.0f;
+    }
     
-    // Apply width to side component
-    side *= stereoWidth;
+    crushPhase[channel] = phase;
+    crushHeldSample[channel] = held;
+}
+
+void EffectsProcessor::applyStereoWidthBlock(float* left, float* right, int numSamples)
+{
+    // Mid/side width folded into a 2x2 matrix:
+    // mid = (l + r) / 2, side = width * (l - r) / 2, l' = mid + side, r' = mid - side
+    const float direct = 0.5f * (1.0f + stereoWidth);
+    const float cross = 0.5f * (1.0f - stereoWidth);
     
-    // Convert back to left/right
-    left = mid + side;
-    right = mid - side;
-}
\ No newline at end of file
+    for (int i = 0; i < numSamples; ++i)
+    {
+        const float l = left[i];
+        const float r = right[i];
+        
+        left[i] = direct * l + cross * r;
+        right[i] = cross * l + direct * r;
+    }
+}
@@ -1,6 +1,7 @@
 #pragma once
 
 #include <JuceHeader.h>
+#include "Waveshaper.h"
 
 //==============================================================================
 /**
@@ -9,6 +10,15 @@
 class EffectsProcessor
 {
 public:
+    //==============================================================================
+    enum DriveMode
+    {
+        DriveStandard = 0,
+        DriveADAA1,        // First-order antiderivative anti-aliasing
+        DriveADAA2,        // Second-order antiderivative anti-aliasing
+        NumDriveModes
+    };
+
     //==============================================================================
     EffectsProcessor();
     ~EffectsProcessor();
@@ -18,34 +28,84 @@ public:
     void processBlock(juce::AudioBuffer<float>& buffer, int numSamples);
     void reset();
 
+    //==============================================================================
+    // The nonlinear stages (drive, bitcrush) can run inside an oversampled
+    // section, while stereo width is applied afterwards at the base rate.
+    void processNonlinearBlock(juce::AudioBuffer<float>& buffer, int numSamples);
+    void processStereoBlock(juce::AudioBuffer<float>& buffer, int numSamples);
+    
+    // Rate multiplier of the buffers passed to processNonlinearBlock, so the
+    // bitcrusher's sample-rate reduction sounds the same at any factor.
+    void setOversamplingFactor(int factor);
+
     //==============================================================================
     void setDrive(float drive);
+    void setDriveMode(DriveMode mode);
+    void setDriveCurve(Waveshaper::Curve curve);
     void setBitcrush(float bitDepth);
+    void setCrushRate(float reductionFactor);
     void setStereoWidth(float width);
     
+    // The preset morph's drive. The curve tables for snapshot A's and B's
+    // drive are baked from the message thread when the snapshots are
+    // stored; the audio thread then only moves between them.
+    void setMorphDrives(float driveA, float driveB);
+    void setMorphedDrive(float drive, float morphPosition);
+    void endDriveMorph();
+    
+    // Bakes the drive parameter's curve table without changing the drive in
+    // use, so it is ready when the morph ends. Message thread.
+    void setParameterDrive(float drive);
+    
     float getDrive() const;
+    DriveMode getDriveMode() const;
+    Waveshaper::Curve getDriveCurve() const;
     float getBitcrush() const;
+    float getCrushRate() const;
     float getStereoWidth() const;
 
 private:
     //==============================================================================
     double sampleRate;
+    int oversamplingFactor;
     
     float drive;      // 0 to 1
+    DriveMode driveMode;  // only applies to the analytic tanh curve
     float bitDepth;   // 1 to 16
+    float crushRate;  // 1 to 64, sample rate reduction factor
     float stereoWidth; // 0 to 2
     
-    // State for bit crushing
-    float bitCrushPhase;
-    float bitCrushLastSampleL;
-    float bitCrushLastSampleR;
+    // Quantiser levels, cached when the bit depth changes
+    float crushLevels;
+    float crushLevelSize;
+    
+    // Per-channel history for the ADAA drive modes. The second-order mode
+    // runs in double precision, as its second divided difference of the
+    // antiderivative amplifies rounding error.
+    struct DriveADAAState
+    {
+        float x1;          // previous driven input
+        float residual1;   // log-cosh residual at x1
+        
+        double x1d, x2d;   // previous two driven inputs
+        double ad1, ad2;   // first and second antiderivatives at x1d
+        double slope1;     // previous first divided difference
+    };
+    
+    DriveADAAState driveState[2];
     
-    // Apply drive (saturation) to a sample
-    float applyDrive(float sample);
+    // Table-driven curves for everything other than tanh
+    Waveshaper waveshaper;
     
-    // Apply bit crushing to a sample
-    float applyBitCrush(float sample, int channel);
+    // Per-channel sample-and-hold state for the decimator
+    float crushPhase[2];
+    float crushHeldSample[2];
     
-    // Apply stereo width to left/right channels
-    void applyStereoWidth(float& left, float& right);
+    // Block kernels over raw channel pointers, only called for active stages
+    void applyDriveBlock(float* data, int numSamples);
+    void applyDriveADAA1Block(float* data, int channel, int numSamples);
+    void applyDriveADAA2Block(float* data, int channel, int numSamples);
+    void applyQuantiseBlock(float* data, int numSamples);
+    void applyDecimateBlock(float* data, int channel, int numSamples);
+    void applyStereoWidthBlock(float* left, float* right, int numSamples);
 };
\ No newline at end of file
@@ -7,6 +7,9 @@ EnvelopeGenerator::EnvelopeGenerator()
     , decayTime(100.0f)      // Default: 100ms
     , sustainLevel(0.7f)     // Default: 0.7
     , releaseTime(500.0f)    // Default: 500ms
+    , attackCurve(0.0f)      // Default: linear
+    , decayCurve(0.0f)
+    , releaseCurve(0.0f)
     , currentStage(Idle)
     , currentLevel(0.0f)
     , currentVelocity(0.0f)
@@ -15,6 +18,13 @@ EnvelopeGenerator::EnvelopeGenerator()
     , releaseRate(0.0f)
     , oneShot(false)
     , noteIsOn(false)
+    , segmentSamplesRemaining(0)
+    , segmentEndLevel(0.0f)
+    , segmentIsCurved(false)
+    , segmentStep(0.0f)
+    , segmentTarget(0.0f)
+    , segmentMultiplier(1.0f)
+    , retimePending(false)
 {
     calculateRates();
 }
@@ -24,15 +34,30 @@ EnvelopeGenerator::~EnvelopeGenerator()
 }
 
 //==============================================================================
-void EnvelopeGenerator::prepareToPlay(double newSampleRate, int /*samplesPerBlock*/)
+void EnvelopeGenerator::prepareToPlay(double newSampleRate, int samplesPerBlock)
 {
     sampleRate = newSampleRate;
+    gainBuffer.setSize(1, juce::jmax(1, samplesPerBlock));
     calculateRates();
     reset();
 }
 
+void EnvelopeGenerator::setSampleRate(double newSampleRate)
+{
+    sampleRate = newSampleRate;
+    calculateRates();
+    
+    if (currentStage == Attack || currentStage == Decay || currentStage == Release)
+        enterStage(currentStage);
+}
+
 void EnvelopeGenerator::processBlock(juce::AudioBuffer<float>& buffer, int numSamples)
 {
+    // New times apply to the segment already running, from where it is
+    if (retimePending.exchange(false)
+        && (currentStage == Attack || currentStage == Decay || currentStage == Release))
+        enterStage(currentStage);
+    
     // If envelope is not active, zero the buffer and return
     if (currentStage == Idle && !noteIsOn)
     {
@@ -45,62 +70,28 @@ void EnvelopeGenerator::processBlock(juce::AudioBuffer<float>& buffer, int numSa
         return;
     }
     
-    // Process the envelope for each sample
-    for (int sample = 0; sample < numSamples; ++sample)
+    // The gain buffer holds one prepared block, so split larger ones
+    const int maxChunk = gainBuffer.getNumSamples();
+    if (maxChunk == 0)
+        return;
+    
+    float* gain = gainBuffer.getWritePointer(0);
+    
+    for (int offset = 0; offset < numSamples; offset += maxChunk)
     {
-        // Update envelope level based on current stage
-        switch (currentStage)
+        const int chunk = juce::jmin(maxChunk, numSamples - offset);
+        float constantGain = 0.0f;
+        
+        if (renderGain(gain, chunk, constantGain))
         {
-            case Attack:
-                currentLevel += attackRate;
-                if (currentLevel >= 1.0f)
-                {
-                    currentLevel = 1.0f;
-                    currentStage = Decay;
-                }
-                break;
-                
-            case Decay:
-                currentLevel -= decayRate;
-                if (currentLevel <= sustainLevel)
-                {
-                    currentLevel = sustainLevel;
-                    currentStage = Sustain;
-                    
-                    // For one-shot mode, immediately transition to release
-                    if (oneShot)
-                        currentStage = Release;
-                }
-                break;
-                
-            case Sustain:
-                // Level stays constant at sustainLevel
-                // If note is released, transition to release stage
-                if (!noteIsOn)
-                    currentStage = Release;
-                break;
-                
-            case Release:
-                currentLevel -= releaseRate;
-                if (currentLevel <= 0.0f)
-                {
-                    currentLevel = 0.0f;
-                    currentStage = Idle;
-                    noteIsOn = false;  // Ensure note is marked as off when envelope completes
-                    DBG("Envelope: Completed cycle, now in Idle state");
-                }
-                break;
-                
-            case Idle:
-                // Do nothing
-                break;
+            // Sustain, or silence: one gain for the whole chunk
+            for (int channel = 0; channel < buffer.getNumChannels(); ++channel)
+                juce::FloatVectorOperations::multiply(buffer.getWritePointer(channel, offset), constantGain, chunk);
         }
-        
-        // Apply envelope to all channels
-        for (int channel = 0; channel < buffer.getNumChannels(); ++channel)
+        else
         {
-            float* channelData = buffer.getWritePointer(channel);
-            channelData[sample] *= currentLevel * currentVelocity;
+            for (int channel = 0; channel < buffer.getNumChannels(); ++channel)
+                juce::FloatVectorOperations::multiply(buffer.getWritePointer(channel, offset), gain, chunk);
         }
     }
 }
@@ -120,7 +111,7 @@ void EnvelopeGenerator::noteOn(int /*midiNoteNumber*/, float velocity)
     noteIsOn = true;
     
     // Start the attack phase
-    currentStage = Attack;
+    enterStage(Attack);
 }
 
 void EnvelopeGenerator::noteOff(int /*midiNoteNumber*/)
@@ -130,7 +121,7 @@ void EnvelopeGenerator::noteOff(int /*midiNoteNumber*/)
     // If we're in a sustain stage, move to release
     if (currentStage == Sustain)
     {
-        currentStage = Release;
+        enterStage(Release);
     }
 }
 
@@ -144,6 +135,7 @@ void EnvelopeGenerator::setParameters(float newAttackTimeMs, float newDecayTimeM
     releaseTime = newReleaseTimeMs;
     
     calculateRates();
+    retimePending = true;
 }
 
 float EnvelopeGenerator::getAttackTime() const
@@ -166,6 +158,29 @@ float EnvelopeGenerator::getReleaseTime() const
     return releaseTime;
 }
 
+void EnvelopeGenerator::setCurves(float newAttackCurve, float newDecayCurve, float newReleaseCurve)
+{
+    // Takes effect from the next segment
+    attackCurve = juce::jlimit(-1.0f, 1.0f, newAttackCurve);
+    decayCurve = juce::jlimit(-1.0f, 1.0f, newDecayCurve);
+    releaseCurve = juce::jlimit(-1.0f, 1.0f, newReleaseCurve);
+}
+
+float EnvelopeGenerator::getAttackCurve() const
+{
+    return attackCurve;
+}
+
+float EnvelopeGenerator::getDecayCurve() const
+{
+    return decayCurve;
+}
+
+float EnvelopeGenerator::getReleaseCurve() const
+{
+    return releaseCurve;
+}
+
 //==============================================================================
 void EnvelopeGenerator::setOneShot(bool isOneShot)
 {
@@ -200,4 +215,168 @@ void EnvelopeGenerator::calculateRates()
     
     // For release, go from current level to 0 in releaseTime
     releaseRate = 1.0f / (releaseTime * 0.001f * static_cast<float>(sampleRate));
-}
\ No newline at end of file
+}
+
+//==============================================================================
+bool EnvelopeGenerator::renderGain(float* gain, int numSamples, float& constantGain)
+{
+    // A block spent entirely in Sustain (or Idle) is one constant level
+    if ((currentStage == Sustain && noteIsOn) || currentStage == Idle)
+    {
+        constantGain = currentLevel * currentVelocity;
+        return true;
+    }
+    
+    int position = 0;
+    
+    while (position < numSamples)
+    {
+        const int remaining = numSamples - position;
+        
+        switch (currentStage)
+        {
+            case Attack:
+            case Decay:
+            case Release:
+            {
+                const int run = juce::jmin(remaining, segmentSamplesRemaining);
+                
+                renderSegment(gain + position, run);
+                position += run;
+                segmentSamplesRemaining -= run;
+                
+                if (segmentSamplesRemaining > 0)
+                    break;
+                
+                // Land exactly on the end of the segment
+                gain[position - 1] = segmentEndLevel;
+                currentLevel = segmentEndLevel;
+                
+                if (currentStage == Attack)
+                {
+                    enterStage(Decay);
+                }
+                else if (currentStage == Decay)
+                {
+                    // For one-shot mode, go straight on to release
+                    enterStage(oneShot ? Release : Sustain);
+                }
+                else
+                {
+                    enterStage(Idle);
+                    noteIsOn = false;  // Ensure note is marked as off when envelope completes
+                    DBG("Envelope: Completed cycle, now in Idle state");
+                }
+                break;
+            }
+                
+            case Sustain:
+                // Level stays at sustainLevel until the note is released
+                if (!noteIsOn)
+                {
+                    enterStage(Release);
+                    break;
+                }
+                
+                juce::FloatVectorOperations::fill(gain + position, currentLevel, remaining);
+                position += remaining;
+                break;
+                
+            case Idle:
+                juce::FloatVectorOperations::clear(gain + position, remaining);
+                position += remaining;
+                break;
+        }
+    }
+    
+    juce::FloatVectorOperations::multiply(gain, currentVelocity, numSamples);
+    return false;
+}
+
+void EnvelopeGenerator::enterStage(EnvelopeStage newStage)
+{
+    currentStage = newStage;
+    
+    switch (newStage)
+    {
+        case Attack:  beginSegment(1.0f, attackRate, attackCurve); break;
+        case Decay:   beginSegment(sustainLevel, decayRate, decayCurve); break;
+        case Release: beginSegment(0.0f, releaseRate, releaseCurve); break;
+        case Sustain:
+        case Idle:    segmentSamplesRemaining = 0; break;
+    }
+}
+
+void EnvelopeGenerator::beginSegment(float endLevel, float rate, float curve)
+{
+    const float distance = endLevel - currentLevel;
+    
+    // The segment lasts as long as the linear ramp would at this rate
+    segmentSamplesRemaining = rate > 0.0f
+        ? juce::jmax(1, static_cast<int>(std::ceil(std::abs(distance) / rate)))
+        : 1;
+    segmentEndLevel = endLevel;
+    
+    const float numSamples = static_cast<float>(segmentSamplesRemaining);
+    segmentIsCurved = std::abs(curve) >= 0.01f && std::abs(distance) > 1.0e-6f;
+    
+    if (!segmentIsCurved)
+    {
+        segmentStep = distance / numSamples;
+        return;
+    }
+    
+    // The target overshoots the end by a fraction of the distance: the
+    // smaller the overshoot, the stronger the curve. Positive curves
+    // approach a target past the end; negative ones start by moving away
+    // from a target behind the start, so the motion speeds up instead.
+    const float overshoot = 1.0f / (std::exp(8.0f * std::abs(curve)) - 1.0f);
+    
+    segmentTarget = curve > 0.0f ? endLevel + distance * overshoot
+                                 : currentLevel - distance * overshoot;
+    
+    // One pow per segment, so the distance to the target scales from the
+    // start to the end in exactly numSamples steps
+    segmentMultiplier = std::pow((endLevel - segmentTarget) / (currentLevel - segmentTarget), 1.0f / numSamples);
+}
+
+void EnvelopeGenerator::renderSegment(float* gain, int numSamples)
+{
+    if (numSamples <= 0)
+        return;
+    
+    if (!segmentIsCurved)
+    {
+        const float startLevel = currentLevel;
+        
+        // Computed from the start rather than accumulated, so it vectorizes
+        for (int i = 0; i < numSamples; ++i)
+            gain[i] = startLevel + segmentStep * static_cast<float>(i + 1);
+    }
+    else
+    {
+        // Four lanes, each a multiply and an add per sample, stepping by the
+        // fourth power of the multiplier
+        const float m = segmentMultiplier;
+        const float m4 = m * m * m * m;
+        const float target = segmentTarget;
+        const float distance = currentLevel - target;
+        
+        alignas(16) float lanes[4] = { distance * m, distance * m * m, distance * m * m * m, distance * m4 };
+        
+        int i = 0;
+        for (; i + 4 <= numSamples; i += 4)
+        {
+            for (int lane = 0; lane < 4; ++lane)
+            {
+                gain[i + lane] = target + lanes[lane];
+                lanes[lane] *= m4;
+            }
+        }
+        
+        for (int lane = 0; i + lane < numSamples; ++lane)
+            gain[i + lane] = target + lanes[lane];
+    }
+    
+    currentLevel = gain[numSamples - 1];
+}
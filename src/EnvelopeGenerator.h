@@ -1,10 +1,22 @@
 #pragma once
 
 #include <JuceHeader.h>
+#include <atomic>
 
 //==============================================================================
 /**
  * ADSR Envelope generator for the noise generator.
+ *
+ * Rather than switching on the stage every sample, processBlock works out
+ * how many samples are left in the current stage and renders that whole
+ * run into a gain buffer at once, then applies the buffer to every channel
+ * in one multiply pass. A block that stays in Sustain is a single constant
+ * gain.
+ *
+ * Each segment can be curved. A curved segment is an exponential approach
+ * toward a target just beyond its end level, run as a recurrence (one
+ * multiply and one add per sample) and computed in four lanes so it still
+ * vectorizes. Segments land exactly on their end level.
  */
 class EnvelopeGenerator
 {
@@ -15,6 +27,11 @@ public:
 
     //==============================================================================
     void prepareToPlay(double sampleRate, int samplesPerBlock);
+    
+    // Changes the rate it's run at without resetting. A running segment
+    // carries on from the current level at the new rate.
+    void setSampleRate(double sampleRate);
+    
     void processBlock(juce::AudioBuffer<float>& buffer, int numSamples);
     void reset();
 
@@ -23,6 +40,9 @@ public:
     void noteOff(int midiNoteNumber);
     
     //==============================================================================
+    // A running attack, decay or release is re-timed from its current level
+    // at the start of the next block, so a shortened release takes effect
+    // straight away.
     void setParameters(float attackTimeMs, float decayTimeMs, float sustainLevel, float releaseTimeMs);
     
     float getAttackTime() const;
@@ -30,6 +50,14 @@ public:
     float getSustainLevel() const;
     float getReleaseTime() const;
     
+    // -1 to 1 per segment: 0 is linear, positive is exponential (fast, then
+    // settling), negative is the reverse (slow, then rushing to the end)
+    void setCurves(float attackCurve, float decayCurve, float releaseCurve);
+    
+    float getAttackCurve() const;
+    float getDecayCurve() const;
+    float getReleaseCurve() const;
+    
     //==============================================================================
     void setOneShot(bool isOneShot);
     bool isOneShot() const;
@@ -57,6 +85,10 @@ private:
     float sustainLevel; // 0 to 1
     float releaseTime; // ms
     
+    float attackCurve;  // -1 to 1
+    float decayCurve;   // -1 to 1
+    float releaseCurve; // -1 to 1
+    
     EnvelopeStage currentStage;
     float currentLevel;
     float currentVelocity;
@@ -68,6 +100,32 @@ private:
     bool oneShot;
     bool noteIsOn;
     
+    // The segment being rendered. Curved segments follow
+    // level = target + (level - target) * multiplier each sample.
+    int segmentSamplesRemaining;
+    float segmentEndLevel;
+    bool segmentIsCurved;
+    float segmentStep;        // linear change per sample
+    float segmentTarget;      // curved: the level approached
+    float segmentMultiplier;  // curved: per-sample ratio of the distance to target
+    
+    // Set by setParameters, picked up by the audio thread
+    std::atomic<bool> retimePending;
+    
     //==============================================================================
     void calculateRates();
+    
+    // Renders the envelope times velocity into gain. Returns true if the
+    // whole run was one constant level, left in constantGain.
+    bool renderGain(float* gain, int numSamples, float& constantGain);
+    
+    // Switches stage and sets up the segment from the current level
+    void enterStage(EnvelopeStage newStage);
+    void beginSegment(float endLevel, float rate, float curve);
+    
+    // Fills the next numSamples of the current segment
+    void renderSegment(float* gain, int numSamples);
+    
+    //==============================================================================
+    juce::AudioBuffer<float> gainBuffer;
 };
\ No newline at end of file
@@ -0,0 +1,240 @@
+#include "FDNReverb.h"
+
+//==============================================================================
+namespace
+{
+    // Line lengths at full size, in ms. Mutually prime-ish so the echoes of
+    // the different lines don't line up.
+    constexpr float baseDelayMs[FDNReverb::numLines] = { 29.7f, 37.1f, 41.1f, 43.7f, 53.3f, 59.3f, 67.9f, 73.1f };
+
+    constexpr float minSizeScale = 0.2f;
+    constexpr float maxDelayMs = 73.1f;
+}
+
+//==============================================================================
+FDNReverb::FDNReverb()
+    : sampleRate(44100.0)
+    , mix(0.0f)        // Default: 0% (off)
+    , decay(2.0f)      // Default: 2 seconds
+    , damping(0.5f)
+    , size(0.5f)
+    , delayMask(0)
+    , writePosition(0)
+    , dampingCoefficient(0.0f)
+    , ringOutRemaining(0)
+{
+    for (int line = 0; line < numLines; ++line)
+    {
+        currentDelay[line] = targetDelay[line] = 1.0f;
+        feedbackGain[line] = 0.0f;
+        inputGain[line] = 0.0f;
+        dampingState[line] = 0.0f;
+    }
+}
+
+FDNReverb::~FDNReverb()
+{
+}
+
+//==============================================================================
+void FDNReverb::prepareToPlay(double newSampleRate, int /*samplesPerBlock*/)
+{
+    sampleRate = newSampleRate;
+
+    // Room for the longest line at full size, plus the interpolation sample
+    const int maxDelaySamples = static_cast<int>(std::ceil(maxDelayMs * 0.001 * sampleRate)) + 2;
+    const int numFrames = juce::nextPowerOfTwo(maxDelaySamples);
+
+    delayBuffer.assign(static_cast<size_t>(numFrames * numLines), 0.0f);
+    delayMask = numFrames - 1;
+
+    updateParameters();
+
+    for (int line = 0; line < numLines; ++line)
+        currentDelay[line] = targetDelay[line];
+
+    reset();
+}
+
+void FDNReverb::processBlock(juce::AudioBuffer<float>& buffer, int numSamples)
+{
+    if (delayBuffer.empty() || numSamples <= 0)
+        return;
+
+    // At zero mix the lines keep running on silence until the tail has
+    // rung out, as the convolution reverb does, so raising the mix later
+    // doesn't replay a frozen tail. The buffer is left untouched meanwhile.
+    const bool ringingOut = mix <= 0.0f;
+
+    if (ringingOut && ringOutRemaining <= 0)
+        return;
+
+    updateParameters();
+
+    // Two decay times take the tail 120 dB down
+    if (ringingOut)
+        ringOutRemaining -= numSamples;
+    else
+        ringOutRemaining = static_cast<int>((2.0 * decay + maxDelayMs * 0.001) * sampleRate);
+
+    const int numChannels = juce::jmin(buffer.getNumChannels(), 2);
+    float* left = buffer.getWritePointer(0);
+    float* right = numChannels > 1 ? buffer.getWritePointer(1) : nullptr;
+
+    const float inputScale = ringingOut ? 0.0f : 1.0f;
+    const float dryGain = 1.0f - mix;
+    const float wetGain = mix;
+    const float outputScale = 0.75f;  // four lines per channel, wet level close to dry
+    const float hadamardScale = 0.35355339059327373f;   // 1 / sqrt(8)
+
+    alignas(32) float delayIncrement[numLines];
+    for (int line = 0; line < numLines; ++line)
+        delayIncrement[line] = (targetDelay[line] - currentDelay[line]) / static_cast<float>(numSamples);
+
+    float* lines = delayBuffer.data();
+
+    for (int i = 0; i < numSamples; ++i)
+    {
+        const float inLeft = left[i] * inputScale;
+        const float inRight = right != nullptr ? right[i] * inputScale : inLeft;
+
+        alignas(32) float lineOutput[numLines];
+        alignas(32) float feedback[numLines];
+
+        // Fractional reads, linearly interpolated
+        for (int line = 0; line < numLines; ++line)
+        {
+            currentDelay[line] += delayIncrement[line];
+
+            const float readPosition = static_cast<float>(writePosition) - currentDelay[line];
+            const float readFloor = std::floor(readPosition);
+            const float fraction = readPosition - readFloor;
+            const int index = static_cast<int>(readFloor) & delayMask;
+
+            const float a = lines[index * numLines + line];
+            const float b = lines[((index + 1) & delayMask) * numLines + line];
+            lineOutput[line] = a + fraction * (b - a);
+        }
+
+        // Damping and decay
+        for (int line = 0; line < numLines; ++line)
+        {
+            dampingState[line] = lineOutput[line] + dampingCoefficient * (dampingState[line] - lineOutput[line]);
+            feedback[line] = dampingState[line] * feedbackGain[line];
+        }
+
+        // Hadamard mix as three butterfly stages
+        for (int span = 1; span < numLines; span <<= 1)
+        {
+            for (int start = 0; start < numLines; start += 2 * span)
+            {
+                for (int line = start; line < start + span; ++line)
+                {
+                    const float a = feedback[line];
+                    const float b = feedback[line + span];
+                    feedback[line] = a + b;
+                    feedback[line + span] = a - b;
+                }
+            }
+        }
+
+        // Left feeds the even lines and right the odd ones
+        float* frame = lines + writePosition * numLines;
+        for (int line = 0; line < numLines; ++line)
+            frame[line] = feedback[line] * hadamardScale + ((line & 1) == 0 ? inLeft : inRight) * inputGain[line];
+
+        float wetLeft = 0.0f;
+        float wetRight = 0.0f;
+        for (int line = 0; line < numLines; line += 2)
+        {
+            wetLeft += lineOutput[line];
+            wetRight += lineOutput[line + 1];
+        }
+
+        if (!ringingOut)
+        {
+            left[i] = inLeft * dryGain + wetLeft * outputScale * wetGain;
+            if (right != nullptr)
+                right[i] = inRight * dryGain + wetRight * outputScale * wetGain;
+        }
+
+        writePosition = (writePosition + 1) & delayMask;
+    }
+
+    for (int line = 0; line < numLines; ++line)
+        currentDelay[line] = targetDelay[line];
+}
+
+void FDNReverb::reset()
+{
+    std::fill(delayBuffer.begin(), delayBuffer.end(), 0.0f);
+    writePosition = 0;
+
+    for (int line = 0; line < numLines; ++line)
+        dampingState[line] = 0.0f;
+
+    ringOutRemaining = 0;
+}
+
+//==============================================================================
+void FDNReverb::setMix(float newMix)
+{
+    mix = juce::jlimit(0.0f, 1.0f, newMix);
+}
+
+void FDNReverb::setDecay(float seconds)
+{
+    decay = juce::jlimit(0.1f, 10.0f, seconds);
+}
+
+void FDNReverb::setDamping(float newDamping)
+{
+    damping = juce::jlimit(0.0f, 1.0f, newDamping);
+}
+
+void FDNReverb::setSize(float newSize)
+{
+    size = juce::jlimit(0.0f, 1.0f, newSize);
+}
+
+float FDNReverb::getMix() const
+{
+    return mix;
+}
+
+float FDNReverb::getDecay() const
+{
+    return decay;
+}
+
+float FDNReverb::getDamping() const
+{
+    return damping;
+}
+
+float FDNReverb::getSize() const
+{
+    return size;
+}
+
+//==============================================================================
+void FDNReverb::updateParameters()
+{
+    const float sizeScale = minSizeScale + (1.0f - minSizeScale) * size;
+
+    for (int line = 0; line < numLines; ++line)
+    {
+        targetDelay[line] = baseDelayMs[line] * sizeScale * 0.001f * static_cast<float>(sampleRate);
+
+        // Gain for -60 dB after the decay time, given this line's round trip
+        const float gain = std::pow(10.0f, -3.0f * targetDelay[line] / (decay * static_cast<float>(sampleRate)));
+        feedbackGain[line] = gain;
+
+        // Scaling the input by sqrt(1 - g^2) keeps the steady-state wet level
+        // roughly independent of the decay time
+        inputGain[line] = std::sqrt(1.0f - gain * gain);
+    }
+
+    // Damping as a one-pole lowpass in each line's feedback path
+    dampingCoefficient = 0.9f * damping;
+}
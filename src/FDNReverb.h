@@ -0,0 +1,75 @@
+#pragma once
+
+#include <JuceHeader.h>
+#include <vector>
+
+//==============================================================================
+/**
+ * Feedback delay network reverb, the cheap alternative to the convolution
+ * reverb.
+ *
+ * Eight delay lines share one power-of-two ring, interleaved so that every
+ * line writes the same frame and reads are masked rather than wrapped. Each
+ * sample runs short scalar loops over the eight lines: a one-pole damping
+ * filter and a decay gain per line, then an 8x8 Hadamard mix (three
+ * butterfly stages). The per-sample cost is fixed, and memory is only
+ * allocated in prepareToPlay.
+ *
+ * At zero mix the network keeps running on silence until its tail has
+ * decayed, then stops, so raising the mix again starts from silence.
+ */
+class FDNReverb
+{
+public:
+    //==============================================================================
+    static constexpr int numLines = 8;
+
+    //==============================================================================
+    FDNReverb();
+    ~FDNReverb();
+
+    //==============================================================================
+    void prepareToPlay(double sampleRate, int samplesPerBlock);
+    void processBlock(juce::AudioBuffer<float>& buffer, int numSamples);
+    void reset();
+
+    //==============================================================================
+    void setMix(float mix);
+    void setDecay(float seconds);
+    void setDamping(float damping);
+    void setSize(float size);
+
+    float getMix() const;
+    float getDecay() const;
+    float getDamping() const;
+    float getSize() const;
+
+private:
+    //==============================================================================
+    // Recalculates delay targets, gains and the damping coefficient
+    void updateParameters();
+
+    //==============================================================================
+    double sampleRate;
+
+    float mix;       // 0 to 1
+    float decay;     // seconds to -60 dB
+    float damping;   // 0 to 1, high-frequency loss in the feedback path
+    float size;      // 0 to 1, scales the delay lengths
+
+    // Interleaved delay lines: sample n of line i is at n * numLines + i
+    std::vector<float> delayBuffer;
+    int delayMask;
+    int writePosition;
+
+    // Per-line state. Delays are fractional and glide to their targets over
+    // one block, so size changes don't click.
+    alignas(32) float currentDelay[numLines];
+    alignas(32) float targetDelay[numLines];
+    alignas(32) float feedbackGain[numLines];
+    alignas(32) float inputGain[numLines];
+    alignas(32) float dampingState[numLines];
+    float dampingCoefficient;
+
+    int ringOutRemaining;   // samples of silence still to run at zero mix
+};
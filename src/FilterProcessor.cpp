@@ -6,11 +6,17 @@ FilterProcessor::FilterProcessor()
     , currentFilterType(LowPass)
     , cutoffFrequency(1000.0f)  // Default: 1000 Hz
     , resonance(0.5f)           // Default: 0.5
-    , modulationAmount(0.0f)
+    , modulationAmount(0.5f)    // Default: +/-5 octaves at full modulation
+    , cutoffModulation(0.0f)
+    , resonanceModulation(0.0f)
     , modulatedCutoff(1000.0f)
     , modulatedResonance(0.5f)
+    , coefficientsNeedUpdate(true)
+    , a0(0.0f), a1(0.0f), a2(0.0f), b1(0.0f), b2(0.0f)
+    , bandPassGain(0.0f)
 {
     reset();
+    updateFilter();
 }
 
 FilterProcessor::~FilterProcessor()
@@ -27,6 +33,9 @@ void FilterProcessor::prepareToPlay(double newSampleRate, int /*samplesPerBlock*
 
 void FilterProcessor::processBlock(juce::AudioBuffer<float>& buffer, int numSamples)
 {
+    if (coefficientsNeedUpdate)
+        updateFilter();
+    
     for (int channel = 0; channel < buffer.getNumChannels(); ++channel)
     {
         float* channelData = buffer.getWritePointer(channel);
@@ -57,14 +66,13 @@ void FilterProcessor::setFilterType(FilterType type)
 void FilterProcessor::setCutoffFrequency(float frequency)
 {
     cutoffFrequency = juce::jlimit(20.0f, 20000.0f, frequency);
-    updateFilter();
+    coefficientsNeedUpdate = true;
 }
 
 void FilterProcessor::setResonance(float newResonance)
 {
     resonance = juce::jlimit(0.0f, 1.0f, newResonance);
-    modulatedResonance = resonance; // Update modulated value too
-    updateFilter();
+    coefficientsNeedUpdate = true;
 }
 
 FilterProcessor::FilterType FilterProcessor::getFilterType() const
@@ -86,6 +94,7 @@ float FilterProcessor::getResonance() const
 void FilterProcessor::setModulationAmount(float amount)
 {
     modulationAmount = amount;
+    coefficientsNeedUpdate = true;
 }
 
 float FilterProcessor::getModulationAmount() const
@@ -96,61 +105,67 @@ float FilterProcessor::getModulationAmount() const
 //==============================================================================
 void FilterProcessor::applyModulation(float modulationValue)
 {
+    if (modulationValue != cutoffModulation)
+    {
+        cutoffModulation = modulationValue;
+        coefficientsNeedUpdate = true;
+    }
+}
+
+void FilterProcessor::applyResonanceModulation(float modulationValue)
+{
+    if (modulationValue != resonanceModulation)
+    {
+        resonanceModulation = modulationValue;
+        coefficientsNeedUpdate = true;
+    }
+}
+
+//==============================================================================
+void FilterProcessor::updateFilter()
+{
+    coefficientsNeedUpdate = false;
+    
     // Map the modulation value (-1 to 1) to a frequency multiplier
     // With modulationAmount = 1, the range will be cutoff/10 to cutoff*10
     // This gives a 10 octave modulation range at max depth
-    
     const float modulationDepth = juce::jlimit(0.0f, 1.0f, std::abs(modulationAmount));
     const float octaveRange = 10.0f * modulationDepth;
     
-    float multiplier = std::pow(2.0f, modulationValue * octaveRange);
+    float multiplier = std::pow(2.0f, cutoffModulation * octaveRange);
     
     // Invert the multiplier if modulationAmount is negative
     if (modulationAmount < 0.0f)
         multiplier = 1.0f / multiplier;
     
-    // Apply the modulation to the cutoff frequency
-    modulatedCutoff = cutoffFrequency * multiplier;
-    modulatedCutoff = juce::jlimit(20.0f, 20000.0f, modulatedCutoff);
+    modulatedCutoff = juce::jlimit(20.0f, 20000.0f, cutoffFrequency * multiplier);
     
-    updateFilter();
-}
-
-void FilterProcessor::applyResonanceModulation(float modulationValue)
-{
-    // Apply modulation to resonance (±50% range)
-    float modulationRange = 0.5f;
-    modulatedResonance = resonance * (1.0f + modulationValue * modulationRange);
-    modulatedResonance = juce::jlimit(0.01f, 1.0f, modulatedResonance);
-}
-
-//==============================================================================
-void FilterProcessor::updateFilter()
-{
-    // Nothing to update here, as the state variable filter
-    // calculates coefficients per-sample in processSample
-}
-
-void FilterProcessor::processSample(float& sample, int channel)
-{
-    // State Variable Filter implementation
-    // Based on the equations from the "Cookbook formulae for audio EQ biquad filter coefficients"
-    // by Robert Bristow-Johnson
+    // Resonance modulation has a +/-50% range
+    const float resonanceRange = 0.5f;
+    modulatedResonance = resonanceModulation == 0.0f
+        ? resonance
+        : juce::jlimit(0.01f, 1.0f, resonance * (1.0f + resonanceModulation * resonanceRange));
+    
+    // Biquad coefficients from the "Cookbook formulae for audio EQ biquad
+    // filter coefficients" by Robert Bristow-Johnson
     
     // Convert cutoff from Hz to normalized frequency (0 to Nyquist)
     float f = modulatedCutoff / static_cast<float>(sampleRate);
     f = juce::jlimit(0.001f, 0.499f, f); // Limit to avoid instability
     
-    // Calculate filter coefficients
-    float k = std::tan(juce::MathConstants<float>::pi * f);
-    float safeResonance = juce::jmax(0.1f, modulatedResonance); // Prevent instability
-    float norm = 1.0f / (1.0f + k / safeResonance + k * k);
-    float a0 = k * k * norm;
-    float a1 = 2.0f * a0;
-    float a2 = a0;
-    float b1 = 2.0f * (k * k - 1.0f) * norm;
-    float b2 = (1.0f - k / safeResonance + k * k) * norm;
-    
+    const float k = std::tan(juce::MathConstants<float>::pi * f);
+    const float safeResonance = juce::jmax(0.1f, modulatedResonance); // Prevent instability
+    const float norm = 1.0f / (1.0f + k / safeResonance + k * k);
+    a0 = k * k * norm;
+    a1 = 2.0f * a0;
+    a2 = a0;
+    b1 = 2.0f * (k * k - 1.0f) * norm;
+    b2 = (1.0f - k / safeResonance + k * k) * norm;
+    bandPassGain = k / safeResonance;
+}
+
+void FilterProcessor::processSample(float& sample, int channel)
+{
     // Apply the filter (direct form II transposed)
     float input = sample;
     float output = a0 * input + svf.z1[channel];
@@ -166,7 +181,7 @@ void FilterProcessor::processSample(float& sample, int channel)
         
         case BandPass:
             // Derive band-pass from the state variable filter
-            sample = k / safeResonance * input - k / safeResonance * output;
+            sample = bandPassGain * input - bandPassGain * output;
             break;
         
         case HighPass:
@@ -5,6 +5,11 @@
 //==============================================================================
 /**
  * Filter processor for the noise generator.
+ *
+ * Coefficients are only recomputed at the start of a processBlock call, and
+ * only if a setting or the modulation changed since the last one. Modulated
+ * callers split the block at control ticks and apply the modulation before
+ * each part.
  */
 class FilterProcessor
 {
@@ -41,6 +46,7 @@ public:
     float getModulationAmount() const;
     
     //==============================================================================
+    // -1 to 1, applied from the next processBlock call
     void applyModulation(float modulationValue);
     void applyResonanceModulation(float modulationValue);
 
@@ -53,8 +59,15 @@ private:
     float resonance;
     
     float modulationAmount;
+    float cutoffModulation;
+    float resonanceModulation;
     float modulatedCutoff;
     float modulatedResonance;
+    bool coefficientsNeedUpdate;
+    
+    // Coefficients for the modulated cutoff and resonance
+    float a0, a1, a2, b1, b2;
+    float bandPassGain;
     
     // State variable filter implementation
     struct SVFilter
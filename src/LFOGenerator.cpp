@@ -1,17 +1,53 @@
 #include "LFOGenerator.h"
 
+//==============================================================================
+namespace
+{
+    // One cycle of sine, with a guard point for interpolation
+    struct SineTable
+    {
+        static constexpr int size = 256;
+        float values[size + 1];
+
+        SineTable()
+        {
+            for (int i = 0; i <= size; ++i)
+                values[i] = std::sin(juce::MathConstants<float>::twoPi * static_cast<float>(i) / size);
+        }
+    };
+
+    const SineTable& getSineTable()
+    {
+        static const SineTable table;
+        return table;
+    }
+    
+    // Beyond this many cycles off the host, the transport has moved and the
+    // phase jumps instead of slewing
+    constexpr double maxSlewError = 1.0 / 16.0;
+}
+
 //==============================================================================
 LFOGenerator::LFOGenerator()
     : sampleRate(44100.0)
     , rate(1.0f)        // Default: 1 Hz
     , depth(0.5f)       // Default: 50%
     , target(Volume)    // Default: Volume
+    , shape(Sine)       // Default: Sine
     , syncToHost(false) // Default: not synced
+    , syncDivision(Quarter)
     , hostBPM(120.0)    // Default: 120 BPM
     , hostPPQPosition(0.0)
+    , phaseLockPending(false)
     , phase(0.0f)
     , phaseIncrement(0.0f)
+    , seed(0x1f0)
+    , random(0x1f0)
+    , randomValue(0.0f)
+    , previousRandomValue(0.0f)
 {
+    // Build the table here rather than on the first audio block
+    getSineTable();
     updatePhaseIncrement();
 }
 
@@ -27,23 +63,110 @@ void LFOGenerator::prepareToPlay(double newSampleRate, int /*samplesPerBlock*/)
     reset();
 }
 
-float LFOGenerator::processSample()
+void LFOGenerator::setSampleRate(double newSampleRate)
 {
-    // Move the phase forward
-    phase += phaseIncrement;
-    if (phase >= 1.0f)
-        phase -= 1.0f;
+    sampleRate = newSampleRate;
+    updatePhaseIncrement();
+}
+
+void LFOGenerator::processBlock(float* output, int numSamples)
+{
+    if (numSamples <= 0)
+        return;
+    
+    const float increment = phaseLockPending ? lockPhaseToHost(numSamples) : phaseIncrement;
+    
+    // Each shape starts at zero and rises, as the sine does
+    switch (shape)
+    {
+        case Sine:
+        {
+            const float* table = getSineTable().values;
+            
+            for (int i = 0; i < numSamples; ++i)
+            {
+                phase += increment;
+                if (phase >= 1.0f)
+                    phase -= 1.0f;
+                
+                const float position = phase * SineTable::size;
+                const int index = static_cast<int>(position);
+                const float fraction = position - static_cast<float>(index);
+                output[i] = table[index] + fraction * (table[index + 1] - table[index]);
+            }
+            break;
+        }
+            
+        case Triangle:
+            for (int i = 0; i < numSamples; ++i)
+            {
+                phase += increment;
+                if (phase >= 1.0f)
+                    phase -= 1.0f;
+                
+                float shifted = phase + 0.75f;
+                if (shifted >= 1.0f)
+                    shifted -= 1.0f;
+                
+                output[i] = 4.0f * std::abs(shifted - 0.5f) - 1.0f;
+            }
+            break;
+            
+        case Saw:
+            for (int i = 0; i < numSamples; ++i)
+            {
+                phase += increment;
+                if (phase >= 1.0f)
+                    phase -= 1.0f;
+                
+                float shifted = phase + 0.5f;
+                if (shifted >= 1.0f)
+                    shifted -= 1.0f;
+                
+                output[i] = 2.0f * shifted - 1.0f;
+            }
+            break;
+            
+        case Square:
+            for (int i = 0; i < numSamples; ++i)
+            {
+                phase += increment;
+                if (phase >= 1.0f)
+                    phase -= 1.0f;
+                
+                output[i] = phase < 0.5f ? 1.0f : -1.0f;
+            }
+            break;
+            
+        case SampleAndHold:
+        case SmoothRandom:
+            renderRandom(output, numSamples, increment, shape == SmoothRandom);
+            break;
+            
+        case NumShapes:
+        default:
+            juce::FloatVectorOperations::clear(output, numSamples);
+            break;
+    }
     
-    // Generate a sine wave
-    return depth * std::sin(2.0f * juce::MathConstants<float>::pi * phase);
+    juce::FloatVectorOperations::multiply(output, depth, numSamples);
 }
 
 void LFOGenerator::reset()
 {
     phase = 0.0f;
+    randomValue = 0.0f;
+    previousRandomValue = 0.0f;
+    phaseLockPending = false;
+    random.setSeed(seed);
 }
 
 //==============================================================================
+void LFOGenerator::setSeed(int newSeed)
+{
+    seed = newSeed;
+}
+
 void LFOGenerator::setRate(float rateHz)
 {
     rate = rateHz;
@@ -60,12 +183,23 @@ void LFOGenerator::setTarget(LFOTarget newTarget)
     target = newTarget;
 }
 
+void LFOGenerator::setShape(LFOShape newShape)
+{
+    shape = newShape;
+}
+
 void LFOGenerator::setSyncToHost(bool shouldSync)
 {
     syncToHost = shouldSync;
     updatePhaseIncrement();
 }
 
+void LFOGenerator::setSyncDivision(SyncDivision division)
+{
+    syncDivision = division;
+    updatePhaseIncrement();
+}
+
 float LFOGenerator::getRate() const
 {
     return rate;
@@ -81,11 +215,36 @@ LFOGenerator::LFOTarget LFOGenerator::getTarget() const
     return target;
 }
 
+LFOGenerator::LFOShape LFOGenerator::getShape() const
+{
+    return shape;
+}
+
 bool LFOGenerator::getSyncToHost() const
 {
     return syncToHost;
 }
 
+LFOGenerator::SyncDivision LFOGenerator::getSyncDivision() const
+{
+    return syncDivision;
+}
+
+double LFOGenerator::getBeatsPerCycle(SyncDivision division)
+{
+    const int index = juce::jlimit(0, NumDivisions - 1, static_cast<int>(division));
+    
+    // 1/1 is four quarter notes, and each division halves it
+    const double straight = 4.0 / static_cast<double>(1 << (index / 3));
+    
+    switch (index % 3)
+    {
+        case 1:  return straight * 1.5;         // dotted
+        case 2:  return straight * 2.0 / 3.0;   // triplet
+        default: return straight;
+    }
+}
+
 //==============================================================================
 void LFOGenerator::setHostBPM(double bpm)
 {
@@ -97,13 +256,7 @@ void LFOGenerator::setHostBPM(double bpm)
 void LFOGenerator::setHostPPQPosition(double ppqPosition)
 {
     hostPPQPosition = ppqPosition;
-    
-    // If synced to host, we can use PPQ position to directly set the phase
-    if (syncToHost)
-    {
-        // Normalize the PPQ position to a 0-1 phase
-        phase = std::fmod(static_cast<float>(hostPPQPosition), 1.0f);
-    }
+    phaseLockPending = syncToHost;
 }
 
 //==============================================================================
@@ -111,19 +264,92 @@ void LFOGenerator::updatePhaseIncrement()
 {
     if (syncToHost)
     {
-        // When synced to host, we derive the rate from the BPM
+        // When synced to host, we derive the rate from the BPM and division
         // For example, 1/4 note at 120 BPM = 2 Hz (120 BPM / 60 seconds)
-        float syncedRate = static_cast<float>(hostBPM / 60.0);
-        
-        // Apply a multiplier based on the rate value
-        // rate of 1.0 = quarter notes, 2.0 = eighth notes, 0.5 = half notes, etc.
-        syncedRate *= rate;
+        const double syncedRate = hostBPM / 60.0 / getBeatsPerCycle(syncDivision);
         
-        phaseIncrement = syncedRate / static_cast<float>(sampleRate);
+        phaseIncrement = static_cast<float>(syncedRate / sampleRate);
     }
     else
     {
         // Normal operation: increment phase based on the rate in Hz
         phaseIncrement = rate / static_cast<float>(sampleRate);
     }
-}
\ No newline at end of file
+}
+
+float LFOGenerator::lockPhaseToHost(int numSamples)
+{
+    phaseLockPending = false;
+    
+    // Where the host says the phase is, also before the start of the
+    // timeline, where the position is negative
+    const double cycles = hostPPQPosition / getBeatsPerCycle(syncDivision);
+    const double hostPhase = cycles - std::floor(cycles);
+    
+    // Shortest way round, -0.5 to 0.5 cycles
+    double error = hostPhase - static_cast<double>(phase);
+    error -= std::floor(error + 0.5);
+    
+    if (std::abs(error) > maxSlewError)
+    {
+        phase = static_cast<float>(hostPhase);
+        if (phase >= 1.0f)
+            phase = 0.0f;
+        
+        return phaseIncrement;
+    }
+    
+    // Spread the correction over the block
+    return juce::jmax(0.0f, phaseIncrement + static_cast<float>(error / numSamples));
+}
+
+//==============================================================================
+void LFOGenerator::renderRandom(float* output, int numSamples, float increment, bool smooth)
+{
+    if (increment <= 0.0f)
+    {
+        juce::FloatVectorOperations::fill(output, randomValue, numSamples);
+        return;
+    }
+    
+    int position = 0;
+    
+    while (position < numSamples)
+    {
+        // Up to the sample where the phase wraps
+        const int samplesToWrap = static_cast<int>(std::ceil((1.0f - phase) / increment));
+        const int run = juce::jlimit(1, numSamples - position, samplesToWrap);
+        
+        if (smooth)
+        {
+            // Smoothstep from the last cycle's value to this one's
+            const float distance = randomValue - previousRandomValue;
+            
+            for (int i = position; i < position + run; ++i)
+            {
+                phase += increment;
+                const float t = juce::jmin(phase, 1.0f);
+                output[i] = previousRandomValue + distance * t * t * (3.0f - 2.0f * t);
+            }
+        }
+        else
+        {
+            juce::FloatVectorOperations::fill(output + position, randomValue, run);
+            phase += increment * static_cast<float>(run);
+        }
+        
+        position += run;
+        
+        if (phase >= 1.0f)
+        {
+            phase -= std::floor(phase);
+            nextRandomValue();
+        }
+    }
+}
+
+void LFOGenerator::nextRandomValue()
+{
+    previousRandomValue = randomValue;
+    randomValue = random.nextFloat() * 2.0f - 1.0f;
+}
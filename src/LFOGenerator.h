@@ -5,6 +5,19 @@
 //==============================================================================
 /**
  * Low Frequency Oscillator for modulation.
+ *
+ * processBlock renders a whole block of the LFO into a modulation buffer,
+ * with one loop per shape so the shape isn't switched on per sample. Every
+ * shape is a few operations on the phase: sine reads a small wavetable with
+ * linear interpolation, the geometric shapes are closed-form, and the
+ * random shapes pick a new value each cycle and render the run up to the
+ * next wrap in one go. Each LFO has its own seed, and reset restarts the
+ * random shapes from it, so a render repeats exactly.
+ *
+ * When synced, one cycle lasts a note division at the host tempo. The host
+ * position is given once per block; the phase runs on by itself inside the
+ * block, and any difference from the position is slewed out over the block
+ * rather than jumped to. Only a relocation of the transport jumps.
  */
 class LFOGenerator
 {
@@ -18,6 +31,45 @@ public:
         Pitch,
         NumTargets
     };
+    
+    enum LFOShape
+    {
+        Sine = 0,
+        Triangle,
+        Saw,
+        Square,
+        SampleAndHold,
+        SmoothRandom,
+        NumShapes
+    };
+    
+    // Length of one cycle when synced. Each division comes straight, dotted
+    // and triplet.
+    enum SyncDivision
+    {
+        Whole = 0,
+        WholeDotted,
+        WholeTriplet,
+        Half,
+        HalfDotted,
+        HalfTriplet,
+        Quarter,
+        QuarterDotted,
+        QuarterTriplet,
+        Eighth,
+        EighthDotted,
+        EighthTriplet,
+        Sixteenth,
+        SixteenthDotted,
+        SixteenthTriplet,
+        ThirtySecond,
+        ThirtySecondDotted,
+        ThirtySecondTriplet,
+        SixtyFourth,
+        SixtyFourthDotted,
+        SixtyFourthTriplet,
+        NumDivisions
+    };
 
     //==============================================================================
     LFOGenerator();
@@ -25,22 +77,41 @@ public:
 
     //==============================================================================
     void prepareToPlay(double sampleRate, int samplesPerBlock);
-    float processSample();
+    
+    // Changes the rate it's run at, keeping the phase
+    void setSampleRate(double sampleRate);
+    
+    // Writes numSamples of the LFO, scaled by depth, to output
+    void processBlock(float* output, int numSamples);
     void reset();
 
     //==============================================================================
     void setRate(float rateHz);
     void setDepth(float depth);
     void setTarget(LFOTarget target);
+    void setShape(LFOShape shape);
     void setSyncToHost(bool shouldSync);
+    void setSyncDivision(SyncDivision division);
+    
+    // Seed for the random shapes, taking effect from the next reset. Give
+    // each LFO a different one so they don't move in step.
+    void setSeed(int seed);
     
     float getRate() const;
     float getDepth() const;
     LFOTarget getTarget() const;
+    LFOShape getShape() const;
     bool getSyncToHost() const;
+    SyncDivision getSyncDivision() const;
+    
+    // Quarter notes per cycle
+    static double getBeatsPerCycle(SyncDivision division);
     
     //==============================================================================
     void setHostBPM(double bpm);
+    
+    // The host position at the current phase, i.e. where the next
+    // processBlock starts from. Locks the phase on the next block.
     void setHostPPQPosition(double ppqPosition);
     
 private:
@@ -50,16 +121,32 @@ private:
     float rate; // Hz
     float depth; // 0 to 1
     LFOTarget target;
+    LFOShape shape;
     bool syncToHost;
+    SyncDivision syncDivision;
     
     // Host timing info
     double hostBPM;
     double hostPPQPosition;
+    bool phaseLockPending;
     
     // Internal state
     float phase;
     float phaseIncrement;
     
+    // Random shapes: the value for this cycle and the one before
+    int seed;
+    juce::Random random;
+    float randomValue;
+    float previousRandomValue;
+    
     //==============================================================================
     void updatePhaseIncrement();
+    
+    // The increment for the next block, slewing towards the host position
+    float lockPhaseToHost(int numSamples);
+    
+    // Renders the random shapes, a cycle at a time
+    void renderRandom(float* output, int numSamples, float increment, bool smooth);
+    void nextRandomValue();
 };
\ No newline at end of file
@@ -0,0 +1,99 @@
+#include "ModulationMatrix.h"
+
+//==============================================================================
+ModulationMatrix::ModulationMatrix()
+    : routingChanged(true)
+    , numRoutes(0)
+{
+    for (auto& used : sourceUsed)
+        used = false;
+
+    for (auto& used : destinationUsed)
+        used = false;
+}
+
+ModulationMatrix::~ModulationMatrix()
+{
+}
+
+//==============================================================================
+void ModulationMatrix::setSlot(int slot, int source, Destination destination, float depth)
+{
+    if (slot < 0 || slot >= maxSlots)
+        return;
+
+    slots[slot].source.store(source >= 0 && source < NumSources ? source : -1);
+    slots[slot].destination.store(juce::jlimit(0, NumDestinations - 1, static_cast<int>(destination)));
+    slots[slot].depth.store(juce::jlimit(-1.0f, 1.0f, depth));
+    routingChanged.store(true);
+}
+
+//==============================================================================
+bool ModulationMatrix::applyPendingRouting()
+{
+    if (!routingChanged.exchange(false))
+        return false;
+
+    numRoutes = 0;
+
+    for (auto& used : sourceUsed)
+        used = false;
+
+    for (auto& used : destinationUsed)
+        used = false;
+
+    for (const auto& slot : slots)
+    {
+        const int source = slot.source.load();
+        const float depth = slot.depth.load();
+
+        if (source < 0 || depth == 0.0f)
+            continue;
+
+        Route& route = routes[numRoutes++];
+        route.source = source;
+        route.destination = slot.destination.load();
+        route.depth = depth;
+
+        sourceUsed[route.source] = true;
+        destinationUsed[route.destination] = true;
+    }
+
+    return true;
+}
+
+bool ModulationMatrix::isSourceUsed(Source source) const
+{
+    return sourceUsed[source];
+}
+
+bool ModulationMatrix::isDestinationUsed(Destination destination) const
+{
+    return destinationUsed[destination];
+}
+
+void ModulationMatrix::process(const float* const* sourceValues, float* const* destinationValues, int numValues) const
+{
+    if (numValues <= 0)
+        return;
+
+    for (int destination = 0; destination < NumDestinations; ++destination)
+    {
+        if (destinationUsed[destination])
+            juce::FloatVectorOperations::clear(destinationValues[destination], numValues);
+    }
+
+    for (int index = 0; index < numRoutes; ++index)
+    {
+        const Route& route = routes[index];
+        juce::FloatVectorOperations::addWithMultiply(destinationValues[route.destination], sourceValues[route.source],
+                                                     route.depth, numValues);
+    }
+
+    for (int destination = 0; destination < NumDestinations; ++destination)
+    {
+        if (destinationUsed[destination])
+            juce::FloatVectorOperations::clip(destinationValues[destination], destinationValues[destination],
+                                              -1.0f, 1.0f, numValues);
+    }
+}
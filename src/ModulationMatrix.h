@@ -0,0 +1,87 @@
+#pragma once
+
+#include <JuceHeader.h>
+#include <atomic>
+
+//==============================================================================
+/**
+ * Routes modulation sources to destinations through a fixed set of slots,
+ * each with its own source, destination and depth.
+ *
+ * Slots are set from the message thread. When the routing changes, the
+ * audio thread compiles the slots in use into a flat list of routes, so an
+ * empty slot costs nothing, and sources and destinations with no route can
+ * be skipped altogether. process then builds each destination as a sum of
+ * scaled source buffers, one vectorized pass per route.
+ */
+class ModulationMatrix
+{
+public:
+    //==============================================================================
+    enum Source
+    {
+        Lfo1 = 0,
+        Lfo2,
+        Envelope,
+        MultiStageEnvelope,
+        Sequencer,
+        Random,
+        NumSources
+    };
+
+    enum Destination
+    {
+        Volume = 0,
+        FilterCutoff,
+        FilterResonance,
+        NumDestinations
+    };
+
+    static constexpr int maxSlots = 8;
+
+    //==============================================================================
+    ModulationMatrix();
+    ~ModulationMatrix();
+
+    //==============================================================================
+    // Can be called from any thread. A source of -1 turns the slot off.
+    void setSlot(int slot, int source, Destination destination, float depth);
+
+    //==============================================================================
+    // Compiles the routes if the slots changed since the last call. Returns
+    // true if it did.
+    bool applyPendingRouting();
+
+    bool isSourceUsed(Source source) const;
+    bool isDestinationUsed(Destination destination) const;
+
+    // Fills every destination in use with the sum of its routes, clipped to
+    // -1 to 1. Buffers hold numValues each; unused ones are not touched.
+    void process(const float* const* sourceValues, float* const* destinationValues, int numValues) const;
+
+private:
+    //==============================================================================
+    struct Slot
+    {
+        std::atomic<int> source { -1 };
+        std::atomic<int> destination { 0 };
+        std::atomic<float> depth { 0.0f };
+    };
+
+    struct Route
+    {
+        int source;
+        int destination;
+        float depth;
+    };
+
+    //==============================================================================
+    Slot slots[maxSlots];
+    std::atomic<bool> routingChanged;
+
+    // Owned by the audio thread
+    Route routes[maxSlots];
+    int numRoutes;
+    bool sourceUsed[NumSources];
+    bool destinationUsed[NumDestinations];
+};
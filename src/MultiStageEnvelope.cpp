@@ -0,0 +1,286 @@
+#include "MultiStageEnvelope.h"
+
+//==============================================================================
+MultiStageEnvelope::MultiStageEnvelope()
+    : sampleRate(44100.0)
+    , writeIndex(0)
+    , readIndex(1)
+    , publishedIndex(2)
+    , oneShot(false)
+    , noteIsOn(false)
+    , released(false)
+    , velocity(0.0f)
+    , currentLevel(0.0f)
+    , currentSegment(-1)
+    , segmentPosition(0)
+    , segmentLength(1)
+    , segmentStart(0.0f)
+    , segmentRange(0.0f)
+{
+    // Default: the same shape as the ADSR defaults, with the sustain as a
+    // one-segment loop
+    const Segment defaultSegments[] = {
+        { 1.0f, 10.0f, 0.0f },    // attack
+        { 0.7f, 100.0f, 0.0f },   // decay
+        { 0.7f, 100.0f, 0.0f },   // sustain
+        { 0.0f, 500.0f, 0.0f }    // release
+    };
+
+    setShape(defaultSegments, 4, 2, 2);
+    applyPendingShape();
+}
+
+MultiStageEnvelope::~MultiStageEnvelope()
+{
+}
+
+//==============================================================================
+void MultiStageEnvelope::prepareToPlay(double newSampleRate, int samplesPerBlock)
+{
+    sampleRate = newSampleRate;
+    gainBuffer.setSize(1, juce::jmax(1, samplesPerBlock));
+    reset();
+}
+
+void MultiStageEnvelope::setSampleRate(double newSampleRate)
+{
+    sampleRate = newSampleRate;
+    retimeSegment();
+}
+
+void MultiStageEnvelope::processBlock(juce::AudioBuffer<float>& buffer, int numSamples)
+{
+    applyPendingShape();
+
+    // The gain buffer holds one prepared block, so split larger ones
+    const int maxChunk = gainBuffer.getNumSamples();
+    if (maxChunk == 0)
+        return;
+
+    float* gain = gainBuffer.getWritePointer(0);
+
+    for (int offset = 0; offset < numSamples; offset += maxChunk)
+    {
+        const int chunk = juce::jmin(maxChunk, numSamples - offset);
+        float constantGain = 0.0f;
+
+        if (renderGain(gain, chunk, constantGain))
+        {
+            for (int channel = 0; channel < buffer.getNumChannels(); ++channel)
+                juce::FloatVectorOperations::multiply(buffer.getWritePointer(channel, offset), constantGain, chunk);
+        }
+        else
+        {
+            for (int channel = 0; channel < buffer.getNumChannels(); ++channel)
+                juce::FloatVectorOperations::multiply(buffer.getWritePointer(channel, offset), gain, chunk);
+        }
+    }
+}
+
+void MultiStageEnvelope::reset()
+{
+    currentSegment = -1;
+    currentLevel = 0.0f;
+    noteIsOn = false;
+    released = false;
+}
+
+//==============================================================================
+void MultiStageEnvelope::noteOn(int /*midiNoteNumber*/, float newVelocity)
+{
+    applyPendingShape();
+
+    velocity = newVelocity;
+    noteIsOn = true;
+    released = false;
+
+    // Restart from the current level, so a retrigger doesn't click
+    enterSegment(0);
+}
+
+void MultiStageEnvelope::noteOff(int /*midiNoteNumber*/)
+{
+    noteIsOn = false;
+
+    if (!released && isLooping())
+    {
+        const int afterLoop = shapes[readIndex].loopEnd + 1;
+        if (currentSegment >= shapes[readIndex].loopStart && currentSegment < afterLoop
+            && afterLoop < shapes[readIndex].numSegments)
+            enterSegment(afterLoop);
+    }
+
+    released = true;
+}
+
+//==============================================================================
+void MultiStageEnvelope::setShape(const Segment* segments, int numSegments, int loopStart, int loopEnd)
+{
+    Shape& shape = shapes[writeIndex];
+    shape.numSegments = juce::jlimit(1, maxSegments, numSegments);
+
+    for (int segment = 0; segment < shape.numSegments; ++segment)
+    {
+        const Segment source = segment < numSegments ? segments[segment] : Segment { 0.0f, 1.0f, 0.0f };
+        shape.endLevel[segment] = juce::jlimit(0.0f, 1.0f, source.level);
+        shape.timeMs[segment] = juce::jmax(0.0f, source.timeMs);
+
+        // Normalized curve, matching EnvelopeGenerator's exponential
+        // segments: k = 0 is linear, positive k settles into the end
+        const float curve = juce::jlimit(-1.0f, 1.0f, source.curve);
+        const double k = 8.0 * std::abs(curve);
+        float* table = shape.table[segment];
+
+        for (int point = 0; point <= tableSize; ++point)
+        {
+            const double x = static_cast<double>(point) / tableSize;
+            double value = x;
+
+            if (std::abs(curve) >= 0.01f)
+            {
+                value = curve > 0.0f ? (1.0 - std::exp(-k * x)) / (1.0 - std::exp(-k))
+                                     : (std::exp(k * x) - 1.0) / (std::exp(k) - 1.0);
+            }
+
+            table[point] = static_cast<float>(value);
+        }
+
+        // End points exact, so segments land on their levels
+        table[0] = 0.0f;
+        table[tableSize] = 1.0f;
+    }
+
+    const bool validLoop = loopStart >= 0 && loopStart <= loopEnd && loopEnd < shape.numSegments;
+    shape.loopStart = validLoop ? loopStart : -1;
+    shape.loopEnd = validLoop ? loopEnd : -1;
+
+    // Publish, and take back whichever slot was published before
+    writeIndex = publishedIndex.exchange(writeIndex | newShapeFlag, std::memory_order_acq_rel) & ~newShapeFlag;
+}
+
+void MultiStageEnvelope::setOneShot(bool isOneShot)
+{
+    oneShot = isOneShot;
+}
+
+//==============================================================================
+bool MultiStageEnvelope::isActive() const
+{
+    return currentSegment >= 0;
+}
+
+bool MultiStageEnvelope::isIdle() const
+{
+    return currentSegment < 0;
+}
+
+//==============================================================================
+void MultiStageEnvelope::applyPendingShape()
+{
+    if ((publishedIndex.load(std::memory_order_relaxed) & newShapeFlag) == 0)
+        return;
+
+    readIndex = publishedIndex.exchange(readIndex, std::memory_order_acq_rel) & ~newShapeFlag;
+
+    // Carry on through the running segment with its new settings, so a
+    // stream of edits can't keep restarting it
+    retimeSegment();
+}
+
+void MultiStageEnvelope::retimeSegment()
+{
+    if (currentSegment < 0)
+        return;
+
+    const Shape& shape = shapes[readIndex];
+
+    if (currentSegment >= shape.numSegments)
+    {
+        currentSegment = -1;
+        return;
+    }
+
+    const double elapsed = static_cast<double>(segmentPosition) / static_cast<double>(segmentLength);
+
+    segmentLength = juce::jmax(1, static_cast<int>(std::round(shape.timeMs[currentSegment] * 0.001 * sampleRate)));
+    segmentPosition = juce::jmin(segmentLength, static_cast<int>(std::round(elapsed * segmentLength)));
+    segmentRange = shape.endLevel[currentSegment] - segmentStart;
+}
+
+void MultiStageEnvelope::enterSegment(int segment)
+{
+    const Shape& shape = shapes[readIndex];
+
+    if (segment >= shape.numSegments)
+    {
+        currentSegment = -1;
+        return;
+    }
+
+    currentSegment = segment;
+    segmentPosition = 0;
+    segmentLength = juce::jmax(1, static_cast<int>(std::round(shape.timeMs[segment] * 0.001 * sampleRate)));
+    segmentStart = currentLevel;
+    segmentRange = shape.endLevel[segment] - currentLevel;
+}
+
+bool MultiStageEnvelope::renderGain(float* gain, int numSamples, float& constantGain)
+{
+    if (currentSegment < 0)
+    {
+        constantGain = currentLevel * velocity;
+        return true;
+    }
+
+    const Shape& shape = shapes[readIndex];
+    int position = 0;
+
+    while (position < numSamples)
+    {
+        if (currentSegment < 0)
+        {
+            juce::FloatVectorOperations::fill(gain + position, currentLevel, numSamples - position);
+            break;
+        }
+
+        const int run = juce::jmin(numSamples - position, segmentLength - segmentPosition);
+        const float* table = shape.table[currentSegment];
+        const float scale = static_cast<float>(tableSize) / static_cast<float>(segmentLength);
+
+        // Position from the sample count, so long segments don't drift
+        for (int i = 0; i < run; ++i)
+        {
+            const float tablePosition = static_cast<float>(segmentPosition + i + 1) * scale;
+            const int index = juce::jmin(static_cast<int>(tablePosition), tableSize - 1);
+            const float fraction = tablePosition - static_cast<float>(index);
+            const float value = table[index] + fraction * (table[index + 1] - table[index]);
+
+            gain[position + i] = segmentStart + segmentRange * value;
+        }
+
+        position += run;
+        segmentPosition += run;
+
+        if (segmentPosition < segmentLength)
+            break;
+
+        currentLevel = shape.endLevel[currentSegment];
+
+        if (isLooping() && noteIsOn && currentSegment == shape.loopEnd)
+            enterSegment(shape.loopStart);
+        else
+            enterSegment(currentSegment + 1);
+    }
+
+    // Mid-segment, the level is the last sample rendered
+    if (currentSegment >= 0 && segmentPosition > 0)
+        currentLevel = gain[numSamples - 1];
+
+    juce::FloatVectorOperations::multiply(gain, velocity, numSamples);
+    return false;
+}
+
+bool MultiStageEnvelope::isLooping() const
+{
+    return !oneShot && shapes[readIndex].loopStart >= 0;
+}
@@ -0,0 +1,127 @@
+#pragma once
+
+#include <JuceHeader.h>
+#include <atomic>
+
+//==============================================================================
+/**
+ * Breakpoint (multi-stage) envelope of up to maxSegments segments, each with
+ * its own end level, time and curve, and an optional loop.
+ *
+ * When the shape is edited, setShape bakes each segment's curve into a
+ * small normalized table on the calling thread. The tables are published to
+ * the audio thread through a triple buffer, so neither side allocates,
+ * locks or waits. On the audio thread a segment is only a position that
+ * advances through its table with linear interpolation, so evaluation costs
+ * the same however many segments there are.
+ *
+ * While a note is held, reaching the end of the loop's last segment jumps
+ * back to its first. Releasing the note leaves the loop for the segment
+ * after it, starting from the current level. After the last segment the
+ * envelope idles at the final level.
+ */
+class MultiStageEnvelope
+{
+public:
+    //==============================================================================
+    static constexpr int maxSegments = 32;
+
+    struct Segment
+    {
+        float level;    // 0 to 1, reached at the end of the segment
+        float timeMs;
+        float curve;    // -1 to 1, as in EnvelopeGenerator
+    };
+
+    //==============================================================================
+    MultiStageEnvelope();
+    ~MultiStageEnvelope();
+
+    //==============================================================================
+    void prepareToPlay(double sampleRate, int samplesPerBlock);
+
+    // Changes the rate it's run at without resetting. A running segment
+    // keeps the fraction of it already elapsed.
+    void setSampleRate(double sampleRate);
+
+    void processBlock(juce::AudioBuffer<float>& buffer, int numSamples);
+    void reset();
+
+    //==============================================================================
+    void noteOn(int midiNoteNumber, float velocity);
+    void noteOff(int midiNoteNumber);
+
+    //==============================================================================
+    // Bakes and publishes a new shape. Call from one thread only (normally
+    // the message thread). The envelope starts at 0; loopStart of -1 turns
+    // the loop off.
+    void setShape(const Segment* segments, int numSegments, int loopStart, int loopEnd);
+
+    void setOneShot(bool isOneShot);
+
+    //==============================================================================
+    bool isActive() const;
+    bool isIdle() const;
+
+private:
+    //==============================================================================
+    static constexpr int tableSize = 64;   // intervals per segment
+
+    struct Shape
+    {
+        int numSegments;
+        int loopStart;   // -1 for no loop
+        int loopEnd;
+        float endLevel[maxSegments];
+        float timeMs[maxSegments];
+
+        // Each segment's curve from 0 to 1, tableSize + 1 points
+        float table[maxSegments][tableSize + 1];
+    };
+
+    // Triple buffer slots: the writer owns one, the reader one, and the
+    // third is the latest published. newShapeFlag marks it as not yet read.
+    static constexpr int newShapeFlag = 4;
+
+    //==============================================================================
+    // Picks up a shape published since the last call. Audio thread only,
+    // as it takes over the read slot.
+    void applyPendingShape();
+
+    // Starts a segment from the current level, or idles past the last one
+    void enterSegment(int segment);
+
+    // Re-times the running segment for the current shape and rate, as far
+    // through it as before
+    void retimeSegment();
+
+    // Renders the envelope times velocity into gain. Returns true if the
+    // whole run was one constant level, left in constantGain.
+    bool renderGain(float* gain, int numSamples, float& constantGain);
+
+    bool isLooping() const;
+
+    //==============================================================================
+    double sampleRate;
+
+    Shape shapes[3];
+    int writeIndex;                   // owned by the writer
+    int readIndex;                    // owned by the audio thread
+    std::atomic<int> publishedIndex;  // slot index, plus newShapeFlag
+
+    bool oneShot;
+    bool noteIsOn;
+    bool released;
+    float velocity;
+    float currentLevel;
+
+    // The segment being rendered, -1 when idle
+    int currentSegment;
+    int segmentPosition;    // samples into the segment
+    int segmentLength;      // samples
+    float segmentStart;
+    float segmentRange;     // end level minus start
+
+    //==============================================================================
+    juce::AudioBuffer<float> gainBuffer;
+};
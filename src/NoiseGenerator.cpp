@@ -3,24 +3,19 @@
 //==============================================================================
 NoiseGenerator::NoiseGenerator()
     : currentNoiseType(WhiteNoise)
+    , stereoMode(StereoIndependent)
+    , decorrelation(1.0f)       // Default: fully uncorrelated channels
     , sampleRate(44100.0)
-    , pinkNoiseCounter(0)
-    , brownNoiseLastOutput(0.0f)
     , digitalCrunchBitDepth(8)
     , digitalCrunchSampleRate(22050.0f)
-    , analogNoisePrevSample(0.0f)
-    , analogNoiseFilterState(0.0f)
 {
     // Initialize random number generator with a proper seed
     std::random_device rd;
     rng = std::mt19937(rd());
     distribution = std::uniform_real_distribution<float>(-1.0f, 1.0f);
 
-    // Initialize pink noise values
-    for (int i = 0; i < PINK_NOISE_NUM_STAGES; ++i)
-    {
-        pinkNoiseValues[i] = 0.0f;
-    }
+    prepareAllpassStages();
+    reset();
 }
 
 NoiseGenerator::~NoiseGenerator()
@@ -31,62 +26,50 @@ NoiseGenerator::~NoiseGenerator()
 void NoiseGenerator::prepareToPlay(double newSampleRate, int /*samplesPerBlock*/)
 {
     sampleRate = newSampleRate;
+    prepareAllpassStages();
     reset();
 }
 
 void NoiseGenerator::processBlock(juce::AudioBuffer<float>& buffer, int numSamples)
 {
-    const bool isStereo = buffer.getNumChannels() >= 2;
+    float* left = buffer.getWritePointer(0);
+    renderChannel(left, channelState[0], numSamples);
     
-    for (int sample = 0; sample < numSamples; ++sample)
-    {
-        float leftNoise = 0.0f;
-        float rightNoise = 0.0f;
-
-        switch (currentNoiseType)
-        {
-            case WhiteNoise:
-                leftNoise = generateWhiteNoise();
-                rightNoise = isStereo ? generateWhiteNoise() : leftNoise;
-                break;
-            case PinkNoise:
-                leftNoise = generatePinkNoise();
-                rightNoise = isStereo ? generatePinkNoise() : leftNoise;
-                break;
-            case BrownNoise:
-                leftNoise = generateBrownNoise();
-                rightNoise = isStereo ? generateBrownNoise() : leftNoise;
-                break;
-            case DigitalCrunch:
-                leftNoise = generateDigitalCrunch();
-                rightNoise = isStereo ? generateDigitalCrunch() : leftNoise;
-                break;
-            case AnalogSimulation:
-                leftNoise = generateAnalogNoise();
-                rightNoise = isStereo ? generateAnalogNoise() : leftNoise;
-                break;
-            default:
-                leftNoise = rightNoise = 0.0f;
-                break;
-        }
-
-        // Write to channels
-        buffer.setSample(0, sample, leftNoise);
-        if (isStereo)
-            buffer.setSample(1, sample, rightNoise);
-    }
+    if (buffer.getNumChannels() < 2)
+        return;
+    
+    float* right = buffer.getWritePointer(1);
+    
+    // The decorrelated mode runs the generator once and derives the right
+    // channel, roughly halving the generator cost
+    if (stereoMode == StereoDecorrelated)
+        renderDecorrelatedChannel(left, right, numSamples);
+    else
+        renderChannel(right, channelState[1], numSamples);
+    
+    applyCorrelation(left, right, numSamples);
 }
 
 void NoiseGenerator::reset()
 {
     // Reset all noise generators
-    brownNoiseLastOutput = 0.0f;
-    analogNoisePrevSample = 0.0f;
-    analogNoiseFilterState = 0.0f;
-
-    for (int i = 0; i < PINK_NOISE_NUM_STAGES; ++i)
+    for (auto& state : channelState)
     {
-        pinkNoiseValues[i] = 0.0f;
+        for (int i = 0; i < PINK_NOISE_NUM_STAGES; ++i)
+            state.pinkNoiseValues[i] = 0.0f;
+        
+        state.pinkNoiseCounter = 0;
+        state.brownNoiseLastOutput = 0.0f;
+        state.digitalCrunchPhase = 0.0f;
+        state.digitalCrunchLastSample = 0.0f;
+        state.analogNoisePrevSample = 0.0f;
+        state.analogNoiseFilterState = 0.0f;
+    }
+    
+    for (auto& stage : allpassStages)
+    {
+        std::fill(stage.buffer.begin(), stage.buffer.end(), 0.0f);
+        stage.position = 0;
     }
 }
 
@@ -101,43 +84,159 @@ NoiseGenerator::NoiseType NoiseGenerator::getNoiseType() const
     return currentNoiseType;
 }
 
+void NoiseGenerator::setStereoMode(StereoMode mode)
+{
+    stereoMode = mode;
+}
+
+NoiseGenerator::StereoMode NoiseGenerator::getStereoMode() const
+{
+    return stereoMode;
+}
+
+void NoiseGenerator::setDecorrelation(float amount)
+{
+    decorrelation = juce::jlimit(0.0f, 1.0f, amount);
+}
+
+float NoiseGenerator::getDecorrelation() const
+{
+    return decorrelation;
+}
+
+//==============================================================================
+void NoiseGenerator::renderChannel(float* output, ChannelState& state, int numSamples)
+{
+    // Select the generator once per block rather than once per sample
+    switch (currentNoiseType)
+    {
+        case WhiteNoise:
+            for (int i = 0; i < numSamples; ++i)
+                output[i] = generateWhiteNoise();
+            break;
+        case PinkNoise:
+            for (int i = 0; i < numSamples; ++i)
+                output[i] = generatePinkNoise(state);
+            break;
+        case BrownNoise:
+            for (int i = 0; i < numSamples; ++i)
+                output[i] = generateBrownNoise(state);
+            break;
+        case DigitalCrunch:
+            for (int i = 0; i < numSamples; ++i)
+                output[i] = generateDigitalCrunch(state);
+            break;
+        case AnalogSimulation:
+            for (int i = 0; i < numSamples; ++i)
+                output[i] = generateAnalogNoise(state);
+            break;
+        default:
+            juce::FloatVectorOperations::clear(output, numSamples);
+            break;
+    }
+}
+
+void NoiseGenerator::renderDecorrelatedChannel(const float* input, float* output, int numSamples)
+{
+    juce::FloatVectorOperations::copy(output, input, numSamples);
+    
+    // Each stage runs over the whole block in turn:
+    //   w[n] = x[n] + g * w[n - D],  y[n] = w[n - D] - g * w[n]
+    for (auto& stage : allpassStages)
+    {
+        float* delayLine = stage.buffer.data();
+        int position = stage.position;
+        
+        for (int i = 0; i < numSamples; ++i)
+        {
+            const float delayed = delayLine[position];
+            const float w = output[i] + ALLPASS_GAIN * delayed;
+            
+            output[i] = delayed - ALLPASS_GAIN * w;
+            delayLine[position] = w;
+            
+            if (++position >= stage.delay)
+                position = 0;
+        }
+        
+        stage.position = position;
+    }
+    
+    // The cascade's impulse response starts with (-g)^N, which leaves that much
+    // correlation with the input. Removing it and renormalising makes the
+    // output uncorrelated with white input, and nearly so for coloured noise.
+    const float directGain = std::pow(-ALLPASS_GAIN, static_cast<float>(NUM_ALLPASS_STAGES));
+    const float normalise = 1.0f / std::sqrt(1.0f - directGain * directGain);
+    
+    juce::FloatVectorOperations::addWithMultiply(output, input, -directGain, numSamples);
+    juce::FloatVectorOperations::multiply(output, normalise, numSamples);
+}
+
+void NoiseGenerator::applyCorrelation(const float* left, float* right, int numSamples)
+{
+    // At full decorrelation the right channel is used as is
+    if (decorrelation >= 1.0f)
+        return;
+    
+    // right = cos(theta) * left + sin(theta) * right keeps the level constant
+    // for uncorrelated inputs, and gives a correlation of about cos(theta)
+    const float theta = decorrelation * juce::MathConstants<float>::halfPi;
+    
+    juce::FloatVectorOperations::multiply(right, std::sin(theta), numSamples);
+    juce::FloatVectorOperations::addWithMultiply(right, left, std::cos(theta), numSamples);
+}
+
+void NoiseGenerator::prepareAllpassStages()
+{
+    // Delay times in ms, short enough not to be heard as echoes
+    static constexpr float delayTimesMs[NUM_ALLPASS_STAGES] = { 1.7f, 3.1f, 4.3f, 6.7f };
+    
+    for (int i = 0; i < NUM_ALLPASS_STAGES; ++i)
+    {
+        auto& stage = allpassStages[i];
+        stage.delay = juce::jmax(1, static_cast<int>(delayTimesMs[i] * 0.001 * sampleRate));
+        stage.buffer.assign(static_cast<size_t>(stage.delay), 0.0f);
+        stage.position = 0;
+    }
+}
+
 //==============================================================================
 float NoiseGenerator::generateWhiteNoise()
 {
     return distribution(rng);
 }
 
-float NoiseGenerator::generatePinkNoise()
+float NoiseGenerator::generatePinkNoise(ChannelState& state)
 {
     float white = generateWhiteNoise();
     float pink = 0.0f;
     
-    pinkNoiseCounter = (pinkNoiseCounter + 1) % 32768;
+    state.pinkNoiseCounter = (state.pinkNoiseCounter + 1) % 32768;
     
     for (int i = 0; i < PINK_NOISE_NUM_STAGES; i++) {
-        if ((pinkNoiseCounter & (1 << i)) == 0) {
-            pinkNoiseValues[i] = white;
+        if ((state.pinkNoiseCounter & (1 << i)) == 0) {
+            state.pinkNoiseValues[i] = white;
         }
-        pink += pinkNoiseValues[i];
+        pink += state.pinkNoiseValues[i];
     }
     
     // Normalize to same range as white noise (approximately)
     return pink * 0.125f;
 }
 
-float NoiseGenerator::generateBrownNoise()
+float NoiseGenerator::generateBrownNoise(ChannelState& state)
 {
     // Generate white noise sample
     float white = generateWhiteNoise();
     
     // Filter to create brown noise
-    brownNoiseLastOutput = (brownNoiseLastOutput + (0.02f * white)) / 1.02f;
+    state.brownNoiseLastOutput = (state.brownNoiseLastOutput + (0.02f * white)) / 1.02f;
     
     // Normalize to prevent DC offset and scale to match other noise types
-    return brownNoiseLastOutput * 3.5f;
+    return state.brownNoiseLastOutput * 3.5f;
 }
 
-float NoiseGenerator::generateDigitalCrunch()
+float NoiseGenerator::generateDigitalCrunch(ChannelState& state)
 {
     // Generate base noise
     float noise = generateWhiteNoise();
@@ -147,38 +246,35 @@ float NoiseGenerator::generateDigitalCrunch()
     noise = std::round(noise * scale) / scale;
     
     // Apply sample rate reduction (simple decimation)
-    static float phase = 0.0f;
-    static float lastSample = 0.0f;
-    
-    phase += digitalCrunchSampleRate / sampleRate;
+    state.digitalCrunchPhase += digitalCrunchSampleRate / float(sampleRate);
     
-    if (phase >= 1.0f) {
-        phase -= 1.0f;
-        lastSample = noise;
+    if (state.digitalCrunchPhase >= 1.0f) {
+        state.digitalCrunchPhase -= 1.0f;
+        state.digitalCrunchLastSample = noise;
     }
     
-    return lastSample;
+    return state.digitalCrunchLastSample;
 }
 
-float NoiseGenerator::generateAnalogNoise()
+float NoiseGenerator::generateAnalogNoise(ChannelState& state)
 {
     // Generate base noise with subtle correlations
-    float noise = 0.85f * analogNoisePrevSample + 0.15f * generateWhiteNoise();
-    analogNoisePrevSample = noise;
+    float noise = 0.85f * state.analogNoisePrevSample + 0.15f * generateWhiteNoise();
+    state.analogNoisePrevSample = noise;
     
     // Apply analog-style filtering
     // Simple one-pole lowpass filter to simulate circuit characteristics
     float cutoff = 7000.0f; // Hz
     float alpha = 1.0f / (1.0f + 2.0f * juce::MathConstants<float>::pi * (cutoff / float(sampleRate)));
     
-    analogNoiseFilterState = alpha * analogNoiseFilterState + (1.0f - alpha) * noise;
+    state.analogNoiseFilterState = alpha * state.analogNoiseFilterState + (1.0f - alpha) * noise;
     
     // Add subtle harmonic distortion
-    float distorted = std::tanh(analogNoiseFilterState * 1.5f);
+    float distorted = std::tanh(state.analogNoiseFilterState * 1.5f);
     
     // Mix in some higher frequency noise for transistor hiss
     float hiss = generateWhiteNoise() * 0.15f;
     hiss = juce::jlimit(-0.15f, 0.15f, hiss); // Limit the hiss amplitude
     
     return distorted + hiss;
-}
\ No newline at end of file
+}
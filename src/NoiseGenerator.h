@@ -2,6 +2,7 @@
 
 #include <JuceHeader.h>
 #include <random>
+#include <vector>
 
 //==============================================================================
 /**
@@ -20,6 +21,13 @@ public:
         AnalogSimulation,
         NumNoiseTypes
     };
+    
+    enum StereoMode
+    {
+        StereoIndependent = 0,  // separate generator state per channel
+        StereoDecorrelated,     // one mono stream, right derived by all-pass
+        NumStereoModes
+    };
 
     //==============================================================================
     NoiseGenerator();
@@ -33,45 +41,96 @@ public:
     //==============================================================================
     void setNoiseType(NoiseType type);
     NoiseType getNoiseType() const;
+    
+    void setStereoMode(StereoMode mode);
+    StereoMode getStereoMode() const;
+    
+    // 0 = both channels identical, 1 = fully uncorrelated
+    void setDecorrelation(float amount);
+    float getDecorrelation() const;
 
 private:
+    //==============================================================================
+    // Filter and decimator state for one channel, so channels generated
+    // independently don't share (and corrupt) each other's history
+    static constexpr int PINK_NOISE_NUM_STAGES = 8;
+    
+    struct ChannelState
+    {
+        // Pink noise state
+        float pinkNoiseValues[PINK_NOISE_NUM_STAGES];
+        int pinkNoiseCounter;
+        
+        // Brown noise state
+        float brownNoiseLastOutput;
+        
+        // Digital crunch decimator state
+        float digitalCrunchPhase;
+        float digitalCrunchLastSample;
+        
+        // Analog simulation state
+        float analogNoisePrevSample;
+        float analogNoiseFilterState;
+    };
+    
+    //==============================================================================
+    // Fills one channel with the current noise type
+    void renderChannel(float* output, ChannelState& state, int numSamples);
+    
+    // Derives the right channel from the left through the all-pass network
+    void renderDecorrelatedChannel(const float* input, float* output, int numSamples);
+    
+    // Constant-power blend of the right channel towards the left, setting the
+    // inter-channel correlation
+    void applyCorrelation(const float* left, float* right, int numSamples);
+    
+    // Sizes the all-pass delay lines for the current sample rate
+    void prepareAllpassStages();
+
     //==============================================================================
     // White noise generator
     float generateWhiteNoise();
 
     // Pink noise generator using Voss-McCartney algorithm
-    float generatePinkNoise();
+    float generatePinkNoise(ChannelState& state);
 
     // Brown noise generator
-    float generateBrownNoise();
+    float generateBrownNoise(ChannelState& state);
 
     // Digital crunch noise generator
-    float generateDigitalCrunch();
+    float generateDigitalCrunch(ChannelState& state);
 
     // Analog simulation noise generator
-    float generateAnalogNoise();
+    float generateAnalogNoise(ChannelState& state);
 
     //==============================================================================
     NoiseType currentNoiseType;
+    StereoMode stereoMode;
+    float decorrelation;
     double sampleRate;
 
     // Random number generator
     std::mt19937 rng;
     std::uniform_real_distribution<float> distribution;
 
-    // Pink noise state
-    static constexpr int PINK_NOISE_NUM_STAGES = 8;
-    float pinkNoiseValues[PINK_NOISE_NUM_STAGES];
-    int pinkNoiseCounter;
-
-    // Brown noise state
-    float brownNoiseLastOutput;
+    ChannelState channelState[2];
 
-    // Digital crunch state
+    // Digital crunch settings
     int digitalCrunchBitDepth;
     float digitalCrunchSampleRate;
-
-    // Analog simulation state
-    float analogNoisePrevSample;
-    float analogNoiseFilterState;
+    
+    // Decorrelation network: a cascade of Schroeder all-pass sections with
+    // short, incommensurate delays. The magnitude response is (nearly) flat,
+    // so the derived channel keeps the spectrum of the mono stream.
+    static constexpr int NUM_ALLPASS_STAGES = 4;
+    static constexpr float ALLPASS_GAIN = 0.6f;
+    
+    struct AllpassStage
+    {
+        std::vector<float> buffer;
+        int delay;
+        int position;
+    };
+    
+    AllpassStage allpassStages[NUM_ALLPASS_STAGES];
 };
\ No newline at end of file
@@ -0,0 +1,137 @@
+#include "Oversampler.h"
+
+//==============================================================================
+Oversampler::Oversampler()
+    : pendingFactor(Factor1x)
+    , activeFactor(Factor1x)
+    , numPreparedChannels(0)
+{
+}
+
+Oversampler::~Oversampler()
+{
+}
+
+//==============================================================================
+void Oversampler::prepareToPlay(double /*sampleRate*/, int samplesPerBlock, int numChannels)
+{
+    numPreparedChannels = numChannels;
+
+    // Factor1x passes audio through untouched, so it needs no oversampler.
+    // The other factors use 1, 2 and 3 cascaded half-band polyphase IIR stages.
+    for (int factor = Factor2x; factor < NumFactors; ++factor)
+    {
+        oversamplers[factor] = std::make_unique<juce::dsp::Oversampling<float>>(
+            static_cast<size_t>(numChannels),
+            static_cast<size_t>(factor),
+            juce::dsp::Oversampling<float>::filterHalfBandPolyphaseIIR,
+            true,   // max quality
+            true);  // integer latency, so it can be reported to the host
+
+        oversamplers[factor]->initProcessing(static_cast<size_t>(samplesPerBlock));
+    }
+
+    activeFactor = static_cast<Factor>(pendingFactor.load());
+    reset();
+}
+
+void Oversampler::reset()
+{
+    for (auto& oversampler : oversamplers)
+    {
+        if (oversampler != nullptr)
+            oversampler->reset();
+    }
+}
+
+//==============================================================================
+void Oversampler::setFactor(Factor factor)
+{
+    pendingFactor = juce::jlimit(static_cast<int>(Factor1x), static_cast<int>(Factor8x), static_cast<int>(factor));
+}
+
+Oversampler::Factor Oversampler::getFactor() const
+{
+    return activeFactor;
+}
+
+bool Oversampler::applyPendingFactor()
+{
+    const auto requested = static_cast<Factor>(pendingFactor.load());
+
+    if (requested == activeFactor)
+        return false;
+
+    activeFactor = requested;
+
+    // Clear the newly selected oversampler so stale filter state from a
+    // previous use doesn't leak into the output
+    if (oversamplers[activeFactor] != nullptr)
+        oversamplers[activeFactor]->reset();
+
+    return true;
+}
+
+//==============================================================================
+int Oversampler::getOversamplingMultiplier() const
+{
+    return 1 << static_cast<int>(activeFactor);
+}
+
+int Oversampler::getLatencySamples() const
+{
+    if (activeFactor == Factor1x || oversamplers[activeFactor] == nullptr)
+        return 0;
+
+    return static_cast<int>(oversamplers[activeFactor]->getLatencyInSamples());
+}
+
+int Oversampler::getMaxLatencySamples() const
+{
+    int maxLatency = 0;
+
+    for (const auto& oversampler : oversamplers)
+    {
+        if (oversampler != nullptr)
+            maxLatency = juce::jmax(maxLatency, static_cast<int>(oversampler->getLatencyInSamples()));
+    }
+
+    return maxLatency;
+}
+
+//==============================================================================
+juce::AudioBuffer<float> Oversampler::processSamplesUp(juce::AudioBuffer<float>& buffer, int numSamples)
+{
+    const int numChannels = juce::jmin(buffer.getNumChannels(), numPreparedChannels);
+
+    if (activeFactor == Factor1x || oversamplers[activeFactor] == nullptr)
+        return juce::AudioBuffer<float>(buffer.getArrayOfWritePointers(), buffer.getNumChannels(), numSamples);
+
+    juce::dsp::AudioBlock<float> block(buffer.getArrayOfWritePointers(),
+                                       static_cast<size_t>(numChannels),
+                                       static_cast<size_t>(numSamples));
+
+    auto oversampledBlock = oversamplers[activeFactor]->processSamplesUp(block);
+
+    // Wrap the oversampler's internal storage without copying or allocating
+    float* channels[2] = { nullptr, nullptr };
+    for (int channel = 0; channel < numChannels && channel < 2; ++channel)
+        channels[channel] = oversampledBlock.getChannelPointer(static_cast<size_t>(channel));
+
+    return juce::AudioBuffer<float>(channels, juce::jmin(numChannels, 2),
+                                    static_cast<int>(oversampledBlock.getNumSamples()));
+}
+
+void Oversampler::processSamplesDown(juce::AudioBuffer<float>& buffer, int numSamples)
+{
+    if (activeFactor == Factor1x || oversamplers[activeFactor] == nullptr)
+        return;
+
+    const int numChannels = juce::jmin(buffer.getNumChannels(), numPreparedChannels);
+
+    juce::dsp::AudioBlock<float> block(buffer.getArrayOfWritePointers(),
+                                       static_cast<size_t>(numChannels),
+                                       static_cast<size_t>(numSamples));
+
+    oversamplers[activeFactor]->processSamplesDown(block);
+}
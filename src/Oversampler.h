@@ -0,0 +1,67 @@
+#pragma once
+
+#include <JuceHeader.h>
+#include <atomic>
+
+//==============================================================================
+/**
+ * Polyphase oversampling wrapper for the nonlinear section of the signal chain.
+ *
+ * One juce::dsp::Oversampling instance is preallocated per factor so that
+ * switching factors never allocates on the audio thread.
+ */
+class Oversampler
+{
+public:
+    //==============================================================================
+    enum Factor
+    {
+        Factor1x = 0,
+        Factor2x,
+        Factor4x,
+        Factor8x,
+        NumFactors
+    };
+
+    //==============================================================================
+    Oversampler();
+    ~Oversampler();
+
+    //==============================================================================
+    void prepareToPlay(double sampleRate, int samplesPerBlock, int numChannels);
+    void reset();
+
+    //==============================================================================
+    // Can be called from any thread; the new factor takes effect on the next
+    // call to applyPendingFactor() on the audio thread.
+    void setFactor(Factor factor);
+    Factor getFactor() const;
+
+    // Returns true if the active factor changed and dependent processors
+    // need to be re-prepared at the new rate.
+    bool applyPendingFactor();
+
+    //==============================================================================
+    int getOversamplingMultiplier() const;
+    int getLatencySamples() const;
+
+    // The highest latency of any factor, once prepared
+    int getMaxLatencySamples() const;
+
+    //==============================================================================
+    // Upsamples the buffer and returns a non-owning view of the oversampled
+    // data. At 1x the view refers directly to the input buffer.
+    juce::AudioBuffer<float> processSamplesUp(juce::AudioBuffer<float>& buffer, int numSamples);
+
+    // Downsamples the processed data back into the buffer.
+    void processSamplesDown(juce::AudioBuffer<float>& buffer, int numSamples);
+
+private:
+    //==============================================================================
+    std::unique_ptr<juce::dsp::Oversampling<float>> oversamplers[NumFactors];
+
+    std::atomic<int> pendingFactor;
+    Factor activeFactor;
+
+    int numPreparedChannels;
+};
@@ -0,0 +1,192 @@
+#include "Phaser.h"
+
+//==============================================================================
+namespace
+{
+    // Sweep range at full depth
+    constexpr float minFrequency = 100.0f;
+    constexpr float maxFrequency = 8000.0f;
+}
+
+//==============================================================================
+Phaser::Phaser()
+    : sampleRate(44100.0)
+    , mix(0.0f)            // Default: 0% (off)
+    , stages(8)
+    , rate(0.5f)
+    , depth(0.8f)
+    , feedback(0.3f)
+    , stereoPhase(90.0f)
+    , lfoPhase(0.0)
+{
+    reset();
+}
+
+Phaser::~Phaser()
+{
+}
+
+//==============================================================================
+void Phaser::prepareToPlay(double newSampleRate, int /*samplesPerBlock*/)
+{
+    sampleRate = newSampleRate;
+    reset();
+}
+
+void Phaser::processBlock(juce::AudioBuffer<float>& buffer, int numSamples)
+{
+    if (mix <= 0.0f || numSamples <= 0)
+        return;
+
+    const int numChannels = juce::jmin(buffer.getNumChannels(), 2);
+    float* channelData[2] = { buffer.getWritePointer(0),
+                              numChannels > 1 ? buffer.getWritePointer(1) : nullptr };
+
+    const double phaseIncrement = rate / sampleRate;
+    const double stereoOffset = stereoPhase / 360.0;
+    const float dryGain = 1.0f - mix;
+    const float wetGain = mix;
+    const int numStages = stages;
+
+    for (int start = 0; start < numSamples; start += controlInterval)
+    {
+        const int length = juce::jmin(controlInterval, numSamples - start);
+
+        // Coefficients at the end of this interval, ramped from the last ones
+        lfoPhase += phaseIncrement * length;
+        lfoPhase -= std::floor(lfoPhase);
+
+        alignas(16) float increment[2];
+        for (int channel = 0; channel < 2; ++channel)
+        {
+            const float target = calculateCoefficient(lfoPhase + channel * stereoOffset);
+            increment[channel] = (target - coefficient[channel]) / static_cast<float>(length);
+        }
+
+        for (int i = start; i < start + length; ++i)
+        {
+            // Mono input runs through both lanes; the right one is dropped
+            alignas(16) float x[2];
+            x[0] = channelData[0][i];
+            x[1] = channelData[1] != nullptr ? channelData[1][i] : x[0];
+
+            alignas(16) float y[2];
+            for (int channel = 0; channel < 2; ++channel)
+            {
+                coefficient[channel] += increment[channel];
+                y[channel] = x[channel] + feedback * lastOutput[channel];
+            }
+
+            // Both lanes through each stage: y = a*x + s, s = x - a*y
+            for (int stage = 0; stage < numStages; ++stage)
+            {
+                for (int channel = 0; channel < 2; ++channel)
+                {
+                    const float input = y[channel];
+                    const float output = coefficient[channel] * input + stageState[stage][channel];
+                    stageState[stage][channel] = input - coefficient[channel] * output;
+                    y[channel] = output;
+                }
+            }
+
+            for (int channel = 0; channel < 2; ++channel)
+                lastOutput[channel] = y[channel];
+
+            channelData[0][i] = x[0] * dryGain + y[0] * wetGain;
+            if (channelData[1] != nullptr)
+                channelData[1][i] = x[1] * dryGain + y[1] * wetGain;
+        }
+    }
+}
+
+void Phaser::reset()
+{
+    for (int stage = 0; stage < maxStages; ++stage)
+    {
+        stageState[stage][0] = 0.0f;
+        stageState[stage][1] = 0.0f;
+    }
+
+    lfoPhase = 0.0;
+
+    for (int channel = 0; channel < 2; ++channel)
+    {
+        coefficient[channel] = calculateCoefficient(channel * stereoPhase / 360.0);
+        lastOutput[channel] = 0.0f;
+    }
+}
+
+//==============================================================================
+void Phaser::setMix(float newMix)
+{
+    mix = juce::jlimit(0.0f, 1.0f, newMix);
+}
+
+void Phaser::setStages(int numStages)
+{
+    // Stages come in pairs, so the notches fall between the extremes of the
+    // sweep rather than at DC or Nyquist
+    stages = juce::jlimit(minStages, maxStages, numStages) & ~1;
+}
+
+void Phaser::setRate(float rateHz)
+{
+    rate = juce::jlimit(0.01f, 10.0f, rateHz);
+}
+
+void Phaser::setDepth(float newDepth)
+{
+    depth = juce::jlimit(0.0f, 1.0f, newDepth);
+}
+
+void Phaser::setFeedback(float newFeedback)
+{
+    feedback = juce::jlimit(0.0f, 0.9f, newFeedback);
+}
+
+void Phaser::setStereoPhase(float degrees)
+{
+    stereoPhase = juce::jlimit(0.0f, 180.0f, degrees);
+}
+
+float Phaser::getMix() const
+{
+    return mix;
+}
+
+int Phaser::getStages() const
+{
+    return stages;
+}
+
+float Phaser::getRate() const
+{
+    return rate;
+}
+
+float Phaser::getDepth() const
+{
+    return depth;
+}
+
+float Phaser::getFeedback() const
+{
+    return feedback;
+}
+
+float Phaser::getStereoPhase() const
+{
+    return stereoPhase;
+}
+
+//==============================================================================
+float Phaser::calculateCoefficient(double lfoCyclePhase) const
+{
+    // Exponential sweep from minFrequency, up to maxFrequency at full depth
+    const float sweep = 0.5f + 0.5f * std::sin(juce::MathConstants<float>::twoPi * static_cast<float>(lfoCyclePhase));
+    const float frequency = juce::jmin(minFrequency * std::pow(maxFrequency / minFrequency, depth * sweep),
+                                       0.45f * static_cast<float>(sampleRate));
+
+    const float t = std::tan(juce::MathConstants<float>::pi * frequency / static_cast<float>(sampleRate));
+    return (t - 1.0f) / (t + 1.0f);
+}
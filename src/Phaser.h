@@ -0,0 +1,71 @@
+#pragma once
+
+#include <JuceHeader.h>
+
+//==============================================================================
+/**
+ * LFO-swept phaser with 4 to 12 first-order all-pass stages, for risers like
+ * "Phase Cannon".
+ *
+ * The all-pass coefficients come from the LFO once per control interval and
+ * are ramped linearly in between, so there's one tan() per channel per
+ * interval rather than per sample. The two channels run as interleaved
+ * lanes through each stage, with the right LFO offset in phase for a
+ * stereo sweep. Output is the dry signal mixed with the all-pass chain,
+ * which puts a notch wherever the chain's phase reaches 180 degrees.
+ */
+class Phaser
+{
+public:
+    //==============================================================================
+    static constexpr int minStages = 4;
+    static constexpr int maxStages = 12;
+    static constexpr int controlInterval = 32;   // samples per coefficient update
+
+    //==============================================================================
+    Phaser();
+    ~Phaser();
+
+    //==============================================================================
+    void prepareToPlay(double sampleRate, int samplesPerBlock);
+    void processBlock(juce::AudioBuffer<float>& buffer, int numSamples);
+    void reset();
+
+    //==============================================================================
+    void setMix(float mix);
+    void setStages(int numStages);
+    void setRate(float rateHz);
+    void setDepth(float depth);
+    void setFeedback(float feedback);
+    void setStereoPhase(float degrees);
+
+    float getMix() const;
+    int getStages() const;
+    float getRate() const;
+    float getDepth() const;
+    float getFeedback() const;
+    float getStereoPhase() const;
+
+private:
+    //==============================================================================
+    // All-pass coefficient placing the stage's 90 degree point at the LFO's
+    // current frequency, for an LFO phase in cycles
+    float calculateCoefficient(double lfoCyclePhase) const;
+
+    //==============================================================================
+    double sampleRate;
+
+    float mix;           // 0 to 1
+    int stages;          // even, minStages to maxStages
+    float rate;          // Hz
+    float depth;         // 0 to 1, sweep range
+    float feedback;      // 0 to 0.9
+    float stereoPhase;   // degrees of LFO offset on the right channel
+
+    double lfoPhase;     // cycles, 0 to 1
+
+    // Interleaved state: stage s of channel c is at [s][c]
+    alignas(16) float stageState[maxStages][2];
+    alignas(16) float coefficient[2];
+    alignas(16) float lastOutput[2];
+};
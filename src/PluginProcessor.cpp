@@ -10,104 +10,604 @@ NoiseLabAudioProcessor::NoiseLabAudioProcessor()
                      .withOutput("Output", juce::AudioChannelSet::stereo(), true))
     , apvts(*this, nullptr, "Parameters", createParameters())
     , currentTriggerMode(MIDI_TRIGGER)
+    , requestedControlInterval(32)
+    , pendingResets(0)
+    , polyphonic(false)
+    , useMultiStageEnvelope(false)
+    , sequencerEnabled(false)
+    , requestedReverbType(CONVOLUTION_REVERB)
+    , currentReverbType(CONVOLUTION_REVERB)
     , isPlaying(false)
     , bpm(120.0)
     , ppqPosition(0.0)
+    , barStartPosition(0.0)
+    , numGridTriggers(0)
+    , nextGridTrigger(0)
     , outputLevel(1.0f)
     , dryWetMix(1.0f)
+    , morphPosition(0.0f)
+    , appliedMorphPosition(0.0f)
+    , crossfadeNoise(false)
+    , crossfadeFilter(false)
+    , morphApplied(false)
     , currentSampleRate(44100.0)
+    , currentBlockSize(512)
+    , dryDelayMask(0)
+    , dryDelayWritePosition(0)
+    , dryDelaySamples(0)
 {
+    // The LFOs run at full scale; depth is applied by the matrix
+    lfoGenerator.setDepth(1.0f);
+    lfoGenerator2.setDepth(1.0f);
+    
+    // Separate seeds, so the random shapes of the two LFOs differ
+    lfoGenerator.setSeed(0x1f0);
+    lfoGenerator2.setSeed(0x2e1);
+    
     // Add parameter listeners
     apvts.addParameterListener("noiseType", this);
+    apvts.addParameterListener("stereoMode", this);
+    apvts.addParameterListener("stereoDecorrelation", this);
     apvts.addParameterListener("triggerMode", this);
+    apvts.addParameterListener("syncGrid", this);
+    apvts.addParameterListener("syncOffset", this);
+    apvts.addParameterListener("syncSwing", this);
+    apvts.addParameterListener("voiceMode", this);
+    apvts.addParameterListener("envelopeMode", this);
     apvts.addParameterListener("attack", this);
     apvts.addParameterListener("decay", this);
     apvts.addParameterListener("sustain", this);
     apvts.addParameterListener("release", this);
+    apvts.addParameterListener("attackCurve", this);
+    apvts.addParameterListener("decayCurve", this);
+    apvts.addParameterListener("releaseCurve", this);
     apvts.addParameterListener("lfoRate", this);
     apvts.addParameterListener("lfoDepth", this);
     apvts.addParameterListener("lfoSync", this);
+    apvts.addParameterListener("lfoDivision", this);
     apvts.addParameterListener("lfoTarget", this);
+    apvts.addParameterListener("lfoShape", this);
+    apvts.addParameterListener("controlInterval", this);
+    apvts.addParameterListener("seqEnabled", this);
+    apvts.addParameterListener("seqSteps", this);
+    apvts.addParameterListener("seqDivision", this);
+    apvts.addParameterListener("seqGate", this);
+    apvts.addParameterListener("lfo2Rate", this);
+    apvts.addParameterListener("lfo2Sync", this);
+    apvts.addParameterListener("lfo2Division", this);
+    apvts.addParameterListener("lfo2Shape", this);
+    apvts.addParameterListener("randomMode", this);
+    apvts.addParameterListener("randomRate", this);
+    apvts.addParameterListener("randomSeed", this);
+    
+    for (int slot = 1; slot <= numModulationSlots; ++slot)
+    {
+        auto& parameters = modulationSlotParameters[slot];
+        parameters.sourceID = "modSource" + juce::String(slot);
+        parameters.destinationID = "modDestination" + juce::String(slot);
+        parameters.depthID = "modDepth" + juce::String(slot);
+        parameters.source = apvts.getRawParameterValue(parameters.sourceID);
+        parameters.destination = apvts.getRawParameterValue(parameters.destinationID);
+        parameters.depth = apvts.getRawParameterValue(parameters.depthID);
+        
+        apvts.addParameterListener(parameters.sourceID, this);
+        apvts.addParameterListener(parameters.destinationID, this);
+        apvts.addParameterListener(parameters.depthID, this);
+    }
     apvts.addParameterListener("filterType", this);
     apvts.addParameterListener("cutoff", this);
     apvts.addParameterListener("resonance", this);
     apvts.addParameterListener("drive", this);
+    apvts.addParameterListener("driveMode", this);
+    apvts.addParameterListener("driveCurve", this);
     apvts.addParameterListener("bitcrush", this);
+    apvts.addParameterListener("crushRate", this);
     apvts.addParameterListener("width", this);
+    apvts.addParameterListener("oversampling", this);
+    apvts.addParameterListener("phaserMix", this);
+    apvts.addParameterListener("phaserStages", this);
+    apvts.addParameterListener("phaserRate", this);
+    apvts.addParameterListener("phaserDepth", this);
+    apvts.addParameterListener("phaserFeedback", this);
+    apvts.addParameterListener("phaserStereo", this);
+    apvts.addParameterListener("compMode", this);
+    apvts.addParameterListener("compThreshold", this);
+    apvts.addParameterListener("compRatio", this);
+    apvts.addParameterListener("compAttack", this);
+    apvts.addParameterListener("compRelease", this);
+    apvts.addParameterListener("compLookahead", this);
+    apvts.addParameterListener("compMakeup", this);
+    apvts.addParameterListener("duckDivision", this);
+    apvts.addParameterListener("duckDepth", this);
+    apvts.addParameterListener("delayMix", this);
+    apvts.addParameterListener("delayDivision", this);
+    apvts.addParameterListener("delayFeedback", this);
+    apvts.addParameterListener("delayPingPong", this);
+    apvts.addParameterListener("delayLowCut", this);
+    apvts.addParameterListener("delayHighCut", this);
+    apvts.addParameterListener("reverbMix", this);
+    apvts.addParameterListener("reverbDecay", this);
+    apvts.addParameterListener("reverbHeadSize", this);
+    apvts.addParameterListener("reverbHeadMode", this);
+    apvts.addParameterListener("reverbType", this);
+    apvts.addParameterListener("reverbDamping", this);
+    apvts.addParameterListener("reverbSize", this);
+    apvts.addParameterListener("limiter", this);
+    apvts.addParameterListener("limiterCeiling", this);
+    apvts.addParameterListener("limiterRelease", this);
     apvts.addParameterListener("output", this);
     apvts.addParameterListener("dryWet", this);
+    apvts.addParameterListener("morph", this);
+    
+    // One entry per MIDI note at most
+    activeNotes.reserve(128);
+    
+    // The preset morph reads its parameters without looking them up
+    for (int index = 0; index < PresetMorph::NumTargets; ++index)
+        morphParameters[index] = apvts.getRawParameterValue(PresetMorph::getParameterID(static_cast<PresetMorph::Target>(index)));
     
     // Initialize all parameters
     parameterChanged("noiseType", *apvts.getRawParameterValue("noiseType"));
+    parameterChanged("stereoMode", *apvts.getRawParameterValue("stereoMode"));
+    parameterChanged("stereoDecorrelation", *apvts.getRawParameterValue("stereoDecorrelation"));
     parameterChanged("triggerMode", *apvts.getRawParameterValue("triggerMode"));
+    parameterChanged("syncGrid", *apvts.getRawParameterValue("syncGrid"));
+    parameterChanged("syncOffset", *apvts.getRawParameterValue("syncOffset"));
+    parameterChanged("syncSwing", *apvts.getRawParameterValue("syncSwing"));
+    parameterChanged("voiceMode", *apvts.getRawParameterValue("voiceMode"));
+    parameterChanged("envelopeMode", *apvts.getRawParameterValue("envelopeMode"));
     parameterChanged("attack", *apvts.getRawParameterValue("attack"));
     parameterChanged("decay", *apvts.getRawParameterValue("decay"));
     parameterChanged("sustain", *apvts.getRawParameterValue("sustain"));
     parameterChanged("release", *apvts.getRawParameterValue("release"));
+    parameterChanged("attackCurve", *apvts.getRawParameterValue("attackCurve"));
+    parameterChanged("decayCurve", *apvts.getRawParameterValue("decayCurve"));
+    parameterChanged("releaseCurve", *apvts.getRawParameterValue("releaseCurve"));
     parameterChanged("lfoRate", *apvts.getRawParameterValue("lfoRate"));
     parameterChanged("lfoDepth", *apvts.getRawParameterValue("lfoDepth"));
     parameterChanged("lfoSync", *apvts.getRawParameterValue("lfoSync"));
+    parameterChanged("lfoDivision", *apvts.getRawParameterValue("lfoDivision"));
     parameterChanged("lfoTarget", *apvts.getRawParameterValue("lfoTarget"));
+    parameterChanged("lfoShape", *apvts.getRawParameterValue("lfoShape"));
+    parameterChanged("controlInterval", *apvts.getRawParameterValue("controlInterval"));
+    parameterChanged("seqEnabled", *apvts.getRawParameterValue("seqEnabled"));
+    parameterChanged("seqSteps", *apvts.getRawParameterValue("seqSteps"));
+    parameterChanged("seqDivision", *apvts.getRawParameterValue("seqDivision"));
+    parameterChanged("seqGate", *apvts.getRawParameterValue("seqGate"));
+    parameterChanged("lfo2Rate", *apvts.getRawParameterValue("lfo2Rate"));
+    parameterChanged("lfo2Sync", *apvts.getRawParameterValue("lfo2Sync"));
+    parameterChanged("lfo2Division", *apvts.getRawParameterValue("lfo2Division"));
+    parameterChanged("lfo2Shape", *apvts.getRawParameterValue("lfo2Shape"));
+    parameterChanged("randomMode", *apvts.getRawParameterValue("randomMode"));
+    parameterChanged("randomRate", *apvts.getRawParameterValue("randomRate"));
+    parameterChanged("randomSeed", *apvts.getRawParameterValue("randomSeed"));
+    
+    for (int slot = 1; slot <= numModulationSlots; ++slot)
+        updateModulationSlot(slot);
     parameterChanged("filterType", *apvts.getRawParameterValue("filterType"));
     parameterChanged("cutoff", *apvts.getRawParameterValue("cutoff"));
     parameterChanged("resonance", *apvts.getRawParameterValue("resonance"));
     parameterChanged("drive", *apvts.getRawParameterValue("drive"));
+    parameterChanged("driveMode", *apvts.getRawParameterValue("driveMode"));
+    parameterChanged("driveCurve", *apvts.getRawParameterValue("driveCurve"));
     parameterChanged("bitcrush", *apvts.getRawParameterValue("bitcrush"));
+    parameterChanged("crushRate", *apvts.getRawParameterValue("crushRate"));
     parameterChanged("width", *apvts.getRawParameterValue("width"));
+    parameterChanged("oversampling", *apvts.getRawParameterValue("oversampling"));
+    parameterChanged("phaserMix", *apvts.getRawParameterValue("phaserMix"));
+    parameterChanged("phaserStages", *apvts.getRawParameterValue("phaserStages"));
+    parameterChanged("phaserRate", *apvts.getRawParameterValue("phaserRate"));
+    parameterChanged("phaserDepth", *apvts.getRawParameterValue("phaserDepth"));
+    parameterChanged("phaserFeedback", *apvts.getRawParameterValue("phaserFeedback"));
+    parameterChanged("phaserStereo", *apvts.getRawParameterValue("phaserStereo"));
+    parameterChanged("compMode", *apvts.getRawParameterValue("compMode"));
+    parameterChanged("compThreshold", *apvts.getRawParameterValue("compThreshold"));
+    parameterChanged("compRatio", *apvts.getRawParameterValue("compRatio"));
+    parameterChanged("compAttack", *apvts.getRawParameterValue("compAttack"));
+    parameterChanged("compRelease", *apvts.getRawParameterValue("compRelease"));
+    parameterChanged("compLookahead", *apvts.getRawParameterValue("compLookahead"));
+    parameterChanged("compMakeup", *apvts.getRawParameterValue("compMakeup"));
+    parameterChanged("duckDivision", *apvts.getRawParameterValue("duckDivision"));
+    parameterChanged("duckDepth", *apvts.getRawParameterValue("duckDepth"));
+    parameterChanged("delayMix", *apvts.getRawParameterValue("delayMix"));
+    parameterChanged("delayDivision", *apvts.getRawParameterValue("delayDivision"));
+    parameterChanged("delayFeedback", *apvts.getRawParameterValue("delayFeedback"));
+    parameterChanged("delayPingPong", *apvts.getRawParameterValue("delayPingPong"));
+    parameterChanged("delayLowCut", *apvts.getRawParameterValue("delayLowCut"));
+    parameterChanged("delayHighCut", *apvts.getRawParameterValue("delayHighCut"));
+    parameterChanged("reverbMix", *apvts.getRawParameterValue("reverbMix"));
+    parameterChanged("reverbDecay", *apvts.getRawParameterValue("reverbDecay"));
+    parameterChanged("reverbHeadSize", *apvts.getRawParameterValue("reverbHeadSize"));
+    parameterChanged("reverbHeadMode", *apvts.getRawParameterValue("reverbHeadMode"));
+    parameterChanged("reverbType", *apvts.getRawParameterValue("reverbType"));
+    parameterChanged("reverbDamping", *apvts.getRawParameterValue("reverbDamping"));
+    parameterChanged("reverbSize", *apvts.getRawParameterValue("reverbSize"));
+    parameterChanged("limiter", *apvts.getRawParameterValue("limiter"));
+    parameterChanged("limiterCeiling", *apvts.getRawParameterValue("limiterCeiling"));
+    parameterChanged("limiterRelease", *apvts.getRawParameterValue("limiterRelease"));
     parameterChanged("output", *apvts.getRawParameterValue("output"));
     parameterChanged("dryWet", *apvts.getRawParameterValue("dryWet"));
+    parameterChanged("morph", *apvts.getRawParameterValue("morph"));
 }
 
 NoiseLabAudioProcessor::~NoiseLabAudioProcessor()
 {
     // Remove parameter listeners
     apvts.removeParameterListener("noiseType", this);
+    apvts.removeParameterListener("stereoMode", this);
+    apvts.removeParameterListener("stereoDecorrelation", this);
     apvts.removeParameterListener("triggerMode", this);
+    apvts.removeParameterListener("syncGrid", this);
+    apvts.removeParameterListener("syncOffset", this);
+    apvts.removeParameterListener("syncSwing", this);
+    apvts.removeParameterListener("voiceMode", this);
+    apvts.removeParameterListener("envelopeMode", this);
     apvts.removeParameterListener("attack", this);
     apvts.removeParameterListener("decay", this);
     apvts.removeParameterListener("sustain", this);
     apvts.removeParameterListener("release", this);
+    apvts.removeParameterListener("attackCurve", this);
+    apvts.removeParameterListener("decayCurve", this);
+    apvts.removeParameterListener("releaseCurve", this);
     apvts.removeParameterListener("lfoRate", this);
     apvts.removeParameterListener("lfoDepth", this);
     apvts.removeParameterListener("lfoSync", this);
+    apvts.removeParameterListener("lfoDivision", this);
     apvts.removeParameterListener("lfoTarget", this);
+    apvts.removeParameterListener("lfoShape", this);
+    apvts.removeParameterListener("controlInterval", this);
+    apvts.removeParameterListener("seqEnabled", this);
+    apvts.removeParameterListener("seqSteps", this);
+    apvts.removeParameterListener("seqDivision", this);
+    apvts.removeParameterListener("seqGate", this);
+    apvts.removeParameterListener("lfo2Rate", this);
+    apvts.removeParameterListener("lfo2Sync", this);
+    apvts.removeParameterListener("lfo2Division", this);
+    apvts.removeParameterListener("lfo2Shape", this);
+    apvts.removeParameterListener("randomMode", this);
+    apvts.removeParameterListener("randomRate", this);
+    apvts.removeParameterListener("randomSeed", this);
+    
+    for (int slot = 1; slot <= numModulationSlots; ++slot)
+    {
+        apvts.removeParameterListener(modulationSlotParameters[slot].sourceID, this);
+        apvts.removeParameterListener(modulationSlotParameters[slot].destinationID, this);
+        apvts.removeParameterListener(modulationSlotParameters[slot].depthID, this);
+    }
     apvts.removeParameterListener("filterType", this);
     apvts.removeParameterListener("cutoff", this);
     apvts.removeParameterListener("resonance", this);
     apvts.removeParameterListener("drive", this);
+    apvts.removeParameterListener("driveMode", this);
+    apvts.removeParameterListener("driveCurve", this);
     apvts.removeParameterListener("bitcrush", this);
+    apvts.removeParameterListener("crushRate", this);
     apvts.removeParameterListener("width", this);
+    apvts.removeParameterListener("oversampling", this);
+    apvts.removeParameterListener("phaserMix", this);
+    apvts.removeParameterListener("phaserStages", this);
+    apvts.removeParameterListener("phaserRate", this);
+    apvts.removeParameterListener("phaserDepth", this);
+    apvts.removeParameterListener("phaserFeedback", this);
+    apvts.removeParameterListener("phaserStereo", this);
+    apvts.removeParameterListener("compMode", this);
+    apvts.removeParameterListener("compThreshold", this);
+    apvts.removeParameterListener("compRatio", this);
+    apvts.removeParameterListener("compAttack", this);
+    apvts.removeParameterListener("compRelease", this);
+    apvts.removeParameterListener("compLookahead", this);
+    apvts.removeParameterListener("compMakeup", this);
+    apvts.removeParameterListener("duckDivision", this);
+    apvts.removeParameterListener("duckDepth", this);
+    apvts.removeParameterListener("delayMix", this);
+    apvts.removeParameterListener("delayDivision", this);
+    apvts.removeParameterListener("delayFeedback", this);
+    apvts.removeParameterListener("delayPingPong", this);
+    apvts.removeParameterListener("delayLowCut", this);
+    apvts.removeParameterListener("delayHighCut", this);
+    apvts.removeParameterListener("reverbMix", this);
+    apvts.removeParameterListener("reverbDecay", this);
+    apvts.removeParameterListener("reverbHeadSize", this);
+    apvts.removeParameterListener("reverbHeadMode", this);
+    apvts.removeParameterListener("reverbType", this);
+    apvts.removeParameterListener("reverbDamping", this);
+    apvts.removeParameterListener("reverbSize", this);
+    apvts.removeParameterListener("limiter", this);
+    apvts.removeParameterListener("limiterCeiling", this);
+    apvts.removeParameterListener("limiterRelease", this);
     apvts.removeParameterListener("output", this);
     apvts.removeParameterListener("dryWet", this);
+    apvts.removeParameterListener("morph", this);
 }
 
 //==============================================================================
 void NoiseLabAudioProcessor::prepareToPlay(double sampleRate, int samplesPerBlock)
 {
     currentSampleRate = sampleRate;
+    currentBlockSize = samplesPerBlock;
     
     // Prepare all processors
     noiseGenerator.prepareToPlay(sampleRate, samplesPerBlock);
+    morphNoiseGenerator.prepareToPlay(sampleRate, samplesPerBlock);
     envelopeGenerator.prepareToPlay(sampleRate, samplesPerBlock);
-    lfoGenerator.prepareToPlay(sampleRate, samplesPerBlock);
-    filterProcessor.prepareToPlay(sampleRate, samplesPerBlock);
-    effectsProcessor.prepareToPlay(sampleRate, samplesPerBlock);
+    voiceEngine.prepareToPlay(sampleRate, samplesPerBlock);
+    multiStageEnvelope.prepareToPlay(sampleRate, samplesPerBlock);
+    beatGridScheduler.prepareToPlay(sampleRate, samplesPerBlock);
+    stepSequencer.prepareToPlay(sampleRate, samplesPerBlock);
+    modulation.prepareToPlay(sampleRate, samplesPerBlock);
+    modulation.setControlInterval(requestedControlInterval);
+    prepareModulationSources(samplesPerBlock);
+    oversampler.prepareToPlay(sampleRate, samplesPerBlock, getTotalNumOutputChannels());
+    prepareNonlinearSection(samplesPerBlock);
+    
+    // The preset morph's second filter path, sized for the highest
+    // oversampling factor so switching factors never reallocates it
+    morphFilterBuffer.setSize(getTotalNumOutputChannels(), samplesPerBlock << (Oversampler::NumFactors - 1));
+    phaser.prepareToPlay(sampleRate, samplesPerBlock);
+    compressor.prepareToPlay(sampleRate, samplesPerBlock);
+    stereoDelay.prepareToPlay(sampleRate, samplesPerBlock);
+    convolutionReverb.prepareToPlay(sampleRate, samplesPerBlock);
+    fdnReverb.prepareToPlay(sampleRate, samplesPerBlock);
+    limiter.prepareToPlay(sampleRate, samplesPerBlock);
+    currentReverbType = requestedReverbType;
+    updateLatency();
     
     // Clear any leftover MIDI notes
     activeNotes.clear();
     
     // Initialize dry buffer for dry/wet processing
     dryBuffer.setSize(getTotalNumOutputChannels(), samplesPerBlock);
+    
+    // The dry delay ring holds the most latency the wet path can report,
+    // plus a block
+    const int maxDryDelay = oversampler.getMaxLatencySamples()
+                          + static_cast<int>(std::ceil(Compressor::maxLookaheadMs * 0.001 * sampleRate))
+                          + ConvolutionReverb::maxHeadSize;
+    const int dryDelaySize = juce::nextPowerOfTwo(maxDryDelay + samplesPerBlock + 1);
+    
+    dryDelayBuffer.setSize(getTotalNumOutputChannels(), dryDelaySize);
+    dryDelayBuffer.clear();
+    dryDelayMask = dryDelaySize - 1;
+    dryDelayWritePosition = 0;
+    
+    // One block of audio-rate LFO gain
+    lfoBuffer.setSize(1, samplesPerBlock);
+    
+    // One block of sequencer gain
+    sequencerBuffer.setSize(1, samplesPerBlock);
+    
+    // One block of the second noise type, for preset morphs
+    morphNoiseBuffer.setSize(getTotalNumOutputChannels(), samplesPerBlock);
 }
 
 void NoiseLabAudioProcessor::releaseResources()
 {
     // Release all processors
     noiseGenerator.reset();
+    morphNoiseGenerator.reset();
     envelopeGenerator.reset();
+    voiceEngine.reset();
+    multiStageEnvelope.reset();
+    beatGridScheduler.reset();
+    stepSequencer.reset();
     lfoGenerator.reset();
+    lfoGenerator2.reset();
+    randomModulator.reset();
+    modulationEnvelope.reset();
+    modulationMultiStageEnvelope.reset();
+    modulation.reset();
     filterProcessor.reset();
+    morphFilterProcessor.reset();
     effectsProcessor.reset();
+    oversampler.reset();
+    phaser.reset();
+    compressor.reset();
+    stereoDelay.reset();
+    convolutionReverb.reset();
+    fdnReverb.reset();
+    limiter.reset();
+}
+
+void NoiseLabAudioProcessor::renderFilter(FilterProcessor& filter, juce::AudioBuffer<float>& oversampledBuffer)
+{
+    const bool cutoffModulated = modulationMatrix.isDestinationUsed(ModulationMatrix::FilterCutoff);
+    const bool resonanceModulated = modulationMatrix.isDestinationUsed(ModulationMatrix::FilterResonance);
+    
+    if (!cutoffModulated && !resonanceModulated)
+    {
+        filter.applyModulation(0.0f);
+        filter.applyResonanceModulation(0.0f);
+        filter.processBlock(oversampledBuffer, oversampledBuffer.getNumSamples());
+        return;
+    }
+    
+    // Filter coefficients only change at control ticks
+    const int factor = oversampler.getOversamplingMultiplier();
+    
+    for (int interval = 0; interval < modulation.getNumIntervals(); ++interval)
+    {
+        const int length = modulation.getIntervalLength(interval);
+        if (length == 0)
+            continue;
+        
+        filter.applyModulation(cutoffModulated
+            ? modulation.getIntervalValue(firstDestinationLane + ModulationMatrix::FilterCutoff, interval) : 0.0f);
+        filter.applyResonanceModulation(resonanceModulated
+            ? modulation.getIntervalValue(firstDestinationLane + ModulationMatrix::FilterResonance, interval) : 0.0f);
+        
+        juce::AudioBuffer<float> range(oversampledBuffer.getArrayOfWritePointers(), oversampledBuffer.getNumChannels(),
+                                       modulation.getIntervalStart(interval) * factor, length * factor);
+        filter.processBlock(range, length * factor);
+    }
+}
+
+void NoiseLabAudioProcessor::updatePresetMorph()
+{
+    appliedMorphPosition = morphPosition;
+    crossfadeNoise = false;
+    crossfadeFilter = false;
+    
+    if (!presetMorph.isActive())
+    {
+        // Hand the stored parameters back to their own values
+        if (morphApplied)
+        {
+            morphApplied = false;
+            
+            for (int index = 0; index < PresetMorph::NumTargets; ++index)
+            {
+                const auto target = static_cast<PresetMorph::Target>(index);
+                
+                if (!PresetMorph::isDiscrete(target))
+                    applyMorphTarget(target, morphParameters[index]->load());
+            }
+            
+            effectsProcessor.endDriveMorph();
+            
+            noiseGenerator.setNoiseType(static_cast<NoiseGenerator::NoiseType>(
+                static_cast<int>(morphParameters[PresetMorph::NoiseType]->load())));
+            filterProcessor.setFilterType(static_cast<FilterProcessor::FilterType>(
+                static_cast<int>(morphParameters[PresetMorph::FilterType]->load())));
+        }
+        
+        return;
+    }
+    
+    morphApplied = true;
+    
+    // One lerp over every stored parameter
+    presetMorph.process(morphPosition, morphValues);
+    
+    for (int index = 0; index < PresetMorph::NumTargets; ++index)
+    {
+        const auto target = static_cast<PresetMorph::Target>(index);
+        
+        if (!PresetMorph::isDiscrete(target))
+            applyMorphTarget(target, PresetMorph::getTargetValue(target, morphValues[index]));
+    }
+    
+    // Discrete parameters are A's until the morph reaches B, with B's mixed
+    // in on a second path in between
+    const bool betweenSnapshots = morphPosition > 0.0f && morphPosition < 1.0f;
+    const int slot = morphPosition < 1.0f ? 0 : 1;
+    
+    const int noiseA = presetMorph.getDiscreteValue(0, PresetMorph::NoiseType);
+    const int noiseB = presetMorph.getDiscreteValue(1, PresetMorph::NoiseType);
+    noiseGenerator.setNoiseType(static_cast<NoiseGenerator::NoiseType>(slot == 0 ? noiseA : noiseB));
+    morphNoiseGenerator.setNoiseType(static_cast<NoiseGenerator::NoiseType>(noiseB));
+    crossfadeNoise = betweenSnapshots && noiseA != noiseB;
+    
+    const int filterA = presetMorph.getDiscreteValue(0, PresetMorph::FilterType);
+    const int filterB = presetMorph.getDiscreteValue(1, PresetMorph::FilterType);
+    filterProcessor.setFilterType(static_cast<FilterProcessor::FilterType>(slot == 0 ? filterA : filterB));
+    morphFilterProcessor.setFilterType(static_cast<FilterProcessor::FilterType>(filterB));
+    crossfadeFilter = betweenSnapshots && filterA != filterB;
+}
+
+void NoiseLabAudioProcessor::applyMorphTarget(PresetMorph::Target target, float value)
+{
+    switch (target)
+    {
+        case PresetMorph::Cutoff:
+            filterProcessor.setCutoffFrequency(value);
+            morphFilterProcessor.setCutoffFrequency(value);
+            break;
+            
+        case PresetMorph::Resonance:
+            filterProcessor.setResonance(value);
+            morphFilterProcessor.setResonance(value);
+            break;
+            
+        case PresetMorph::Drive:            effectsProcessor.setMorphedDrive(value, morphPosition); break;
+        case PresetMorph::Bitcrush:         effectsProcessor.setBitcrush(value); break;
+        case PresetMorph::CrushRate:        effectsProcessor.setCrushRate(value); break;
+        case PresetMorph::Width:            effectsProcessor.setStereoWidth(value); break;
+            
+        case PresetMorph::Decorrelation:
+            noiseGenerator.setDecorrelation(value);
+            morphNoiseGenerator.setDecorrelation(value);
+            break;
+            
+        case PresetMorph::PhaserMix:        phaser.setMix(value); break;
+        case PresetMorph::PhaserRate:       phaser.setRate(value); break;
+        case PresetMorph::PhaserDepth:      phaser.setDepth(value); break;
+        case PresetMorph::PhaserFeedback:   phaser.setFeedback(value); break;
+        case PresetMorph::DelayMix:         stereoDelay.setMix(value); break;
+        case PresetMorph::DelayFeedback:    stereoDelay.setFeedback(value); break;
+        case PresetMorph::DelayLowCut:      stereoDelay.setLowCut(value); break;
+        case PresetMorph::DelayHighCut:     stereoDelay.setHighCut(value); break;
+            
+        case PresetMorph::ReverbMix:
+            convolutionReverb.setMix(value);
+            fdnReverb.setMix(value);
+            break;
+            
+        case PresetMorph::ReverbDamping:    fdnReverb.setDamping(value); break;
+        case PresetMorph::ReverbSize:       fdnReverb.setSize(value); break;
+        case PresetMorph::Output:           outputLevel = value; break;
+        case PresetMorph::DryWet:           dryWetMix = value; break;
+            
+        case PresetMorph::NoiseType:
+        case PresetMorph::FilterType:
+        case PresetMorph::NumTargets:
+        default:
+            break;
+    }
+}
+
+void NoiseLabAudioProcessor::prepareNonlinearSection(int samplesPerBlock)
+{
+    // The filter and the nonlinear effects run at the oversampled rate
+    const int factor = oversampler.getOversamplingMultiplier();
+    
+    filterProcessor.prepareToPlay(currentSampleRate * factor, samplesPerBlock * factor);
+    morphFilterProcessor.prepareToPlay(currentSampleRate * factor, samplesPerBlock * factor);
+    effectsProcessor.prepareToPlay(currentSampleRate * factor, samplesPerBlock * factor);
+    effectsProcessor.setOversamplingFactor(factor);
+}
+
+void NoiseLabAudioProcessor::updateLatency()
+{
+    const int reverbLatency = currentReverbType == CONVOLUTION_REVERB ? convolutionReverb.getLatencySamples() : 0;
+    
+    // Everything before the dry/wet mix
+    dryDelaySamples = oversampler.getLatencySamples() + compressor.getLatencySamples() + reverbLatency;
+    
+    setLatencySamples(dryDelaySamples + limiter.getLatencySamples());
+}
+
+void NoiseLabAudioProcessor::delayDryPath(const juce::AudioBuffer<float>& input)
+{
+    const int numSamples = input.getNumSamples();
+    const int numChannels = juce::jmin(input.getNumChannels(), dryDelayBuffer.getNumChannels());
+    const int ringSize = dryDelayMask + 1;
+    
+    if (numChannels == 0 || numSamples > ringSize - dryDelaySamples)
+    {
+        dryBuffer.makeCopyOf(input, true);
+        return;
+    }
+    
+    dryBuffer.setSize(input.getNumChannels(), numSamples, false, false, true);
+    
+    const int readPosition = (dryDelayWritePosition - dryDelaySamples) & dryDelayMask;
+    
+    for (int channel = 0; channel < numChannels; ++channel)
+    {
+        float* ring = dryDelayBuffer.getWritePointer(channel);
+        
+        // Write first, so with no latency the block reads straight back
+        const int firstWrite = juce::jmin(numSamples, ringSize - dryDelayWritePosition);
+        juce::FloatVectorOperations::copy(ring + dryDelayWritePosition, input.getReadPointer(channel), firstWrite);
+        juce::FloatVectorOperations::copy(ring, input.getReadPointer(channel) + firstWrite, numSamples - firstWrite);
+        
+        const int firstRead = juce::jmin(numSamples, ringSize - readPosition);
+        float* dry = dryBuffer.getWritePointer(channel);
+        juce::FloatVectorOperations::copy(dry, ring + readPosition, firstRead);
+        juce::FloatVectorOperations::copy(dry + firstRead, ring, numSamples - firstRead);
+    }
+    
+    dryDelayWritePosition = (dryDelayWritePosition + numSamples) & dryDelayMask;
 }
 
 bool NoiseLabAudioProcessor::isBusesLayoutSupported(const BusesLayout& layouts) const
@@ -132,7 +632,11 @@ void NoiseLabAudioProcessor::processBlock(juce::AudioBuffer<float>& buffer, juce
             << " (0=FREE_RUN, 1=MIDI_TRIGGER, 2=HOST_SYNC, 3=ONE_SHOT)");
     }
     
+    applyPendingResets();
+    
     // Update playback position from host
+    const bool wasPlaying = isPlaying;
+    bool hostTransportRunning = false;
     auto playHead = getPlayHead();
     if (playHead != nullptr)
     {
@@ -143,183 +647,241 @@ void NoiseLabAudioProcessor::processBlock(juce::AudioBuffer<float>& buffer, juce
             isPlaying = positionInfo.isPlaying;
             bpm = positionInfo.bpm;
             ppqPosition = positionInfo.ppqPosition;
+            barStartPosition = positionInfo.ppqPositionOfLastBarStart;
+            
+            hostTransportRunning = isPlaying;
             
             // Update LFO with host timing info
             lfoGenerator.setHostBPM(bpm);
-            lfoGenerator.setHostPPQPosition(ppqPosition);
+            lfoGenerator2.setHostBPM(bpm);
+            stepSequencer.setHostBPM(bpm);
+            stereoDelay.setTempo(bpm);
+            compressor.setHostBPM(bpm);
+            beatGridScheduler.setTimeSignature(positionInfo.timeSigNumerator, positionInfo.timeSigDenominator);
+            
+            // While stopped the ducking keeps its own time
+            if (isPlaying)
+                compressor.setHostPPQPosition(ppqPosition);
         }
     }
     
-    // Process MIDI messages
-    for (const auto& metadata : midiMessages)
+    // While both preset snapshots are stored, the morph drives them. This
+    // can change the dry/wet mix, so it comes first.
+    if (presetMorph.applyPendingSnapshots() || morphPosition != appliedMorphPosition)
+        updatePresetMorph();
+    
+    if (crossfadeNoise)
+        morphNoiseBuffer.setSize(buffer.getNumChannels(), buffer.getNumSamples(), false, false, true);
+    
+    // Keep a delayed copy of the input for dry/wet mixing. The ring is fed
+    // even at 100% wet, so lowering the mix never plays stale input.
+    delayDryPath(buffer);
+    
+    if (dryWetMix >= 1.0f)
+    {
+        // If not using input (100% wet), clear the buffer
+        buffer.clear();
+    }
+    
+    // Render the noise source, split at each MIDI event so notes start and
+    // stop on the sample they're timestamped with. Without MIDI the whole
+    // block renders in one go.
+    const int numSamples = buffer.getNumSamples();
+    
+    // In host sync the envelope retriggers on the beat grid while the
+    // transport plays, and is released when it stops
+    numGridTriggers = 0;
+    nextGridTrigger = 0;
+    
+    if (currentTriggerMode == HOST_SYNC && hostTransportRunning)
+    {
+        numGridTriggers = beatGridScheduler.findTriggers(ppqPosition, barStartPosition, bpm, numSamples);
+    }
+    else
     {
-        const auto message = metadata.getMessage();
+        beatGridScheduler.reset();
         
-        if (message.isNoteOn())
-        {
-            DBG("MIDI Note On received: note=" << message.getNoteNumber() 
-                << ", velocity=" << message.getVelocity() 
-                << ", trigger_mode=" << static_cast<int>(currentTriggerMode));
-                
-            // Add to active notes
-            MidiNote note;
-            note.noteNumber = message.getNoteNumber();
-            note.velocity = static_cast<int>(message.getVelocity());
-            note.isActive = true;
-            
-            activeNotes.push_back(note);
-            
-            // Trigger envelope only in MIDI trigger mode
-            if (currentTriggerMode == MIDI_TRIGGER || currentTriggerMode == ONE_SHOT)
-            {
-                float velocityAsFloat = static_cast<float>(note.velocity) / 127.0f;
-                envelopeGenerator.noteOn(note.noteNumber, velocityAsFloat);
-                DBG("Triggered envelope: note=" << note.noteNumber << ", velocity=" << velocityAsFloat);
-            }
-            else
-            {
-                DBG("MIDI note received but trigger mode is " << static_cast<int>(currentTriggerMode) << " - not triggering envelope");
-            }
-        }
-        else if (message.isNoteOff())
+        if (currentTriggerMode == HOST_SYNC && wasPlaying && !isPlaying)
+            releaseGridNote();
+    }
+    
+    if (midiMessages.isEmpty())
+    {
+        renderSourceWithTriggers(buffer, 0, numSamples);
+    }
+    else
+    {
+        int position = 0;
+        
+        for (const auto metadata : midiMessages)
         {
-            DBG("MIDI Note Off received: note=" << message.getNoteNumber() 
-                << ", trigger_mode=" << static_cast<int>(currentTriggerMode));
-                
-            // Remove from active notes
-            for (auto& note : activeNotes)
-            {
-                if (note.noteNumber == message.getNoteNumber())
-                {
-                    note.isActive = false;
-                }
-            }
+            const int eventPosition = juce::jlimit(position, numSamples, metadata.samplePosition);
             
-            // If no active notes left, trigger envelope release
-            bool anyActive = false;
-            for (const auto& note : activeNotes)
+            if (eventPosition > position)
             {
-                if (note.isActive)
-                {
-                    anyActive = true;
-                    break;
-                }
+                renderSourceWithTriggers(buffer, position, eventPosition - position);
+                position = eventPosition;
             }
             
-            if (!anyActive)
-            {
-                if (currentTriggerMode == MIDI_TRIGGER || currentTriggerMode == ONE_SHOT)
-                {
-                    envelopeGenerator.noteOff(message.getNoteNumber());
-                    DBG("Triggered envelope release: note=" << message.getNoteNumber());
-                }
-                else
-                {
-                    DBG("Note off received but trigger mode is " << static_cast<int>(currentTriggerMode) << " - not releasing envelope");
-                }
-            }
-        }
-        else if (message.isAllNotesOff())
-        {
-            // Clear all notes
-            activeNotes.clear();
-            envelopeGenerator.reset();
+            handleMidiMessage(metadata.getMessage());
         }
+        
+        if (position < numSamples)
+            renderSourceWithTriggers(buffer, position, numSamples - position);
     }
     
-    // Handle FREE_RUN mode - continuously trigger envelope if needed
-    if (currentTriggerMode == FREE_RUN)
+    // Step sequencer, locked to the transport while it plays. It also runs
+    // when only its filter values are in use, without gating.
+    const bool sequencerRouted = modulationMatrix.isSourceUsed(ModulationMatrix::Sequencer);
+    
+    if (sequencerEnabled || sequencerRouted)
     {
-        // Check if envelope is idle and needs retriggering
-        if (envelopeGenerator.isIdle())
+        if (hostTransportRunning)
+            stepSequencer.setHostPPQPosition(ppqPosition);
+        
+        sequencerBuffer.setSize(1, numSamples, false, false, true);
+        float* sequencerGain = sequencerBuffer.getWritePointer(0);
+        stepSequencer.renderGain(sequencerGain, numSamples);
+        
+        if (sequencerEnabled)
         {
-            envelopeGenerator.noteOn(60, 1.0f);  // Trigger with middle C, full velocity
-            static int triggerCount = 0;
-            if (++triggerCount % 100 == 0) {  // Throttle debug output
-                DBG("FREE_RUN: Auto-retriggered envelope (count: " << triggerCount << ")");
-            }
+            for (int channel = 0; channel < buffer.getNumChannels(); ++channel)
+                juce::FloatVectorOperations::multiply(buffer.getWritePointer(channel), sequencerGain, numSamples);
         }
     }
     
-    // Make a copy of the input for dry/wet mixing if needed
-    if (dryWetMix < 1.0f)
+    // Evaluate the modulation sources in use once per control tick
+    if (requestedControlInterval != modulation.getControlInterval())
     {
-        dryBuffer.makeCopyOf(buffer);
+        modulation.setControlInterval(requestedControlInterval);
+        updateModulationSourceRates();
     }
-    else
+    
+    modulationMatrix.applyPendingRouting();
+    
+    const int numTicks = modulation.beginBlock(buffer.getNumSamples());
+    
+    // Synced LFOs lock to the transport at the block's first tick, which is
+    // where their phase stands. While stopped they run on at the tempo.
+    if (hostTransportRunning)
     {
-        // If not using input (100% wet), clear the buffer
-        buffer.clear();
+        const double samplesToFirstTick = modulation.getIntervalLength(0);
+        const double firstTickPosition = ppqPosition + samplesToFirstTick * bpm / (60.0 * getSampleRate());
+        
+        lfoGenerator.setHostPPQPosition(firstTickPosition);
+        lfoGenerator2.setHostPPQPosition(firstTickPosition);
     }
     
-    // Generate noise
-    noiseGenerator.processBlock(buffer, buffer.getNumSamples());
+    renderModulationSources(numTicks);
     
-    // Apply envelope - in MIDI_TRIGGER mode, only process if envelope is active
-    if (currentTriggerMode == FREE_RUN || currentTriggerMode == HOST_SYNC || envelopeGenerator.isActive())
+    const float* sourceValues[ModulationMatrix::NumSources];
+    float* destinationValues[ModulationMatrix::NumDestinations];
+    
+    for (int source = 0; source < ModulationMatrix::NumSources; ++source)
+        sourceValues[source] = modulation.getTickValues(source);
+    
+    for (int destination = 0; destination < ModulationMatrix::NumDestinations; ++destination)
+        destinationValues[destination] = modulation.getTickValues(firstDestinationLane + destination);
+    
+    modulationMatrix.process(sourceValues, destinationValues, numTicks);
+    
+    if (modulationMatrix.isDestinationUsed(ModulationMatrix::Volume))
     {
-        envelopeGenerator.processBlock(buffer, buffer.getNumSamples());
+        // Audio-rate gain of 1 + modulation / 2, ramped between ticks
+        lfoBuffer.setSize(1, buffer.getNumSamples(), false, false, true);
+        float* volumeGain = lfoBuffer.getWritePointer(0);
+        
+        modulation.renderRamp(firstDestinationLane + ModulationMatrix::Volume, volumeGain);
+        juce::FloatVectorOperations::multiply(volumeGain, 0.5f, buffer.getNumSamples());
+        juce::FloatVectorOperations::add(volumeGain, 1.0f, buffer.getNumSamples());
+        
+        for (int channel = 0; channel < buffer.getNumChannels(); ++channel)
+            juce::FloatVectorOperations::multiply(buffer.getWritePointer(channel), volumeGain, buffer.getNumSamples());
     }
-    else if (currentTriggerMode == MIDI_TRIGGER)
+    
+    // Switch oversampling factor if it was changed since the last block
+    if (oversampler.applyPendingFactor())
     {
-        // In MIDI trigger mode, if envelope is not active, clear the buffer
-        buffer.clear();
-        static int clearCount = 0;
-        if (++clearCount % 48000 == 0) {  // Log every ~1 second at 48kHz
-            DBG("MIDI_TRIGGER mode: Buffer cleared - envelope not active");
-        }
+        prepareNonlinearSection(currentBlockSize);
+        updateLatency();
     }
     
-    // Process LFO and apply modulation
-    for (int i = 0; i < buffer.getNumSamples(); ++i)
+    // Apply filter, drive and bitcrush inside the (optionally) oversampled section
     {
-        float lfoValue = lfoGenerator.processSample();
+        auto oversampledBuffer = oversampler.processSamplesUp(buffer, buffer.getNumSamples());
+        const int numOversampled = oversampledBuffer.getNumSamples();
         
-        // Apply LFO to target parameter
-        switch (lfoGenerator.getTarget())
+        if (crossfadeFilter)
         {
-            case LFOGenerator::Volume:
-                // Apply directly to each sample
-                for (int channel = 0; channel < buffer.getNumChannels(); ++channel)
-                {
-                    float* channelData = buffer.getWritePointer(channel);
-                    channelData[i] *= 0.5f + 0.5f * (1.0f + lfoValue);
-                }
-                break;
-                
-            case LFOGenerator::FilterCutoff:
-                // Apply to filter cutoff
-                filterProcessor.applyModulation(lfoValue);
-                break;
-                
-            case LFOGenerator::FilterResonance:
-                // Apply to filter resonance (but don't change the actual parameter)
-                // Instead, apply modulation to the filter directly
-                filterProcessor.applyResonanceModulation(lfoValue);
-                break;
-                
-            case LFOGenerator::Pitch:
-                // For noise, "pitch" modulation is not directly applicable
-                // Instead, we could alter the filter to create a pitch-like effect
-                // This is a simplification
-                filterProcessor.applyModulation(lfoValue * 0.5f);
-                break;
-                
-            case LFOGenerator::NumTargets:
-                // This is an enum bound and should not be used directly
-                break;
-                
-            default:
-                // Handle other cases or future additions
-                break;
+            // Mid-morph between two filter types, run the second on a copy
+            // and crossfade. Both see the same input, so linearly.
+            morphFilterBuffer.setSize(oversampledBuffer.getNumChannels(), numOversampled, false, false, true);
+            
+            for (int channel = 0; channel < oversampledBuffer.getNumChannels(); ++channel)
+                juce::FloatVectorOperations::copy(morphFilterBuffer.getWritePointer(channel),
+                                                  oversampledBuffer.getReadPointer(channel), numOversampled);
+            
+            juce::AudioBuffer<float> other(morphFilterBuffer.getArrayOfWritePointers(), oversampledBuffer.getNumChannels(),
+                                           0, numOversampled);
+            renderFilter(morphFilterProcessor, other);
+            renderFilter(filterProcessor, oversampledBuffer);
+            
+            for (int channel = 0; channel < oversampledBuffer.getNumChannels(); ++channel)
+            {
+                juce::FloatVectorOperations::multiply(oversampledBuffer.getWritePointer(channel),
+                                                      1.0f - appliedMorphPosition, numOversampled);
+                juce::FloatVectorOperations::addWithMultiply(oversampledBuffer.getWritePointer(channel),
+                                                             other.getReadPointer(channel), appliedMorphPosition,
+                                                             numOversampled);
+            }
+        }
+        else
+        {
+            renderFilter(filterProcessor, oversampledBuffer);
         }
+        
+        effectsProcessor.processNonlinearBlock(oversampledBuffer, oversampledBuffer.getNumSamples());
+        
+        oversampler.processSamplesDown(buffer, buffer.getNumSamples());
+    }
+    
+    modulation.endBlock();
+    
+    // Apply stereo width at the base rate
+    effectsProcessor.processStereoBlock(buffer, buffer.getNumSamples());
+    
+    // Apply the phaser
+    phaser.processBlock(buffer, buffer.getNumSamples());
+    
+    // Apply the compressor or tempo-synced ducking
+    if (compressor.applyPendingLatency())
+        updateLatency();
+    
+    compressor.processBlock(buffer, buffer.getNumSamples());
+    
+    // Apply the tempo-synced delay
+    stereoDelay.processBlock(buffer, buffer.getNumSamples());
+    
+    // Apply the selected reverb. A rebuilt convolution engine is swapped in
+    // whenever one is ready, so it's current if the type is switched back.
+    bool reverbLatencyChanged = convolutionReverb.applyPendingEngine();
+    
+    if (requestedReverbType != currentReverbType)
+    {
+        currentReverbType = requestedReverbType;
+        reverbLatencyChanged = true;
+        
+        if (currentReverbType == ALGORITHMIC_REVERB)
+            fdnReverb.reset();
     }
     
-    // Apply filter
-    filterProcessor.processBlock(buffer, buffer.getNumSamples());
+    if (reverbLatencyChanged)
+        updateLatency();
     
-    // Apply effects (drive, bitcrush, stereo width)
-    effectsProcessor.processBlock(buffer, buffer.getNumSamples());
+    if (currentReverbType == CONVOLUTION_REVERB)
+        convolutionReverb.processBlock(buffer, buffer.getNumSamples());
+    else
+        fdnReverb.processBlock(buffer, buffer.getNumSamples());
     
     // Apply output level
     buffer.applyGain(juce::Decibels::decibelsToGain(outputLevel));
@@ -338,28 +900,390 @@ void NoiseLabAudioProcessor::processBlock(juce::AudioBuffer<float>& buffer, juce
             }
         }
     }
+    
+    // True-peak safety limiter on the final output
+    if (limiter.applyPendingLatency())
+        updateLatency();
+    
+    limiter.processBlock(buffer, buffer.getNumSamples());
 }
 
-//==============================================================================
-juce::AudioProcessorEditor* NoiseLabAudioProcessor::createEditor()
+void NoiseLabAudioProcessor::handleMidiMessage(const juce::MidiMessage& message)
 {
-#if JUCE_HEADLESS
-    return nullptr;
-#else
-    return new NoiseLabAudioProcessorEditor(*this);
-#endif
+    if (message.isNoteOn())
+    {
+        DBG("MIDI Note On received: note=" << message.getNoteNumber() 
+            << ", velocity=" << message.getVelocity() 
+            << ", trigger_mode=" << static_cast<int>(currentTriggerMode));
+            
+        // Add to active notes, reusing the entry if the note is already held
+        MidiNote note;
+        note.noteNumber = message.getNoteNumber();
+        note.velocity = static_cast<int>(message.getVelocity());
+        note.isActive = true;
+        
+        auto existing = std::find_if(activeNotes.begin(), activeNotes.end(),
+                                     [&](const MidiNote& held) { return held.noteNumber == note.noteNumber; });
+        if (existing != activeNotes.end())
+            *existing = note;
+        else
+            activeNotes.push_back(note);
+        
+        // The modulation envelopes follow every note
+        const float noteVelocity = static_cast<float>(note.velocity) / 127.0f;
+        modulationEnvelope.noteOn(note.noteNumber, noteVelocity);
+        modulationMultiStageEnvelope.noteOn(note.noteNumber, noteVelocity);
+        
+        // Trigger envelope only in MIDI trigger mode
+        if (currentTriggerMode == MIDI_TRIGGER || currentTriggerMode == ONE_SHOT)
+        {
+            float velocityAsFloat = static_cast<float>(note.velocity) / 127.0f;
+            if (polyphonic)
+                voiceEngine.noteOn(note.noteNumber, velocityAsFloat);
+            else if (useMultiStageEnvelope)
+                multiStageEnvelope.noteOn(note.noteNumber, velocityAsFloat);
+            else
+                envelopeGenerator.noteOn(note.noteNumber, velocityAsFloat);
+            DBG("Triggered envelope: note=" << note.noteNumber << ", velocity=" << velocityAsFloat);
+        }
+        else
+        {
+            DBG("MIDI note received but trigger mode is " << static_cast<int>(currentTriggerMode) << " - not triggering envelope");
+        }
+    }
+    else if (message.isNoteOff())
+    {
+        DBG("MIDI Note Off received: note=" << message.getNoteNumber() 
+            << ", trigger_mode=" << static_cast<int>(currentTriggerMode));
+            
+        // Remove from active notes
+        activeNotes.erase(std::remove_if(activeNotes.begin(), activeNotes.end(),
+                                         [&](const MidiNote& held) { return held.noteNumber == message.getNoteNumber(); }),
+                          activeNotes.end());
+        
+        if (activeNotes.empty())
+        {
+            modulationEnvelope.noteOff(message.getNoteNumber());
+            modulationMultiStageEnvelope.noteOff(message.getNoteNumber());
+        }
+        
+        // Each voice releases on its own note
+        if (polyphonic && (currentTriggerMode == MIDI_TRIGGER || currentTriggerMode == ONE_SHOT))
+        {
+            voiceEngine.noteOff(message.getNoteNumber());
+        }
+        // If no active notes left, trigger envelope release
+        else if (activeNotes.empty())
+        {
+            if (currentTriggerMode == MIDI_TRIGGER || currentTriggerMode == ONE_SHOT)
+            {
+                if (useMultiStageEnvelope)
+                    multiStageEnvelope.noteOff(message.getNoteNumber());
+                else
+                    envelopeGenerator.noteOff(message.getNoteNumber());
+                DBG("Triggered envelope release: note=" << message.getNoteNumber());
+            }
+            else
+            {
+                DBG("Note off received but trigger mode is " << static_cast<int>(currentTriggerMode) << " - not releasing envelope");
+            }
+        }
+    }
+    else if (message.isAllNotesOff())
+    {
+        // Clear all notes
+        activeNotes.clear();
+        envelopeGenerator.reset();
+        multiStageEnvelope.reset();
+        modulationEnvelope.reset();
+        modulationMultiStageEnvelope.reset();
+        voiceEngine.allNotesOff();
+    }
 }
 
-bool NoiseLabAudioProcessor::hasEditor() const
+void NoiseLabAudioProcessor::applyPendingResets()
 {
-#if JUCE_HEADLESS
-    return false;
-#else
-    return true;
-#endif
+    const int resets = pendingResets.exchange(0);
+    
+    if ((resets & RESET_NOTES) != 0)
+    {
+        activeNotes.clear();
+        voiceEngine.allNotesOff();
+        modulationEnvelope.reset();
+        modulationMultiStageEnvelope.reset();
+    }
+    
+    if ((resets & RESET_ENVELOPES) != 0)
+    {
+        envelopeGenerator.reset();
+        multiStageEnvelope.reset();
+    }
+    
+    if ((resets & RETRIGGER_ENVELOPES) != 0)
+    {
+        envelopeGenerator.noteOn(60, 1.0f);
+        multiStageEnvelope.noteOn(60, 1.0f);
+    }
 }
 
-//==============================================================================
+void NoiseLabAudioProcessor::updateEnvelopeCopies()
+{
+    voiceEngine.setParameters(envelopeGenerator.getAttackTime(),
+                              envelopeGenerator.getDecayTime(),
+                              envelopeGenerator.getSustainLevel(),
+                              envelopeGenerator.getReleaseTime());
+    voiceEngine.setCurves(envelopeGenerator.getAttackCurve(),
+                          envelopeGenerator.getDecayCurve(),
+                          envelopeGenerator.getReleaseCurve());
+    
+    modulationEnvelope.setParameters(envelopeGenerator.getAttackTime(),
+                                     envelopeGenerator.getDecayTime(),
+                                     envelopeGenerator.getSustainLevel(),
+                                     envelopeGenerator.getReleaseTime());
+    modulationEnvelope.setCurves(envelopeGenerator.getAttackCurve(),
+                                 envelopeGenerator.getDecayCurve(),
+                                 envelopeGenerator.getReleaseCurve());
+}
+
+void NoiseLabAudioProcessor::prepareModulationSources(int samplesPerBlock)
+{
+    // The sources run at the control rate, one sample per tick. Sized for
+    // the shortest interval, so a new interval never reallocates.
+    const double controlRate = modulation.getControlRate();
+    const int ticksPerBlock = samplesPerBlock / ControlRateModulation::minInterval + 2;
+    
+    lfoGenerator.prepareToPlay(controlRate, ticksPerBlock);
+    lfoGenerator2.prepareToPlay(controlRate, ticksPerBlock);
+    randomModulator.prepareToPlay(controlRate, ticksPerBlock);
+    modulationEnvelope.prepareToPlay(controlRate, ticksPerBlock);
+    modulationMultiStageEnvelope.prepareToPlay(controlRate, ticksPerBlock);
+}
+
+void NoiseLabAudioProcessor::updateModulationSourceRates()
+{
+    // A new control interval on the audio thread: the sources carry on
+    // from where they are at the new rate
+    const double controlRate = modulation.getControlRate();
+    
+    lfoGenerator.setSampleRate(controlRate);
+    lfoGenerator2.setSampleRate(controlRate);
+    randomModulator.setSampleRate(controlRate);
+    modulationEnvelope.setSampleRate(controlRate);
+    modulationMultiStageEnvelope.setSampleRate(controlRate);
+}
+
+void NoiseLabAudioProcessor::renderModulationSources(int numTicks)
+{
+    if (modulationMatrix.isSourceUsed(ModulationMatrix::Lfo1))
+        lfoGenerator.processBlock(modulation.getTickValues(ModulationMatrix::Lfo1), numTicks);
+    
+    if (modulationMatrix.isSourceUsed(ModulationMatrix::Lfo2))
+        lfoGenerator2.processBlock(modulation.getTickValues(ModulationMatrix::Lfo2), numTicks);
+    
+    if (modulationMatrix.isSourceUsed(ModulationMatrix::Random))
+        randomModulator.processBlock(modulation.getTickValues(ModulationMatrix::Random), numTicks);
+    
+    // The envelopes apply their gain to a buffer, so render them onto ones.
+    // In free run they retrigger whenever they finish, like the source's.
+    if (modulationMatrix.isSourceUsed(ModulationMatrix::Envelope))
+    {
+        if (currentTriggerMode == FREE_RUN && modulationEnvelope.isIdle())
+            modulationEnvelope.noteOn(60, 1.0f);
+        
+        float* values = modulation.getTickValues(ModulationMatrix::Envelope);
+        juce::FloatVectorOperations::fill(values, 1.0f, numTicks);
+        juce::AudioBuffer<float> ticks(&values, 1, numTicks);
+        modulationEnvelope.processBlock(ticks, numTicks);
+    }
+    
+    if (modulationMatrix.isSourceUsed(ModulationMatrix::MultiStageEnvelope))
+    {
+        if (currentTriggerMode == FREE_RUN && modulationMultiStageEnvelope.isIdle())
+            modulationMultiStageEnvelope.noteOn(60, 1.0f);
+        
+        float* values = modulation.getTickValues(ModulationMatrix::MultiStageEnvelope);
+        juce::FloatVectorOperations::fill(values, 1.0f, numTicks);
+        juce::AudioBuffer<float> ticks(&values, 1, numTicks);
+        modulationMultiStageEnvelope.processBlock(ticks, numTicks);
+    }
+    
+    // The step playing at each tick
+    if (modulationMatrix.isSourceUsed(ModulationMatrix::Sequencer))
+        stepSequencer.renderFilterValues(modulation.getTickValues(ModulationMatrix::Sequencer),
+                                         modulation.getIntervalLength(0), modulation.getControlInterval(), numTicks);
+}
+
+void NoiseLabAudioProcessor::updateModulationSlot(int slot)
+{
+    const auto& parameters = modulationSlotParameters[slot];
+    const int source = static_cast<int>(parameters.source->load()) - 1;   // 0 is Off
+    const int destination = static_cast<int>(parameters.destination->load());
+    const float depth = parameters.depth->load();
+    
+    modulationMatrix.setSlot(slot, source, static_cast<ModulationMatrix::Destination>(destination), depth);
+}
+
+void NoiseLabAudioProcessor::updateLfoRoute()
+{
+    // Slot 0 is the LFO's own target. Pitch has no meaning for noise, so it
+    // moves the cutoff by half as much.
+    const auto target = static_cast<LFOGenerator::LFOTarget>(static_cast<int>(apvts.getRawParameterValue("lfoTarget")->load()));
+    const float depth = apvts.getRawParameterValue("lfoDepth")->load();
+    
+    switch (target)
+    {
+        case LFOGenerator::Volume:
+            modulationMatrix.setSlot(0, ModulationMatrix::Lfo1, ModulationMatrix::Volume, depth);
+            break;
+            
+        case LFOGenerator::FilterResonance:
+            modulationMatrix.setSlot(0, ModulationMatrix::Lfo1, ModulationMatrix::FilterResonance, depth);
+            break;
+            
+        case LFOGenerator::Pitch:
+            modulationMatrix.setSlot(0, ModulationMatrix::Lfo1, ModulationMatrix::FilterCutoff, depth * 0.5f);
+            break;
+            
+        case LFOGenerator::FilterCutoff:
+        case LFOGenerator::NumTargets:
+        default:
+            modulationMatrix.setSlot(0, ModulationMatrix::Lfo1, ModulationMatrix::FilterCutoff, depth);
+            break;
+    }
+}
+
+void NoiseLabAudioProcessor::renderSourceWithTriggers(juce::AudioBuffer<float>& buffer, int startSample, int numSamples)
+{
+    const int endSample = startSample + numSamples;
+    
+    // Split at each grid point in the range
+    while (nextGridTrigger < numGridTriggers && beatGridScheduler.getTriggerOffset(nextGridTrigger) < endSample)
+    {
+        const int triggerSample = juce::jmax(startSample, beatGridScheduler.getTriggerOffset(nextGridTrigger));
+        
+        if (triggerSample > startSample)
+        {
+            renderSource(buffer, startSample, triggerSample - startSample);
+            startSample = triggerSample;
+        }
+        
+        triggerGridNote();
+        ++nextGridTrigger;
+    }
+    
+    if (endSample > startSample)
+        renderSource(buffer, startSample, endSample - startSample);
+}
+
+void NoiseLabAudioProcessor::triggerGridNote()
+{
+    if (useMultiStageEnvelope)
+        multiStageEnvelope.noteOn(60, 1.0f);
+    else
+        envelopeGenerator.noteOn(60, 1.0f);
+    
+    modulationEnvelope.noteOn(60, 1.0f);
+    modulationMultiStageEnvelope.noteOn(60, 1.0f);
+}
+
+void NoiseLabAudioProcessor::releaseGridNote()
+{
+    multiStageEnvelope.noteOff(60);
+    envelopeGenerator.noteOff(60);
+    modulationEnvelope.noteOff(60);
+    modulationMultiStageEnvelope.noteOff(60);
+}
+
+void NoiseLabAudioProcessor::renderSource(juce::AudioBuffer<float>& buffer, int startSample, int numSamples)
+{
+    // Refers to the range in place, without allocating
+    juce::AudioBuffer<float> source(buffer.getArrayOfWritePointers(), buffer.getNumChannels(), startSample, numSamples);
+    
+    if (polyphonic && (currentTriggerMode == MIDI_TRIGGER || currentTriggerMode == ONE_SHOT))
+    {
+        voiceEngine.renderBlock(source, numSamples);
+        return;
+    }
+    
+    // Handle FREE_RUN mode - continuously trigger envelope if needed
+    if (currentTriggerMode == FREE_RUN)
+    {
+        // Check if envelope is idle and needs retriggering
+        if (useMultiStageEnvelope && multiStageEnvelope.isIdle())
+        {
+            multiStageEnvelope.noteOn(60, 1.0f);
+        }
+        else if (!useMultiStageEnvelope && envelopeGenerator.isIdle())
+        {
+            envelopeGenerator.noteOn(60, 1.0f);  // Trigger with middle C, full velocity
+            static int triggerCount = 0;
+            if (++triggerCount % 100 == 0) {  // Throttle debug output
+                DBG("FREE_RUN: Auto-retriggered envelope (count: " << triggerCount << ")");
+            }
+        }
+    }
+    
+    // Generate noise
+    noiseGenerator.processBlock(source, numSamples);
+    
+    // Mid-morph between two noise types, mix in the second. The two are
+    // uncorrelated, so the crossfade is equal-power.
+    if (crossfadeNoise)
+    {
+        juce::AudioBuffer<float> other(morphNoiseBuffer.getArrayOfWritePointers(), source.getNumChannels(), 0, numSamples);
+        morphNoiseGenerator.processBlock(other, numSamples);
+        
+        const float angle = appliedMorphPosition * juce::MathConstants<float>::halfPi;
+        
+        for (int channel = 0; channel < source.getNumChannels(); ++channel)
+        {
+            juce::FloatVectorOperations::multiply(source.getWritePointer(channel), std::cos(angle), numSamples);
+            juce::FloatVectorOperations::addWithMultiply(source.getWritePointer(channel), other.getReadPointer(channel),
+                                                         std::sin(angle), numSamples);
+        }
+    }
+    
+    // Apply envelope - in MIDI_TRIGGER mode, only process if envelope is active
+    const bool envelopeActive = useMultiStageEnvelope ? multiStageEnvelope.isActive() : envelopeGenerator.isActive();
+    
+    if (currentTriggerMode == FREE_RUN || currentTriggerMode == HOST_SYNC || envelopeActive)
+    {
+        if (useMultiStageEnvelope)
+            multiStageEnvelope.processBlock(source, numSamples);
+        else
+            envelopeGenerator.processBlock(source, numSamples);
+    }
+    else if (currentTriggerMode == MIDI_TRIGGER)
+    {
+        // In MIDI trigger mode, if envelope is not active, clear the buffer
+        source.clear();
+        static int clearCount = 0;
+        if (++clearCount % 48000 == 0) {  // Log every ~1 second at 48kHz
+            DBG("MIDI_TRIGGER mode: Buffer cleared - envelope not active");
+        }
+    }
+}
+
+//==============================================================================
+juce::AudioProcessorEditor* NoiseLabAudioProcessor::createEditor()
+{
+#if JUCE_HEADLESS
+    return nullptr;
+#else
+    return new NoiseLabAudioProcessorEditor(*this);
+#endif
+}
+
+bool NoiseLabAudioProcessor::hasEditor() const
+{
+#if JUCE_HEADLESS
+    return false;
+#else
+    return true;
+#endif
+}
+
+//==============================================================================
 const juce::String NoiseLabAudioProcessor::getName() const
 {
     return JucePlugin_Name;
@@ -382,7 +1306,15 @@ bool NoiseLabAudioProcessor::isMidiEffect() const
 
 double NoiseLabAudioProcessor::getTailLengthSeconds() const
 {
-    return 0.0;
+    // The delay feeds the reverb, so their tails add up
+    double reverbTail = 0.0;
+    
+    if (currentReverbType == ALGORITHMIC_REVERB)
+        reverbTail = fdnReverb.getMix() > 0.0f ? fdnReverb.getDecay() : 0.0;
+    else
+        reverbTail = convolutionReverb.getMix() > 0.0f ? convolutionReverb.getTailLengthSeconds() : 0.0;
+    
+    return stereoDelay.getTailLengthSeconds() + reverbTail;
 }
 
 //==============================================================================
@@ -429,16 +1361,236 @@ void NoiseLabAudioProcessor::setStateInformation(const void* data, int sizeInByt
     if (xmlState != nullptr && xmlState->hasTagName(apvts.state.getType()))
     {
         apvts.replaceState(juce::ValueTree::fromXml(*xmlState));
+        
+        // Reload the reverb's impulse response, if one was saved
+        const juce::String impulseResponsePath = apvts.state.getProperty("impulseResponseFile").toString();
+        
+        if (impulseResponsePath.isNotEmpty())
+            loadImpulseResponse(juce::File(impulseResponsePath));
+        
+        restoreEnvelopeShape();
+        restoreSequencerPattern();
+        restoreMorphSnapshots();
+    }
+}
+
+void NoiseLabAudioProcessor::setEnvelopeShape(const juce::Array<MultiStageEnvelope::Segment>& segments, int loopStart, int loopEnd)
+{
+    multiStageEnvelope.setShape(segments.getRawDataPointer(), segments.size(), loopStart, loopEnd);
+    modulationMultiStageEnvelope.setShape(segments.getRawDataPointer(), segments.size(), loopStart, loopEnd);
+    
+    // Keep the breakpoints in the state, replacing the previous shape
+    apvts.state.removeChild(apvts.state.getChildWithName("envelopeShape"), nullptr);
+    
+    juce::ValueTree shape("envelopeShape");
+    shape.setProperty("loopStart", loopStart, nullptr);
+    shape.setProperty("loopEnd", loopEnd, nullptr);
+    
+    for (const auto& segment : segments)
+    {
+        juce::ValueTree point("segment");
+        point.setProperty("level", segment.level, nullptr);
+        point.setProperty("time", segment.timeMs, nullptr);
+        point.setProperty("curve", segment.curve, nullptr);
+        shape.addChild(point, -1, nullptr);
+    }
+    
+    apvts.state.addChild(shape, -1, nullptr);
+}
+
+void NoiseLabAudioProcessor::restoreEnvelopeShape()
+{
+    const juce::ValueTree shape = apvts.state.getChildWithName("envelopeShape");
+    if (!shape.isValid())
+        return;
+    
+    MultiStageEnvelope::Segment segments[MultiStageEnvelope::maxSegments];
+    const int numSegments = juce::jmin(shape.getNumChildren(), MultiStageEnvelope::maxSegments);
+    
+    for (int i = 0; i < numSegments; ++i)
+    {
+        const juce::ValueTree point = shape.getChild(i);
+        segments[i].level = point.getProperty("level");
+        segments[i].timeMs = point.getProperty("time");
+        segments[i].curve = point.getProperty("curve");
+    }
+    
+    if (numSegments > 0)
+    {
+        multiStageEnvelope.setShape(segments, numSegments, shape.getProperty("loopStart"), shape.getProperty("loopEnd"));
+        modulationMultiStageEnvelope.setShape(segments, numSegments, shape.getProperty("loopStart"), shape.getProperty("loopEnd"));
+    }
+}
+
+void NoiseLabAudioProcessor::setSequencerStep(int index, bool gate, float velocity, float filter)
+{
+    if (index < 0 || index >= StepSequencer::maxSteps)
+        return;
+    
+    stepSequencer.setStep(index, gate, velocity, filter);
+    
+    // Keep the whole pattern in the state, created from the sequencer's
+    // current steps the first time one is edited
+    juce::ValueTree pattern = apvts.state.getChildWithName("sequencerPattern");
+    
+    if (!pattern.isValid())
+    {
+        pattern = juce::ValueTree("sequencerPattern");
+        
+        for (int i = 0; i < StepSequencer::maxSteps; ++i)
+        {
+            juce::ValueTree step("step");
+            step.setProperty("gate", stepSequencer.getStepGate(i), nullptr);
+            step.setProperty("velocity", stepSequencer.getStepVelocity(i), nullptr);
+            step.setProperty("filter", stepSequencer.getStepFilter(i), nullptr);
+            pattern.addChild(step, -1, nullptr);
+        }
+        
+        apvts.state.addChild(pattern, -1, nullptr);
+    }
+    
+    juce::ValueTree step = pattern.getChild(index);
+    step.setProperty("gate", gate, nullptr);
+    step.setProperty("velocity", stepSequencer.getStepVelocity(index), nullptr);
+    step.setProperty("filter", stepSequencer.getStepFilter(index), nullptr);
+}
+
+void NoiseLabAudioProcessor::restoreSequencerPattern()
+{
+    const juce::ValueTree pattern = apvts.state.getChildWithName("sequencerPattern");
+    if (!pattern.isValid())
+        return;
+    
+    const int numSteps = juce::jmin(pattern.getNumChildren(), StepSequencer::maxSteps);
+    
+    for (int i = 0; i < numSteps; ++i)
+    {
+        const juce::ValueTree step = pattern.getChild(i);
+        stepSequencer.setStep(i, step.getProperty("gate"), step.getProperty("velocity"), step.getProperty("filter"));
     }
 }
 
+void NoiseLabAudioProcessor::storeMorphSnapshot(int slot)
+{
+    if (slot < 0 || slot > 1)
+        return;
+    
+    // Take the parameters' current values, and keep them in the state
+    juce::ValueTree morph = apvts.state.getOrCreateChildWithName("presetMorph", nullptr);
+    juce::ValueTree snapshot = morph.getOrCreateChildWithName(slot == 0 ? "snapshotA" : "snapshotB", nullptr);
+    
+    float values[PresetMorph::NumTargets];
+    
+    for (int index = 0; index < PresetMorph::NumTargets; ++index)
+    {
+        const char* parameterID = PresetMorph::getParameterID(static_cast<PresetMorph::Target>(index));
+        values[index] = morphParameters[index]->load();
+        snapshot.setProperty(parameterID, values[index], nullptr);
+    }
+    
+    setMorphSnapshot(slot, values);
+}
+
+void NoiseLabAudioProcessor::setMorphSnapshot(int slot, const float* values)
+{
+    // The drive curves for both snapshots are baked here, before the
+    // snapshot is published, so the audio thread never bakes mid-morph
+    const float otherDrive = presetMorph.getSnapshotValue(1 - slot, PresetMorph::Drive);
+    const float drive = values[PresetMorph::Drive];
+    
+    effectsProcessor.setMorphDrives(slot == 0 ? drive : otherDrive, slot == 0 ? otherDrive : drive);
+    presetMorph.setSnapshot(slot, values);
+}
+
+void NoiseLabAudioProcessor::clearMorphSnapshots()
+{
+    apvts.state.removeChild(apvts.state.getChildWithName("presetMorph"), nullptr);
+    presetMorph.clearSnapshots();
+}
+
+void NoiseLabAudioProcessor::restoreMorphSnapshots()
+{
+    presetMorph.clearSnapshots();
+    
+    const juce::ValueTree morph = apvts.state.getChildWithName("presetMorph");
+    if (!morph.isValid())
+        return;
+    
+    for (int slot = 0; slot < 2; ++slot)
+    {
+        const juce::ValueTree snapshot = morph.getChildWithName(slot == 0 ? "snapshotA" : "snapshotB");
+        if (!snapshot.isValid())
+            continue;
+        
+        // Parameters missing from an older snapshot keep their current value
+        float values[PresetMorph::NumTargets];
+        
+        for (int index = 0; index < PresetMorph::NumTargets; ++index)
+        {
+            const char* parameterID = PresetMorph::getParameterID(static_cast<PresetMorph::Target>(index));
+            values[index] = snapshot.getProperty(parameterID, morphParameters[index]->load());
+        }
+        
+        setMorphSnapshot(slot, values);
+    }
+}
+
+bool NoiseLabAudioProcessor::loadImpulseResponse(const juce::File& file)
+{
+    juce::AudioFormatManager formatManager;
+    formatManager.registerBasicFormats();
+    
+    std::unique_ptr<juce::AudioFormatReader> reader(formatManager.createReaderFor(file));
+    
+    if (reader == nullptr)
+    {
+        // Revert to the synthetic IR
+        convolutionReverb.loadImpulseResponse(juce::AudioBuffer<float>(), currentSampleRate);
+        apvts.state.removeProperty("impulseResponseFile", nullptr);
+        return false;
+    }
+    
+    // Only the first two channels are used, and at most 10 seconds
+    const int numChannels = juce::jmin(static_cast<int>(reader->numChannels), 2);
+    const int numSamples = static_cast<int>(juce::jmin(reader->lengthInSamples,
+                                                       static_cast<juce::int64>(reader->sampleRate * 10.0)));
+    
+    juce::AudioBuffer<float> impulseResponse(numChannels, numSamples);
+    reader->read(&impulseResponse, 0, numSamples, 0, true, numChannels > 1);
+    
+    convolutionReverb.loadImpulseResponse(impulseResponse, reader->sampleRate);
+    apvts.state.setProperty("impulseResponseFile", file.getFullPathName(), nullptr);
+    return true;
+}
+
 //==============================================================================
 void NoiseLabAudioProcessor::parameterChanged(const juce::String& parameterID, float newValue)
 {
+    // The preset morph owns its targets while both snapshots are stored.
+    // They return to their parameters' values when the morph ends, which
+    // for the drive needs its curve table baked here.
+    if (presetMorph.hasBothSnapshots() && PresetMorph::isTargetParameter(parameterID))
+    {
+        if (parameterID == "drive")
+            effectsProcessor.setParameterDrive(newValue);
+        
+        return;
+    }
+    
     if (parameterID == "noiseType")
     {
         noiseGenerator.setNoiseType(static_cast<NoiseGenerator::NoiseType>(static_cast<int>(newValue)));
     }
+    else if (parameterID == "stereoMode")
+    {
+        noiseGenerator.setStereoMode(static_cast<NoiseGenerator::StereoMode>(static_cast<int>(newValue)));
+        morphNoiseGenerator.setStereoMode(static_cast<NoiseGenerator::StereoMode>(static_cast<int>(newValue)));
+    }
+    else if (parameterID == "stereoDecorrelation")
+    {
+        noiseGenerator.setDecorrelation(newValue);
+        morphNoiseGenerator.setDecorrelation(newValue);
+    }
     else if (parameterID == "triggerMode")
     {
         currentTriggerMode = static_cast<TriggerMode>(static_cast<int>(newValue));
@@ -447,22 +1599,52 @@ void NoiseLabAudioProcessor::parameterChanged(const juce::String& parameterID, f
         
         // Configure envelope based on trigger mode
         envelopeGenerator.setOneShot(currentTriggerMode == ONE_SHOT);
+        voiceEngine.setOneShot(currentTriggerMode == ONE_SHOT);
+        multiStageEnvelope.setOneShot(currentTriggerMode == ONE_SHOT);
+        modulationEnvelope.setOneShot(currentTriggerMode == ONE_SHOT);
+        modulationMultiStageEnvelope.setOneShot(currentTriggerMode == ONE_SHOT);
         
         // For free-run mode, trigger envelope immediately
         if (currentTriggerMode == FREE_RUN)
         {
             DBG("Setting FREE_RUN mode - triggering envelope");
-            envelopeGenerator.noteOn(60, 1.0f); // Trigger with full velocity
+            pendingResets.fetch_or(RETRIGGER_ENVELOPES); // Trigger with full velocity
         }
         else if (currentTriggerMode == MIDI_TRIGGER)
         {
             DBG("Setting MIDI_TRIGGER mode - resetting envelope to Idle");
-            // Reset envelope for MIDI mode - it will only trigger on MIDI notes
-            envelopeGenerator.reset();
-            // Clear any active notes when switching to MIDI trigger mode
-            activeNotes.clear();
+            // Reset envelope for MIDI mode - it will only trigger on MIDI
+            // notes - and clear any active notes, at the next block
+            pendingResets.fetch_or(RESET_NOTES | RESET_ENVELOPES);
         }
     }
+    else if (parameterID == "syncGrid")
+    {
+        beatGridScheduler.setGrid(static_cast<BeatGridScheduler::Grid>(static_cast<int>(newValue)));
+    }
+    else if (parameterID == "syncOffset")
+    {
+        beatGridScheduler.setOffset(newValue);
+    }
+    else if (parameterID == "syncSwing")
+    {
+        beatGridScheduler.setSwing(newValue);
+    }
+    else if (parameterID == "voiceMode")
+    {
+        polyphonic = static_cast<int>(newValue) == 1;
+        
+        // Notes held in the other mode would never be released
+        pendingResets.fetch_or(RESET_NOTES | RESET_ENVELOPES);
+    }
+    else if (parameterID == "envelopeMode")
+    {
+        useMultiStageEnvelope = static_cast<int>(newValue) == 1;
+        
+        // Start the newly selected envelope the way the trigger mode would
+        pendingResets.fetch_or(currentTriggerMode == FREE_RUN ? RESET_ENVELOPES | RETRIGGER_ENVELOPES
+                                                              : RESET_ENVELOPES);
+    }
     else if (parameterID == "attack")
     {
         envelopeGenerator.setParameters(
@@ -471,73 +1653,319 @@ void NoiseLabAudioProcessor::parameterChanged(const juce::String& parameterID, f
             envelopeGenerator.getSustainLevel(),
             envelopeGenerator.getReleaseTime()
         );
+        updateEnvelopeCopies();
+    }
+    else if (parameterID == "decay")
+    {
+        envelopeGenerator.setParameters(
+            envelopeGenerator.getAttackTime(),
+            newValue,
+            envelopeGenerator.getSustainLevel(),
+            envelopeGenerator.getReleaseTime()
+        );
+        updateEnvelopeCopies();
+    }
+    else if (parameterID == "sustain")
+    {
+        envelopeGenerator.setParameters(
+            envelopeGenerator.getAttackTime(),
+            envelopeGenerator.getDecayTime(),
+            newValue,
+            envelopeGenerator.getReleaseTime()
+        );
+        updateEnvelopeCopies();
+    }
+    else if (parameterID == "release")
+    {
+        envelopeGenerator.setParameters(
+            envelopeGenerator.getAttackTime(),
+            envelopeGenerator.getDecayTime(),
+            envelopeGenerator.getSustainLevel(),
+            newValue
+        );
+        updateEnvelopeCopies();
+    }
+    else if (parameterID == "attackCurve")
+    {
+        envelopeGenerator.setCurves(
+            newValue,
+            envelopeGenerator.getDecayCurve(),
+            envelopeGenerator.getReleaseCurve()
+        );
+        updateEnvelopeCopies();
+    }
+    else if (parameterID == "decayCurve")
+    {
+        envelopeGenerator.setCurves(
+            envelopeGenerator.getAttackCurve(),
+            newValue,
+            envelopeGenerator.getReleaseCurve()
+        );
+        updateEnvelopeCopies();
+    }
+    else if (parameterID == "releaseCurve")
+    {
+        envelopeGenerator.setCurves(
+            envelopeGenerator.getAttackCurve(),
+            envelopeGenerator.getDecayCurve(),
+            newValue
+        );
+        updateEnvelopeCopies();
+    }
+    else if (parameterID == "lfoRate")
+    {
+        lfoGenerator.setRate(newValue);
+    }
+    else if (parameterID == "lfoDepth")
+    {
+        updateLfoRoute();
+    }
+    else if (parameterID == "lfoSync")
+    {
+        lfoGenerator.setSyncToHost(newValue >= 0.5f);
+    }
+    else if (parameterID == "lfoDivision")
+    {
+        lfoGenerator.setSyncDivision(static_cast<LFOGenerator::SyncDivision>(static_cast<int>(newValue)));
+    }
+    else if (parameterID == "lfoTarget")
+    {
+        lfoGenerator.setTarget(static_cast<LFOGenerator::LFOTarget>(static_cast<int>(newValue)));
+        updateLfoRoute();
+    }
+    else if (parameterID == "lfoShape")
+    {
+        lfoGenerator.setShape(static_cast<LFOGenerator::LFOShape>(static_cast<int>(newValue)));
+    }
+    else if (parameterID == "lfo2Rate")
+    {
+        lfoGenerator2.setRate(newValue);
+    }
+    else if (parameterID == "lfo2Sync")
+    {
+        lfoGenerator2.setSyncToHost(newValue >= 0.5f);
+    }
+    else if (parameterID == "lfo2Division")
+    {
+        lfoGenerator2.setSyncDivision(static_cast<LFOGenerator::SyncDivision>(static_cast<int>(newValue)));
+    }
+    else if (parameterID == "lfo2Shape")
+    {
+        lfoGenerator2.setShape(static_cast<LFOGenerator::LFOShape>(static_cast<int>(newValue)));
+    }
+    else if (parameterID == "randomMode")
+    {
+        randomModulator.setMode(static_cast<RandomModulator::Mode>(static_cast<int>(newValue)));
+    }
+    else if (parameterID == "randomRate")
+    {
+        randomModulator.setRate(newValue);
+    }
+    else if (parameterID == "randomSeed")
+    {
+        randomModulator.setSeed(static_cast<int>(newValue));
+    }
+    else if (parameterID.startsWith("mod"))
+    {
+        // Compared against the cached IDs, so automation on the audio
+        // thread doesn't build strings
+        for (int slot = 1; slot <= numModulationSlots; ++slot)
+        {
+            const auto& parameters = modulationSlotParameters[slot];
+            
+            if (parameterID == parameters.sourceID || parameterID == parameters.destinationID
+                || parameterID == parameters.depthID)
+                updateModulationSlot(slot);
+        }
+    }
+    else if (parameterID == "seqEnabled")
+    {
+        sequencerEnabled = newValue >= 0.5f;
+    }
+    else if (parameterID == "seqSteps")
+    {
+        stepSequencer.setNumSteps(StepSequencer::minSteps * (1 + static_cast<int>(newValue)));
+    }
+    else if (parameterID == "seqDivision")
+    {
+        stepSequencer.setStepDivision(static_cast<LFOGenerator::SyncDivision>(static_cast<int>(newValue)));
+    }
+    else if (parameterID == "seqGate")
+    {
+        stepSequencer.setGateLength(newValue);
+    }
+    else if (parameterID == "controlInterval")
+    {
+        // Applied at the start of the next block
+        requestedControlInterval = 16 << juce::jlimit(0, 2, static_cast<int>(newValue));
+    }
+    else if (parameterID == "filterType")
+    {
+        filterProcessor.setFilterType(static_cast<FilterProcessor::FilterType>(static_cast<int>(newValue)));
+    }
+    else if (parameterID == "cutoff")
+    {
+        filterProcessor.setCutoffFrequency(newValue);
+        morphFilterProcessor.setCutoffFrequency(newValue);
+    }
+    else if (parameterID == "resonance")
+    {
+        filterProcessor.setResonance(newValue);
+        morphFilterProcessor.setResonance(newValue);
+    }
+    else if (parameterID == "drive")
+    {
+        effectsProcessor.setDrive(newValue);
+    }
+    else if (parameterID == "driveMode")
+    {
+        effectsProcessor.setDriveMode(static_cast<EffectsProcessor::DriveMode>(static_cast<int>(newValue)));
+    }
+    else if (parameterID == "driveCurve")
+    {
+        effectsProcessor.setDriveCurve(static_cast<Waveshaper::Curve>(static_cast<int>(newValue)));
+    }
+    else if (parameterID == "bitcrush")
+    {
+        effectsProcessor.setBitcrush(newValue);
+    }
+    else if (parameterID == "crushRate")
+    {
+        effectsProcessor.setCrushRate(newValue);
+    }
+    else if (parameterID == "width")
+    {
+        effectsProcessor.setStereoWidth(newValue);
+    }
+    else if (parameterID == "oversampling")
+    {
+        oversampler.setFactor(static_cast<Oversampler::Factor>(static_cast<int>(newValue)));
+    }
+    else if (parameterID == "phaserMix")
+    {
+        phaser.setMix(newValue);
+    }
+    else if (parameterID == "phaserStages")
+    {
+        phaser.setStages(Phaser::minStages + 2 * static_cast<int>(newValue));
+    }
+    else if (parameterID == "phaserRate")
+    {
+        phaser.setRate(newValue);
+    }
+    else if (parameterID == "phaserDepth")
+    {
+        phaser.setDepth(newValue);
+    }
+    else if (parameterID == "phaserFeedback")
+    {
+        phaser.setFeedback(newValue);
+    }
+    else if (parameterID == "phaserStereo")
+    {
+        phaser.setStereoPhase(newValue);
+    }
+    else if (parameterID == "compMode")
+    {
+        compressor.setMode(static_cast<Compressor::Mode>(static_cast<int>(newValue)));
+    }
+    else if (parameterID == "compThreshold")
+    {
+        compressor.setThreshold(newValue);
+    }
+    else if (parameterID == "compRatio")
+    {
+        compressor.setRatio(newValue);
+    }
+    else if (parameterID == "compAttack")
+    {
+        compressor.setAttack(newValue);
+    }
+    else if (parameterID == "compRelease")
+    {
+        compressor.setRelease(newValue);
+    }
+    else if (parameterID == "compLookahead")
+    {
+        compressor.setLookahead(newValue);
+    }
+    else if (parameterID == "compMakeup")
+    {
+        compressor.setMakeupGain(newValue);
+    }
+    else if (parameterID == "duckDivision")
+    {
+        compressor.setDuckDivision(static_cast<Compressor::DuckDivision>(static_cast<int>(newValue)));
+    }
+    else if (parameterID == "duckDepth")
+    {
+        compressor.setDuckDepth(newValue);
+    }
+    else if (parameterID == "delayMix")
+    {
+        stereoDelay.setMix(newValue);
     }
-    else if (parameterID == "decay")
+    else if (parameterID == "delayDivision")
     {
-        envelopeGenerator.setParameters(
-            envelopeGenerator.getAttackTime(),
-            newValue,
-            envelopeGenerator.getSustainLevel(),
-            envelopeGenerator.getReleaseTime()
-        );
+        stereoDelay.setDivision(static_cast<StereoDelay::Division>(static_cast<int>(newValue)));
     }
-    else if (parameterID == "sustain")
+    else if (parameterID == "delayFeedback")
     {
-        envelopeGenerator.setParameters(
-            envelopeGenerator.getAttackTime(),
-            envelopeGenerator.getDecayTime(),
-            newValue,
-            envelopeGenerator.getReleaseTime()
-        );
+        stereoDelay.setFeedback(newValue);
     }
-    else if (parameterID == "release")
+    else if (parameterID == "delayPingPong")
     {
-        envelopeGenerator.setParameters(
-            envelopeGenerator.getAttackTime(),
-            envelopeGenerator.getDecayTime(),
-            envelopeGenerator.getSustainLevel(),
-            newValue
-        );
+        stereoDelay.setPingPong(newValue >= 0.5f);
     }
-    else if (parameterID == "lfoRate")
+    else if (parameterID == "delayLowCut")
     {
-        lfoGenerator.setRate(newValue);
+        stereoDelay.setLowCut(newValue);
     }
-    else if (parameterID == "lfoDepth")
+    else if (parameterID == "delayHighCut")
     {
-        lfoGenerator.setDepth(newValue);
+        stereoDelay.setHighCut(newValue);
     }
-    else if (parameterID == "lfoSync")
+    else if (parameterID == "reverbType")
     {
-        lfoGenerator.setSyncToHost(newValue >= 0.5f);
+        requestedReverbType = static_cast<int>(newValue) == 0 ? CONVOLUTION_REVERB : ALGORITHMIC_REVERB;
     }
-    else if (parameterID == "lfoTarget")
+    else if (parameterID == "reverbMix")
     {
-        lfoGenerator.setTarget(static_cast<LFOGenerator::LFOTarget>(static_cast<int>(newValue)));
+        convolutionReverb.setMix(newValue);
+        fdnReverb.setMix(newValue);
     }
-    else if (parameterID == "filterType")
+    else if (parameterID == "reverbDecay")
     {
-        filterProcessor.setFilterType(static_cast<FilterProcessor::FilterType>(static_cast<int>(newValue)));
+        convolutionReverb.setDecay(newValue);
+        fdnReverb.setDecay(newValue);
     }
-    else if (parameterID == "cutoff")
+    else if (parameterID == "reverbDamping")
     {
-        filterProcessor.setCutoffFrequency(newValue);
+        fdnReverb.setDamping(newValue);
     }
-    else if (parameterID == "resonance")
+    else if (parameterID == "reverbSize")
     {
-        filterProcessor.setResonance(newValue);
+        fdnReverb.setSize(newValue);
     }
-    else if (parameterID == "drive")
+    else if (parameterID == "reverbHeadSize")
     {
-        effectsProcessor.setDrive(newValue);
+        convolutionReverb.setHeadSize(ConvolutionReverb::minHeadSize << static_cast<int>(newValue));
     }
-    else if (parameterID == "bitcrush")
+    else if (parameterID == "reverbHeadMode")
     {
-        effectsProcessor.setBitcrush(newValue);
+        convolutionReverb.setHeadMode(static_cast<ConvolutionReverb::HeadMode>(static_cast<int>(newValue)));
     }
-    else if (parameterID == "width")
+    else if (parameterID == "limiter")
     {
-        effectsProcessor.setStereoWidth(newValue);
+        limiter.setEnabled(newValue >= 0.5f);
+    }
+    else if (parameterID == "limiterCeiling")
+    {
+        limiter.setCeiling(newValue);
+    }
+    else if (parameterID == "limiterRelease")
+    {
+        limiter.setRelease(newValue);
     }
     else if (parameterID == "output")
     {
@@ -547,6 +1975,11 @@ void NoiseLabAudioProcessor::parameterChanged(const juce::String& parameterID, f
     {
         dryWetMix = newValue;
     }
+    else if (parameterID == "morph")
+    {
+        // Applied at the start of the next block
+        morphPosition = newValue;
+    }
 }
 
 //==============================================================================
@@ -562,6 +1995,21 @@ juce::AudioProcessorValueTreeState::ParameterLayout NoiseLabAudioProcessor::crea
         0  // default to White Noise
     ));
     
+    // Stereo generation
+    params.add(std::make_unique<juce::AudioParameterChoice>(
+        "stereoMode",
+        "Stereo Mode",
+        juce::StringArray({"Independent", "Decorrelated"}),
+        0  // default to Independent
+    ));
+    
+    params.add(std::make_unique<juce::AudioParameterFloat>(
+        "stereoDecorrelation",
+        "Decorrelation",
+        juce::NormalisableRange<float>(0.0f, 1.0f, 0.01f),
+        1.0f  // default (fully uncorrelated)
+    ));
+    
     // Trigger Mode
     params.add(std::make_unique<juce::AudioParameterChoice>(
         "triggerMode",
@@ -570,6 +2018,42 @@ juce::AudioProcessorValueTreeState::ParameterLayout NoiseLabAudioProcessor::crea
         1  // default to MIDI Trigger
     ));
     
+    // Host sync retrigger grid
+    params.add(std::make_unique<juce::AudioParameterChoice>(
+        "syncGrid",
+        "Sync Grid",
+        juce::StringArray({"Bar", "Beat", "1/8", "1/16"}),
+        1  // default to Beat
+    ));
+    
+    params.add(std::make_unique<juce::AudioParameterFloat>(
+        "syncOffset",
+        "Sync Offset",
+        juce::NormalisableRange<float>(0.0f, 1.0f, 0.01f),  // fraction of a grid step
+        0.0f  // default
+    ));
+    
+    params.add(std::make_unique<juce::AudioParameterFloat>(
+        "syncSwing",
+        "Sync Swing",
+        juce::NormalisableRange<float>(0.0f, 1.0f, 0.01f),
+        0.0f  // default
+    ));
+    
+    params.add(std::make_unique<juce::AudioParameterChoice>(
+        "voiceMode",
+        "Voice Mode",
+        juce::StringArray({"Mono", "Poly"}),
+        0  // default to Mono
+    ));
+    
+    params.add(std::make_unique<juce::AudioParameterChoice>(
+        "envelopeMode",
+        "Envelope Mode",
+        juce::StringArray({"ADSR", "Multi-Stage"}),
+        0  // default to ADSR
+    ));
+    
     // Envelope
     params.add(std::make_unique<juce::AudioParameterFloat>(
         "attack",
@@ -599,6 +2083,27 @@ juce::AudioProcessorValueTreeState::ParameterLayout NoiseLabAudioProcessor::crea
         500.0f  // default
     ));
     
+    params.add(std::make_unique<juce::AudioParameterFloat>(
+        "attackCurve",
+        "Attack Curve",
+        juce::NormalisableRange<float>(-1.0f, 1.0f, 0.01f),  // 0 is linear
+        0.0f  // default
+    ));
+    
+    params.add(std::make_unique<juce::AudioParameterFloat>(
+        "decayCurve",
+        "Decay Curve",
+        juce::NormalisableRange<float>(-1.0f, 1.0f, 0.01f),
+        0.0f  // default
+    ));
+    
+    params.add(std::make_unique<juce::AudioParameterFloat>(
+        "releaseCurve",
+        "Release Curve",
+        juce::NormalisableRange<float>(-1.0f, 1.0f, 0.01f),
+        0.0f  // default
+    ));
+    
     // LFO
     params.add(std::make_unique<juce::AudioParameterFloat>(
         "lfoRate",
@@ -620,6 +2125,15 @@ juce::AudioProcessorValueTreeState::ParameterLayout NoiseLabAudioProcessor::crea
         false  // default
     ));
     
+    params.add(std::make_unique<juce::AudioParameterChoice>(
+        "lfoDivision",
+        "LFO Division",
+        juce::StringArray({"1/1", "1/1.", "1/1T", "1/2", "1/2.", "1/2T", "1/4", "1/4.", "1/4T",
+                           "1/8", "1/8.", "1/8T", "1/16", "1/16.", "1/16T", "1/32", "1/32.", "1/32T",
+                           "1/64", "1/64.", "1/64T"}),
+        6  // default to 1/4
+    ));
+    
     params.add(std::make_unique<juce::AudioParameterChoice>(
         "lfoTarget",
         "LFO Target",
@@ -627,6 +2141,130 @@ juce::AudioProcessorValueTreeState::ParameterLayout NoiseLabAudioProcessor::crea
         0  // default to Volume
     ));
     
+    params.add(std::make_unique<juce::AudioParameterChoice>(
+        "lfoShape",
+        "LFO Shape",
+        juce::StringArray({"Sine", "Triangle", "Saw", "Square", "Sample & Hold", "Smooth Random"}),
+        0  // default to Sine
+    ));
+    
+    params.add(std::make_unique<juce::AudioParameterChoice>(
+        "controlInterval",
+        "Modulation Interval",
+        juce::StringArray({"16 samples", "32 samples", "64 samples"}),
+        1  // default to 32
+    ));
+    
+    // Second LFO, for the modulation matrix
+    params.add(std::make_unique<juce::AudioParameterFloat>(
+        "lfo2Rate",
+        "LFO 2 Rate",
+        juce::NormalisableRange<float>(0.1f, 50.0f, 0.01f, 0.3f),  // Hz, logarithmic scaling
+        0.25f  // default
+    ));
+    
+    params.add(std::make_unique<juce::AudioParameterBool>(
+        "lfo2Sync",
+        "LFO 2 Sync",
+        false  // default
+    ));
+    
+    params.add(std::make_unique<juce::AudioParameterChoice>(
+        "lfo2Division",
+        "LFO 2 Division",
+        juce::StringArray({"1/1", "1/1.", "1/1T", "1/2", "1/2.", "1/2T", "1/4", "1/4.", "1/4T",
+                           "1/8", "1/8.", "1/8T", "1/16", "1/16.", "1/16T", "1/32", "1/32.", "1/32T",
+                           "1/64", "1/64.", "1/64T"}),
+        0  // default to 1/1
+    ));
+    
+    params.add(std::make_unique<juce::AudioParameterChoice>(
+        "lfo2Shape",
+        "LFO 2 Shape",
+        juce::StringArray({"Sine", "Triangle", "Saw", "Square", "Sample & Hold", "Smooth Random"}),
+        5  // default to Smooth Random
+    ));
+    
+    // Random and chaotic source, for the modulation matrix
+    params.add(std::make_unique<juce::AudioParameterChoice>(
+        "randomMode",
+        "Random Mode",
+        juce::StringArray({"Smooth Random", "Drift", "Logistic", "Lorenz"}),
+        0  // default to Smooth Random
+    ));
+    
+    params.add(std::make_unique<juce::AudioParameterFloat>(
+        "randomRate",
+        "Random Rate",
+        juce::NormalisableRange<float>(0.01f, 20.0f, 0.01f, 0.3f),  // Hz, logarithmic scaling
+        0.5f  // default
+    ));
+    
+    params.add(std::make_unique<juce::AudioParameterInt>(
+        "randomSeed",
+        "Random Seed",
+        0,
+        9999,
+        1  // default
+    ));
+    
+    // Step sequencer
+    params.add(std::make_unique<juce::AudioParameterBool>(
+        "seqEnabled",
+        "Sequencer",
+        false  // default
+    ));
+    
+    params.add(std::make_unique<juce::AudioParameterChoice>(
+        "seqSteps",
+        "Sequencer Steps",
+        juce::StringArray({"16", "32", "48", "64"}),
+        0  // default to 16
+    ));
+    
+    params.add(std::make_unique<juce::AudioParameterChoice>(
+        "seqDivision",
+        "Sequencer Division",
+        juce::StringArray({"1/1", "1/1.", "1/1T", "1/2", "1/2.", "1/2T", "1/4", "1/4.", "1/4T",
+                           "1/8", "1/8.", "1/8T", "1/16", "1/16.", "1/16T", "1/32", "1/32.", "1/32T",
+                           "1/64", "1/64.", "1/64T"}),
+        12  // default to 1/16
+    ));
+    
+    params.add(std::make_unique<juce::AudioParameterFloat>(
+        "seqGate",
+        "Sequencer Gate",
+        juce::NormalisableRange<float>(0.05f, 1.0f, 0.01f),
+        0.5f  // default
+    ));
+    
+    // Modulation matrix
+    for (int slot = 1; slot <= numModulationSlots; ++slot)
+    {
+        const juce::String number(slot);
+        
+        params.add(std::make_unique<juce::AudioParameterChoice>(
+            "modSource" + number,
+            "Mod " + number + " Source",
+            juce::StringArray({"Off", "LFO 1", "LFO 2", "Envelope", "Multi-Stage", "Sequencer", "Random"}),
+            0  // default to Off
+        ));
+        
+        params.add(std::make_unique<juce::AudioParameterChoice>(
+            "modDestination" + number,
+            "Mod " + number + " Destination",
+            juce::StringArray({"Volume", "Filter Cutoff", "Filter Resonance"}),
+            1  // default to Filter Cutoff
+        ));
+        
+        params.add(std::make_unique<juce::AudioParameterFloat>(
+            "modDepth" + number,
+            "Mod " + number + " Depth",
+            juce::NormalisableRange<float>(-1.0f, 1.0f, 0.01f),
+            0.0f  // default
+        ));
+    }
+    
     // Filter
     params.add(std::make_unique<juce::AudioParameterChoice>(
         "filterType",
@@ -657,6 +2295,20 @@ juce::AudioProcessorValueTreeState::ParameterLayout NoiseLabAudioProcessor::crea
         0.0f  // default
     ));
     
+    params.add(std::make_unique<juce::AudioParameterChoice>(
+        "driveMode",
+        "Drive Mode",
+        juce::StringArray({"Standard", "ADAA 1st Order", "ADAA 2nd Order"}),
+        0  // default to Standard
+    ));
+    
+    params.add(std::make_unique<juce::AudioParameterChoice>(
+        "driveCurve",
+        "Drive Curve",
+        juce::StringArray({"Tanh", "Soft Clip", "Hard Clip", "Tube", "Foldback", "Diode"}),
+        0  // default to Tanh
+    ));
+    
     params.add(std::make_unique<juce::AudioParameterFloat>(
         "bitcrush",
         "Bitcrush",
@@ -664,6 +2316,13 @@ juce::AudioProcessorValueTreeState::ParameterLayout NoiseLabAudioProcessor::crea
         16.0f  // default (no effect)
     ));
     
+    params.add(std::make_unique<juce::AudioParameterFloat>(
+        "crushRate",
+        "Crush Rate",
+        juce::NormalisableRange<float>(1.0f, 64.0f, 0.01f, 0.4f),  // sample rate divisor
+        1.0f  // default (no sample rate reduction)
+    ));
+    
     params.add(std::make_unique<juce::AudioParameterFloat>(
         "width",
         "Stereo Width",
@@ -671,6 +2330,212 @@ juce::AudioProcessorValueTreeState::ParameterLayout NoiseLabAudioProcessor::crea
         1.0f  // default (normal stereo)
     ));
     
+    params.add(std::make_unique<juce::AudioParameterChoice>(
+        "oversampling",
+        "Oversampling",
+        juce::StringArray({"1x", "2x", "4x", "8x"}),
+        0  // default to 1x (no oversampling)
+    ));
+    
+    // Phaser
+    params.add(std::make_unique<juce::AudioParameterFloat>(
+        "phaserMix",
+        "Phaser Mix",
+        juce::NormalisableRange<float>(0.0f, 1.0f, 0.01f),
+        0.0f  // default (off)
+    ));
+    
+    params.add(std::make_unique<juce::AudioParameterChoice>(
+        "phaserStages",
+        "Phaser Stages",
+        juce::StringArray({"4", "6", "8", "10", "12"}),
+        2  // default to 8
+    ));
+    
+    params.add(std::make_unique<juce::AudioParameterFloat>(
+        "phaserRate",
+        "Phaser Rate",
+        juce::NormalisableRange<float>(0.01f, 10.0f, 0.01f, 0.3f),  // Hz
+        0.5f  // default
+    ));
+    
+    params.add(std::make_unique<juce::AudioParameterFloat>(
+        "phaserDepth",
+        "Phaser Depth",
+        juce::NormalisableRange<float>(0.0f, 1.0f, 0.01f),
+        0.8f  // default
+    ));
+    
+    params.add(std::make_unique<juce::AudioParameterFloat>(
+        "phaserFeedback",
+        "Phaser Feedback",
+        juce::NormalisableRange<float>(0.0f, 0.9f, 0.01f),
+        0.3f  // default
+    ));
+    
+    params.add(std::make_unique<juce::AudioParameterFloat>(
+        "phaserStereo",
+        "Phaser Stereo",
+        juce::NormalisableRange<float>(0.0f, 180.0f, 1.0f),  // degrees of LFO offset
+        90.0f  // default
+    ));
+    
+    // Dynamics
+    params.add(std::make_unique<juce::AudioParameterChoice>(
+        "compMode",
+        "Dynamics Mode",
+        juce::StringArray({"Off", "Compress", "Duck"}),
+        0  // default to Off
+    ));
+    
+    params.add(std::make_unique<juce::AudioParameterFloat>(
+        "compThreshold",
+        "Comp Threshold",
+        juce::NormalisableRange<float>(-60.0f, 0.0f, 0.1f),  // dB
+        -18.0f  // default
+    ));
+    
+    params.add(std::make_unique<juce::AudioParameterFloat>(
+        "compRatio",
+        "Comp Ratio",
+        juce::NormalisableRange<float>(1.0f, 20.0f, 0.1f, 0.5f),
+        4.0f  // default
+    ));
+    
+    params.add(std::make_unique<juce::AudioParameterFloat>(
+        "compAttack",
+        "Comp Attack",
+        juce::NormalisableRange<float>(0.1f, 100.0f, 0.1f, 0.4f),  // ms
+        5.0f  // default
+    ));
+    
+    params.add(std::make_unique<juce::AudioParameterFloat>(
+        "compRelease",
+        "Comp Release",
+        juce::NormalisableRange<float>(10.0f, 1000.0f, 1.0f, 0.4f),  // ms
+        150.0f  // default
+    ));
+    
+    params.add(std::make_unique<juce::AudioParameterFloat>(
+        "compLookahead",
+        "Comp Lookahead",
+        juce::NormalisableRange<float>(0.0f, Compressor::maxLookaheadMs, 0.1f),  // ms, reported as latency
+        0.0f  // default (no lookahead)
+    ));
+    
+    params.add(std::make_unique<juce::AudioParameterFloat>(
+        "compMakeup",
+        "Comp Makeup",
+        juce::NormalisableRange<float>(0.0f, 24.0f, 0.1f),  // dB
+        0.0f  // default
+    ));
+    
+    params.add(std::make_unique<juce::AudioParameterChoice>(
+        "duckDivision",
+        "Duck Rate",
+        juce::StringArray({"1/16", "1/8", "1/4", "1/2", "1/1"}),
+        2  // default to 1/4
+    ));
+    
+    params.add(std::make_unique<juce::AudioParameterFloat>(
+        "duckDepth",
+        "Duck Depth",
+        juce::NormalisableRange<float>(0.0f, 1.0f, 0.01f),
+        0.6f  // default
+    ));
+    
+    // Delay
+    params.add(std::make_unique<juce::AudioParameterFloat>(
+        "delayMix",
+        "Delay Mix",
+        juce::NormalisableRange<float>(0.0f, 1.0f, 0.01f),
+        0.0f  // default (off)
+    ));
+    
+    params.add(std::make_unique<juce::AudioParameterChoice>(
+        "delayDivision",
+        "Delay Time",
+        juce::StringArray({"1/32", "1/16T", "1/16", "1/8T", "1/16D", "1/8", "1/4T", "1/8D", "1/4", "1/2T", "1/4D", "1/2", "1/1"}),
+        5  // default to 1/8
+    ));
+    
+    params.add(std::make_unique<juce::AudioParameterFloat>(
+        "delayFeedback",
+        "Delay Feedback",
+        juce::NormalisableRange<float>(0.0f, 0.95f, 0.01f),
+        0.4f  // default
+    ));
+    
+    params.add(std::make_unique<juce::AudioParameterBool>(
+        "delayPingPong",
+        "Delay Ping-Pong",
+        true  // default
+    ));
+    
+    params.add(std::make_unique<juce::AudioParameterFloat>(
+        "delayLowCut",
+        "Delay Low Cut",
+        juce::NormalisableRange<float>(20.0f, 2000.0f, 1.0f, 0.3f),  // Hz
+        100.0f  // default
+    ));
+    
+    params.add(std::make_unique<juce::AudioParameterFloat>(
+        "delayHighCut",
+        "Delay High Cut",
+        juce::NormalisableRange<float>(1000.0f, 20000.0f, 1.0f, 0.3f),  // Hz
+        6000.0f  // default
+    ));
+    
+    // Reverb
+    params.add(std::make_unique<juce::AudioParameterChoice>(
+        "reverbType",
+        "Reverb Type",
+        juce::StringArray({"Convolution", "Algorithmic"}),
+        0  // default to Convolution
+    ));
+    
+    params.add(std::make_unique<juce::AudioParameterFloat>(
+        "reverbMix",
+        "Reverb Mix",
+        juce::NormalisableRange<float>(0.0f, 1.0f, 0.01f),
+        0.0f  // default (off)
+    ));
+    
+    params.add(std::make_unique<juce::AudioParameterFloat>(
+        "reverbDecay",
+        "Reverb Decay",
+        juce::NormalisableRange<float>(0.1f, 10.0f, 0.01f, 0.4f),  // seconds
+        2.0f  // default
+    ));
+    
+    params.add(std::make_unique<juce::AudioParameterChoice>(
+        "reverbHeadSize",
+        "Reverb Head Size",
+        juce::StringArray({"64", "128", "256", "512", "1024"}),  // samples
+        1  // default to 128
+    ));
+    
+    params.add(std::make_unique<juce::AudioParameterChoice>(
+        "reverbHeadMode",
+        "Reverb Head Mode",
+        juce::StringArray({"Zero Latency", "Low Latency"}),
+        0  // default to Zero Latency
+    ));
+    
+    params.add(std::make_unique<juce::AudioParameterFloat>(
+        "reverbDamping",
+        "Reverb Damping",
+        juce::NormalisableRange<float>(0.0f, 1.0f, 0.01f),
+        0.5f  // default
+    ));
+    
+    params.add(std::make_unique<juce::AudioParameterFloat>(
+        "reverbSize",
+        "Reverb Size",
+        juce::NormalisableRange<float>(0.0f, 1.0f, 0.01f),
+        0.5f  // default
+    ));
+    
     // Global
     params.add(std::make_unique<juce::AudioParameterFloat>(
         "output",
@@ -686,6 +2551,33 @@ juce::AudioProcessorValueTreeState::ParameterLayout NoiseLabAudioProcessor::crea
         1.0f  // default (100% wet)
     ));
     
+    params.add(std::make_unique<juce::AudioParameterFloat>(
+        "morph",
+        "Morph",
+        juce::NormalisableRange<float>(0.0f, 1.0f, 0.001f),
+        0.0f  // default (preset A)
+    ));
+    
+    params.add(std::make_unique<juce::AudioParameterBool>(
+        "limiter",
+        "Limiter",
+        false  // default off, so sessions saved without it sound the same
+    ));
+    
+    params.add(std::make_unique<juce::AudioParameterFloat>(
+        "limiterCeiling",
+        "Limiter Ceiling",
+        juce::NormalisableRange<float>(-12.0f, 0.0f, 0.1f),  // dBTP
+        -1.0f  // default
+    ));
+    
+    params.add(std::make_unique<juce::AudioParameterFloat>(
+        "limiterRelease",
+        "Limiter Release",
+        juce::NormalisableRange<float>(10.0f, 1000.0f, 1.0f, 0.4f),  // ms
+        100.0f  // default
+    ));
+    
     return params;
 }
 
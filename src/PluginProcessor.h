@@ -3,9 +3,24 @@
 #include <JuceHeader.h>
 #include "NoiseGenerator.h"
 #include "EnvelopeGenerator.h"
+#include "VoiceEngine.h"
+#include "MultiStageEnvelope.h"
 #include "LFOGenerator.h"
+#include "ControlRateModulation.h"
+#include "ModulationMatrix.h"
+#include "RandomModulator.h"
+#include "StepSequencer.h"
+#include "BeatGridScheduler.h"
+#include "PresetMorph.h"
 #include "FilterProcessor.h"
 #include "EffectsProcessor.h"
+#include "Oversampler.h"
+#include "Phaser.h"
+#include "Compressor.h"
+#include "ConvolutionReverb.h"
+#include "FDNReverb.h"
+#include "StereoDelay.h"
+#include "TruePeakLimiter.h"
 
 //==============================================================================
 /**
@@ -53,19 +68,112 @@ public:
     //==============================================================================
     void parameterChanged(const juce::String& parameterID, float newValue) override;
     
+    //==============================================================================
+    // Loads an impulse response file for the convolution reverb; an invalid
+    // file reverts to the synthetic IR. Call from the message thread. The
+    // file path is kept in the plugin state.
+    bool loadImpulseResponse(const juce::File& file);
+    
+    // Replaces the multi-stage envelope's breakpoints. Call from the message
+    // thread. The shape is kept in the plugin state.
+    void setEnvelopeShape(const juce::Array<MultiStageEnvelope::Segment>& segments, int loopStart, int loopEnd);
+    
+    // Sets one of the sequencer's steps. Call from the message thread. The
+    // pattern is kept in the plugin state.
+    void setSequencerStep(int index, bool gate, float velocity, float filter);
+    
+    // Stores the current parameter values as preset morph snapshot A (0) or
+    // B (1). While both are stored, the Morph parameter moves the stored
+    // parameters between them, and changes to those parameters are held
+    // back until the snapshots are cleared. Call from the message thread;
+    // the snapshots are kept in the plugin state.
+    void storeMorphSnapshot(int slot);
+    void clearMorphSnapshots();
+    
     // Audio processor value tree state
     juce::AudioProcessorValueTreeState apvts;
 
 private:
     // Parameter setup
     juce::AudioProcessorValueTreeState::ParameterLayout createParameters();
+    
+    // Re-prepares the processors inside the oversampled section and reports
+    // the new total latency to the host
+    void prepareNonlinearSection(int samplesPerBlock);
+    void updateLatency();
+    
+    // Writes the input into the dry delay ring and reads it back into
+    // dryBuffer, dryDelaySamples late
+    void delayDryPath(const juce::AudioBuffer<float>& input);
+    
+    // Note handling for one MIDI event, and the noise source and envelope
+    // for the samples between events
+    void handleMidiMessage(const juce::MidiMessage& message);
+    void applyPendingResets();
+    void renderSource(juce::AudioBuffer<float>& buffer, int startSample, int numSamples);
+    
+    // Renders the source split at this block's grid points, retriggering
+    // the envelope at each (host sync mode)
+    void renderSourceWithTriggers(juce::AudioBuffer<float>& buffer, int startSample, int numSamples);
+    void triggerGridNote();
+    void releaseGridNote();
+    
+    // Copies the envelope settings to the polyphonic voices and the
+    // modulation envelope
+    void updateEnvelopeCopies();
+    
+    // Modulation sources run at the control rate. Only the sources with a
+    // route are rendered, one value per tick.
+    void prepareModulationSources(int samplesPerBlock);
+    void updateModulationSourceRates();
+    void renderModulationSources(int numTicks);
+    void updateModulationSlot(int slot);
+    void updateLfoRoute();
+    
+    // Apply the envelope shape, sequencer pattern and morph snapshots saved
+    // in the plugin state, if any
+    void restoreEnvelopeShape();
+    void restoreSequencerPattern();
+    void restoreMorphSnapshots();
+    
+    // Stores a snapshot in the morph, after baking the drive curves for it
+    void setMorphSnapshot(int slot, const float* values);
+    
+    // Runs a filter over the oversampled block, stepping its modulation
+    // once per control interval
+    void renderFilter(FilterProcessor& filter, juce::AudioBuffer<float>& oversampledBuffer);
+    
+    // Applies the morph position to the stored parameters, and works out
+    // which discrete ones need a second path
+    void updatePresetMorph();
+    void applyMorphTarget(PresetMorph::Target target, float value);
 
     // Processors
     NoiseGenerator noiseGenerator;
     EnvelopeGenerator envelopeGenerator;
+    VoiceEngine voiceEngine;
+    MultiStageEnvelope multiStageEnvelope;
+    BeatGridScheduler beatGridScheduler;
+    StepSequencer stepSequencer;
     LFOGenerator lfoGenerator;
+    LFOGenerator lfoGenerator2;
+    RandomModulator randomModulator;
+    EnvelopeGenerator modulationEnvelope;
+    MultiStageEnvelope modulationMultiStageEnvelope;
+    ControlRateModulation modulation;
+    ModulationMatrix modulationMatrix;
     FilterProcessor filterProcessor;
+    PresetMorph presetMorph;
+    NoiseGenerator morphNoiseGenerator;
+    FilterProcessor morphFilterProcessor;
     EffectsProcessor effectsProcessor;
+    Oversampler oversampler;
+    Phaser phaser;
+    Compressor compressor;
+    StereoDelay stereoDelay;
+    ConvolutionReverb convolutionReverb;
+    FDNReverb fdnReverb;
+    TruePeakLimiter limiter;
 
     // Trigger mode
     enum TriggerMode {
@@ -76,7 +184,61 @@ private:
     };
     TriggerMode currentTriggerMode;
     
-    // MIDI handling
+    // Modulation matrix slots 1 to 4 are parameters; slot 0 is the LFO's
+    // own target. Source lanes come first, then the destinations.
+    static constexpr int numModulationSlots = 4;
+    static constexpr int firstDestinationLane = ModulationMatrix::NumSources;
+    static_assert(firstDestinationLane + ModulationMatrix::NumDestinations <= ControlRateModulation::maxLanes,
+                  "Not enough modulation lanes");
+    
+    // Each slot's parameter IDs and values, looked up once in the
+    // constructor. Index 0, the LFO's own slot, is unused.
+    struct ModulationSlotParameters
+    {
+        juce::String sourceID;
+        juce::String destinationID;
+        juce::String depthID;
+        std::atomic<float>* source = nullptr;
+        std::atomic<float>* destination = nullptr;
+        std::atomic<float>* depth = nullptr;
+    };
+    ModulationSlotParameters modulationSlotParameters[numModulationSlots + 1];
+    
+    // The control interval to apply at the next block
+    int requestedControlInterval;
+    
+    // Note and envelope resets requested by parameter changes. The voices
+    // and envelopes belong to the audio thread, so these are applied at the
+    // start of the next block rather than in parameterChanged.
+    enum PendingReset
+    {
+        RESET_NOTES = 1 << 0,           // held notes, voices and modulation envelopes
+        RESET_ENVELOPES = 1 << 1,       // the mono source's envelopes
+        RETRIGGER_ENVELOPES = 1 << 2    // then start them again (free run)
+    };
+    std::atomic<int> pendingResets;
+    
+    // In MIDI trigger and one-shot modes, notes play the voice engine
+    // instead of the mono source
+    bool polyphonic;
+    
+    // The mono source uses the multi-stage envelope instead of the ADSR
+    bool useMultiStageEnvelope;
+    
+    // The step sequencer gates the source
+    bool sequencerEnabled;
+    
+    // Reverb type. The requested type is applied at the start of the reverb
+    // stage, so the latency can be updated from the audio thread.
+    enum ReverbType {
+        CONVOLUTION_REVERB,
+        ALGORITHMIC_REVERB
+    };
+    ReverbType requestedReverbType;
+    ReverbType currentReverbType;
+    
+    // MIDI handling. Held notes, one entry each; reserved up front so
+    // note-ons never allocate.
     struct MidiNote {
         int noteNumber;
         int velocity;
@@ -88,16 +250,49 @@ private:
     bool isPlaying;
     double bpm;
     double ppqPosition;
+    double barStartPosition;
+    
+    // This block's grid points, and the next one to fire
+    int numGridTriggers;
+    int nextGridTrigger;
     
     // Output controls
     float outputLevel;
     float dryWetMix;
     
-    // Last sample rate
+    // Preset morph: the requested position, the one last applied, and
+    // whether the noise and filter types are mid-crossfade
+    float morphPosition;
+    float appliedMorphPosition;
+    bool crossfadeNoise;
+    bool crossfadeFilter;
+    bool morphApplied;
+    float morphValues[PresetMorph::NumTargets];
+    std::atomic<float>* morphParameters[PresetMorph::NumTargets];
+    
+    // Last sample rate and block size
     double currentSampleRate;
+    int currentBlockSize;
     
-    // Buffer for dry/wet processing
+    // Buffer for dry/wet processing, and a ring that delays the dry path by
+    // the wet path's latency (all of it but the limiter's, which comes after
+    // the mix) so the two line up
     juce::AudioBuffer<float> dryBuffer;
+    juce::AudioBuffer<float> dryDelayBuffer;
+    int dryDelayMask;
+    int dryDelayWritePosition;
+    int dryDelaySamples;
+    
+    // Volume modulation gain for the current block
+    juce::AudioBuffer<float> lfoBuffer;
+    
+    // Step sequencer gain for the current block
+    juce::AudioBuffer<float> sequencerBuffer;
+    
+    // Second noise and filter paths, while morphing between snapshots with
+    // different types
+    juce::AudioBuffer<float> morphNoiseBuffer;
+    juce::AudioBuffer<float> morphFilterBuffer;
     
     JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(NoiseLabAudioProcessor)
 };
\ No newline at end of file
@@ -0,0 +1,160 @@
+#include "PresetMorph.h"
+
+//==============================================================================
+namespace
+{
+    const char* const parameterIDs[] =
+    {
+        "cutoff",
+        "resonance",
+        "drive",
+        "bitcrush",
+        "crushRate",
+        "width",
+        "stereoDecorrelation",
+        "phaserMix",
+        "phaserRate",
+        "phaserDepth",
+        "phaserFeedback",
+        "delayMix",
+        "delayFeedback",
+        "delayLowCut",
+        "delayHighCut",
+        "reverbMix",
+        "reverbDamping",
+        "reverbSize",
+        "output",
+        "dryWet",
+        "noiseType",
+        "filterType"
+    };
+
+    static_assert(sizeof(parameterIDs) / sizeof(parameterIDs[0]) == PresetMorph::NumTargets,
+                  "One parameter per morph target");
+}
+
+//==============================================================================
+PresetMorph::PresetMorph()
+    : writeIndex(0)
+    , readIndex(1)
+    , publishedIndex(2)
+    , bothStored(false)
+{
+    clearSnapshots();
+    applyPendingSnapshots();
+}
+
+PresetMorph::~PresetMorph()
+{
+}
+
+//==============================================================================
+const char* PresetMorph::getParameterID(Target target)
+{
+    return parameterIDs[juce::jlimit(0, NumTargets - 1, static_cast<int>(target))];
+}
+
+bool PresetMorph::isDiscrete(Target target)
+{
+    return target == NoiseType || target == FilterType;
+}
+
+bool PresetMorph::isTargetParameter(const juce::String& parameterID)
+{
+    for (const char* targetID : parameterIDs)
+        if (parameterID == targetID)
+            return true;
+
+    return false;
+}
+
+bool PresetMorph::isFrequency(Target target)
+{
+    return target == Cutoff || target == PhaserRate || target == DelayLowCut || target == DelayHighCut;
+}
+
+//==============================================================================
+void PresetMorph::setSnapshot(int slot, const float* parameterValues)
+{
+    if (slot < 0 || slot > 1)
+        return;
+
+    float* values = slot == 0 ? edited.a : edited.b;
+
+    for (int target = 0; target < NumTargets; ++target)
+    {
+        const float value = parameterValues[target];
+        values[target] = isFrequency(static_cast<Target>(target)) ? std::log2(juce::jmax(value, 0.001f)) : value;
+    }
+
+    if (slot == 0)
+        edited.hasA = true;
+    else
+        edited.hasB = true;
+
+    publish();
+}
+
+void PresetMorph::clearSnapshots()
+{
+    juce::FloatVectorOperations::clear(edited.a, NumTargets);
+    juce::FloatVectorOperations::clear(edited.b, NumTargets);
+    edited.hasA = false;
+    edited.hasB = false;
+
+    publish();
+}
+
+void PresetMorph::publish()
+{
+    juce::FloatVectorOperations::subtract(edited.difference, edited.b, edited.a, NumTargets);
+    snapshots[writeIndex] = edited;
+    bothStored = edited.hasA && edited.hasB;
+
+    // Publish, and take back whichever slot was published before
+    writeIndex = publishedIndex.exchange(writeIndex | newSnapshotsFlag, std::memory_order_acq_rel) & ~newSnapshotsFlag;
+}
+
+//==============================================================================
+bool PresetMorph::applyPendingSnapshots()
+{
+    if ((publishedIndex.load(std::memory_order_relaxed) & newSnapshotsFlag) == 0)
+        return false;
+
+    readIndex = publishedIndex.exchange(readIndex, std::memory_order_acq_rel) & ~newSnapshotsFlag;
+    return true;
+}
+
+bool PresetMorph::isActive() const
+{
+    return snapshots[readIndex].hasA && snapshots[readIndex].hasB;
+}
+
+void PresetMorph::process(float position, float* values) const
+{
+    const Snapshots& current = snapshots[readIndex];
+
+    juce::FloatVectorOperations::copy(values, current.a, NumTargets);
+    juce::FloatVectorOperations::addWithMultiply(values, current.difference, juce::jlimit(0.0f, 1.0f, position), NumTargets);
+}
+
+float PresetMorph::getTargetValue(Target target, float morphedValue)
+{
+    return isFrequency(target) ? std::exp2(morphedValue) : morphedValue;
+}
+
+float PresetMorph::getSnapshotValue(int slot, Target target) const
+{
+    return getTargetValue(target, slot == 0 ? edited.a[target] : edited.b[target]);
+}
+
+bool PresetMorph::hasBothSnapshots() const
+{
+    return bothStored.load();
+}
+
+int PresetMorph::getDiscreteValue(int slot, Target target) const
+{
+    const Snapshots& current = snapshots[readIndex];
+    return juce::roundToInt(slot == 0 ? current.a[target] : current.b[target]);
+}
@@ -0,0 +1,123 @@
+#pragma once
+
+#include <JuceHeader.h>
+#include <atomic>
+
+//==============================================================================
+/**
+ * Two parameter snapshots, A and B, and the values between them.
+ *
+ * Each snapshot is a flat array with one value per target, already mapped
+ * into the space it is morphed in: real units, or log2 for frequencies, so
+ * a morph sweeps them evenly by octave. The difference B - A is worked out
+ * when a snapshot is stored, so a morph position is a single vectorized
+ * lerp over the array. getTargetValue maps a morphed value back.
+ *
+ * Discrete targets are carried along as they are; it is up to the caller
+ * to switch or crossfade between A's and B's values.
+ *
+ * Snapshots are stored from the message thread and published to the audio
+ * thread through a triple buffer, as the multi-stage envelope's shapes
+ * are.
+ *
+ * While both snapshots are stored the morph owns its targets: changes to
+ * those parameters are not applied to the processors, and every target
+ * returns to its parameter's current value once the snapshots are cleared.
+ */
+class PresetMorph
+{
+public:
+    //==============================================================================
+    enum Target
+    {
+        Cutoff = 0,
+        Resonance,
+        Drive,
+        Bitcrush,
+        CrushRate,
+        Width,
+        Decorrelation,
+        PhaserMix,
+        PhaserRate,
+        PhaserDepth,
+        PhaserFeedback,
+        DelayMix,
+        DelayFeedback,
+        DelayLowCut,
+        DelayHighCut,
+        ReverbMix,
+        ReverbDamping,
+        ReverbSize,
+        Output,
+        DryWet,
+        NoiseType,      // discrete
+        FilterType,     // discrete
+        NumTargets
+    };
+
+    //==============================================================================
+    PresetMorph();
+    ~PresetMorph();
+
+    //==============================================================================
+    // The parameter each target stores
+    static const char* getParameterID(Target target);
+    static bool isDiscrete(Target target);
+    static bool isTargetParameter(const juce::String& parameterID);
+
+    //==============================================================================
+    // Call from the message thread. Takes one real parameter value per
+    // target.
+    void setSnapshot(int slot, const float* parameterValues);
+    void clearSnapshots();
+    
+    // A stored snapshot's value in the parameter's units. Message thread.
+    float getSnapshotValue(int slot, Target target) const;
+    
+    // True once both A and B have been stored. Any thread.
+    bool hasBothSnapshots() const;
+
+    //==============================================================================
+    // Picks up snapshots stored since the last call. Returns true if there
+    // were any.
+    bool applyPendingSnapshots();
+
+    // True once both A and B are stored
+    bool isActive() const;
+
+    // Writes the morphed values, 0 being A and 1 being B, one per target
+    void process(float position, float* values) const;
+
+    // A morphed value back in the parameter's units
+    static float getTargetValue(Target target, float morphedValue);
+
+    // A snapshot's value of a discrete target
+    int getDiscreteValue(int slot, Target target) const;
+
+private:
+    //==============================================================================
+    struct Snapshots
+    {
+        float a[NumTargets];
+        float b[NumTargets];
+        float difference[NumTargets];   // b - a
+        bool hasA;
+        bool hasB;
+    };
+
+    // Triple buffer slots: the writer owns one, the reader one, and the
+    // third is the latest published. newSnapshotsFlag marks it as not yet
+    // read.
+    static constexpr int newSnapshotsFlag = 4;
+
+    static bool isFrequency(Target target);
+    void publish();
+
+    //==============================================================================
+    Snapshots edited;                 // the writer's copy
+    Snapshots snapshots[3];
+    int writeIndex;                   // owned by the writer
+    int readIndex;                    // owned by the audio thread
+    std::atomic<int> publishedIndex;  // slot index, plus newSnapshotsFlag
+    std::atomic<bool> bothStored;     // the writer's hasA && hasB
+};
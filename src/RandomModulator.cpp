@@ -0,0 +1,237 @@
+#include "RandomModulator.h"
+
+//==============================================================================
+namespace
+{
+    // Logistic map in its chaotic range
+    constexpr float logisticGrowth = 3.9f;
+
+    // Lorenz attractor with the classic parameters, integrated in steps of
+    // at most this much
+    constexpr double lorenzSigma = 10.0;
+    constexpr double lorenzRho = 28.0;
+    constexpr double lorenzBeta = 8.0 / 3.0;
+    constexpr double lorenzMaxStep = 0.005;
+
+    // Roughly the attractor's x range
+    constexpr double lorenzScale = 1.0 / 20.0;
+
+    // Spread of the drift around the centre
+    constexpr float driftDeviation = 0.4f;
+}
+
+//==============================================================================
+RandomModulator::RandomModulator()
+    : sampleRate(44100.0)
+    , mode(SmoothRandom)    // Default: smooth random
+    , rate(0.5f)            // Default: 0.5 Hz
+    , seed(1)
+    , seedChanged(false)
+    , phase(0.0f)
+    , logisticValue(0.5f)
+    , driftValue(0.0f)
+    , driftSmoothed(0.0f)
+    , lorenzX(0.0)
+    , lorenzY(0.0)
+    , lorenzZ(0.0)
+{
+    reset();
+}
+
+RandomModulator::~RandomModulator()
+{
+}
+
+//==============================================================================
+void RandomModulator::prepareToPlay(double newSampleRate, int /*samplesPerBlock*/)
+{
+    sampleRate = newSampleRate;
+    reset();
+}
+
+void RandomModulator::setSampleRate(double newSampleRate)
+{
+    sampleRate = newSampleRate;
+}
+
+void RandomModulator::processBlock(float* output, int numSamples)
+{
+    if (numSamples <= 0)
+        return;
+
+    if (seedChanged.exchange(false))
+        reset();
+
+    switch (getMode())
+    {
+        case SmoothRandom:
+            renderCubic(output, numSamples, false);
+            break;
+
+        case Logistic:
+            renderCubic(output, numSamples, true);
+            break;
+
+        case Drift:
+            renderDrift(output, numSamples);
+            break;
+
+        case Lorenz:
+            renderLorenz(output, numSamples);
+            break;
+
+        case NumModes:
+        default:
+            juce::FloatVectorOperations::clear(output, numSamples);
+            break;
+    }
+}
+
+void RandomModulator::reset()
+{
+    random.setSeed(seed.load());
+
+    // Start the logistic map away from its fixed points
+    logisticValue = 0.1f + 0.8f * random.nextFloat();
+
+    phase = 0.0f;
+    for (auto& point : points)
+        point = random.nextFloat() * 2.0f - 1.0f;
+
+    driftValue = 0.0f;
+    driftSmoothed = 0.0f;
+
+    // Somewhere on the attractor's wings
+    lorenzX = random.nextFloat() * 10.0 - 5.0;
+    lorenzY = random.nextFloat() * 10.0 - 5.0;
+    lorenzZ = 20.0 + random.nextFloat() * 10.0;
+}
+
+//==============================================================================
+void RandomModulator::setMode(Mode newMode)
+{
+    mode.store(juce::jlimit(0, NumModes - 1, static_cast<int>(newMode)));
+}
+
+void RandomModulator::setRate(float rateHz)
+{
+    rate.store(juce::jmax(0.0f, rateHz));
+}
+
+void RandomModulator::setSeed(int newSeed)
+{
+    seed.store(newSeed);
+    seedChanged.store(true);
+}
+
+RandomModulator::Mode RandomModulator::getMode() const
+{
+    return static_cast<Mode>(mode.load());
+}
+
+float RandomModulator::getRate() const
+{
+    return rate.load();
+}
+
+int RandomModulator::getSeed() const
+{
+    return seed.load();
+}
+
+//==============================================================================
+void RandomModulator::renderCubic(float* output, int numSamples, bool logistic)
+{
+    const float increment = rate.load() / static_cast<float>(sampleRate);
+
+    for (int i = 0; i < numSamples; ++i)
+    {
+        phase += increment;
+
+        if (phase >= 1.0f)
+        {
+            phase -= std::floor(phase);
+
+            points[0] = points[1];
+            points[1] = points[2];
+            points[2] = points[3];
+            points[3] = nextPoint(logistic);
+        }
+
+        // Catmull-Rom from points[1] to points[2]
+        const float t = phase;
+        const float a = 0.5f * (-points[0] + 3.0f * points[1] - 3.0f * points[2] + points[3]);
+        const float b = 0.5f * (2.0f * points[0] - 5.0f * points[1] + 4.0f * points[2] - points[3]);
+        const float c = 0.5f * (points[2] - points[0]);
+
+        output[i] = ((a * t + b) * t + c) * t + points[1];
+    }
+
+    // The curve can overshoot its points a little
+    juce::FloatVectorOperations::clip(output, output, -1.0f, 1.0f, numSamples);
+}
+
+void RandomModulator::renderDrift(float* output, int numSamples)
+{
+    // A random walk pulled back towards zero at the rate, so it wanders
+    // about that often, then smoothed at the same rate
+    const float dt = 1.0f / static_cast<float>(sampleRate);
+    const float pull = juce::jmin(1.0f, juce::MathConstants<float>::twoPi * rate.load() * dt);
+    const float spread = driftDeviation * std::sqrt(2.0f * pull);
+
+    for (int i = 0; i < numSamples; ++i)
+    {
+        driftValue += pull * -driftValue + spread * nextGaussian();
+        driftSmoothed += pull * (driftValue - driftSmoothed);
+        output[i] = driftSmoothed;
+    }
+
+    juce::FloatVectorOperations::clip(output, output, -1.0f, 1.0f, numSamples);
+}
+
+void RandomModulator::renderLorenz(float* output, int numSamples)
+{
+    // About one loop of the attractor per second at 1 Hz
+    const double timePerSample = rate.load() / sampleRate;
+    const int numSteps = juce::jmax(1, static_cast<int>(std::ceil(timePerSample / lorenzMaxStep)));
+    const double dt = timePerSample / numSteps;
+
+    for (int i = 0; i < numSamples; ++i)
+    {
+        for (int step = 0; step < numSteps; ++step)
+        {
+            const double dx = lorenzSigma * (lorenzY - lorenzX);
+            const double dy = lorenzX * (lorenzRho - lorenzZ) - lorenzY;
+            const double dz = lorenzX * lorenzY - lorenzBeta * lorenzZ;
+
+            lorenzX += dx * dt;
+            lorenzY += dy * dt;
+            lorenzZ += dz * dt;
+        }
+
+        output[i] = static_cast<float>(lorenzX * lorenzScale);
+    }
+
+    juce::FloatVectorOperations::clip(output, output, -1.0f, 1.0f, numSamples);
+}
+
+//==============================================================================
+float RandomModulator::nextPoint(bool logistic)
+{
+    if (!logistic)
+        return random.nextFloat() * 2.0f - 1.0f;
+
+    logisticValue = logisticGrowth * logisticValue * (1.0f - logisticValue);
+
+    // Rounding can land it on a fixed point; start it somewhere else
+    if (logisticValue <= 0.0f || logisticValue >= 1.0f)
+        logisticValue = 0.1f + 0.8f * random.nextFloat();
+
+    return logisticValue * 2.0f - 1.0f;
+}
+
+float RandomModulator::nextGaussian()
+{
+    // Sum of three uniforms, scaled to unit variance
+    return (random.nextFloat() + random.nextFloat() + random.nextFloat() - 1.5f) * 2.0f;
+}
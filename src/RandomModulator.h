@@ -0,0 +1,90 @@
+#pragma once
+
+#include <JuceHeader.h>
+#include <atomic>
+
+//==============================================================================
+/**
+ * Non-periodic modulation source: smooth random, drift, or a chaotic map or
+ * attractor.
+ *
+ * Meant to run at the control rate, so each mode costs a few operations
+ * per tick rather than per sample. Smooth random and the logistic map pick
+ * a new point each cycle and join the points with a cubic curve. Drift is
+ * a slow random walk pulled back towards the centre. Lorenz integrates the
+ * attractor in small fixed steps and follows its x axis.
+ *
+ * Every mode draws from one seeded generator, and reset restarts it from
+ * the seed, so a render repeats exactly.
+ */
+class RandomModulator
+{
+public:
+    //==============================================================================
+    enum Mode
+    {
+        SmoothRandom = 0,
+        Drift,
+        Logistic,
+        Lorenz,
+        NumModes
+    };
+
+    //==============================================================================
+    RandomModulator();
+    ~RandomModulator();
+
+    //==============================================================================
+    void prepareToPlay(double sampleRate, int samplesPerBlock);
+
+    // Changes the rate it's run at, carrying on from where it is
+    void setSampleRate(double sampleRate);
+
+    // Writes numSamples of the source, -1 to 1, to output
+    void processBlock(float* output, int numSamples);
+    void reset();
+
+    //==============================================================================
+    // Can be called from any thread. A new seed restarts the source.
+    void setMode(Mode mode);
+    void setRate(float rateHz);
+    void setSeed(int seed);
+
+    Mode getMode() const;
+    float getRate() const;
+    int getSeed() const;
+
+private:
+    //==============================================================================
+    double sampleRate;
+
+    std::atomic<int> mode;
+    std::atomic<float> rate;    // Hz
+    std::atomic<int> seed;
+    std::atomic<bool> seedChanged;
+
+    juce::Random random;
+
+    // Cubic modes: the last four points and the position between the
+    // middle two
+    float points[4];
+    float phase;
+    float logisticValue;
+
+    // Drift: the walk, and the same smoothed
+    float driftValue;
+    float driftSmoothed;
+
+    // Lorenz state
+    double lorenzX;
+    double lorenzY;
+    double lorenzZ;
+
+    //==============================================================================
+    void renderCubic(float* output, int numSamples, bool logistic);
+    void renderDrift(float* output, int numSamples);
+    void renderLorenz(float* output, int numSamples);
+
+    float nextPoint(bool logistic);
+    float nextGaussian();
+};
@@ -0,0 +1,76 @@
+#include "SlidingMaximum.h"
+
+//==============================================================================
+SlidingMaximum::SlidingMaximum()
+    : mask(0)
+    , front(0)
+    , back(0)
+    , windowLength(1)
+    , counter(0)
+{
+}
+
+SlidingMaximum::~SlidingMaximum()
+{
+}
+
+//==============================================================================
+void SlidingMaximum::prepare(int maxWindowLength)
+{
+    // The deque holds at most one window plus the new entry, and one slot
+    // stays free so a full ring isn't mistaken for an empty one
+    const int capacity = juce::nextPowerOfTwo(juce::jmax(4, maxWindowLength + 2));
+
+    values.assign(static_cast<size_t>(capacity), 0.0f);
+    positions.assign(static_cast<size_t>(capacity), 0);
+    mask = capacity - 1;
+
+    windowLength = juce::jlimit(1, mask - 1, windowLength);
+    reset();
+}
+
+void SlidingMaximum::setWindowLength(int length)
+{
+    windowLength = juce::jlimit(1, juce::jmax(1, mask - 1), length);
+    reset();
+}
+
+int SlidingMaximum::getWindowLength() const
+{
+    return windowLength;
+}
+
+void SlidingMaximum::reset()
+{
+    front = 0;
+    back = 0;
+    counter = 0;
+}
+
+//==============================================================================
+float SlidingMaximum::process(float value)
+{
+    if (values.empty())
+        return value;
+
+    // Smaller values behind the new one can never be the maximum again
+    while (back != front && values[static_cast<size_t>((back - 1) & mask)] <= value)
+        back = (back - 1) & mask;
+
+    values[static_cast<size_t>(back)] = value;
+    positions[static_cast<size_t>(back)] = counter;
+    back = (back + 1) & mask;
+
+    // Drop the front once it has left the window
+    if (counter - positions[static_cast<size_t>(front)] >= static_cast<juce::uint32>(windowLength))
+        front = (front + 1) & mask;
+
+    ++counter;
+    return values[static_cast<size_t>(front)];
+}
+
+void SlidingMaximum::processBlock(const float* input, float* output, int numSamples)
+{
+    for (int i = 0; i < numSamples; ++i)
+        output[i] = process(input[i]);
+}
@@ -0,0 +1,50 @@
+#pragma once
+
+#include <JuceHeader.h>
+#include <vector>
+
+//==============================================================================
+/**
+ * Running maximum over the last N samples, in amortized O(1) per sample.
+ *
+ * Keeps a monotonic deque of candidates: each new value pops every smaller
+ * value off the back (they can never be the maximum again), and the front
+ * is dropped once it falls out of the window. Every value is pushed and
+ * popped at most once, whatever the window length. The deque lives in
+ * preallocated power-of-two rings, so processing never allocates.
+ */
+class SlidingMaximum
+{
+public:
+    //==============================================================================
+    SlidingMaximum();
+    ~SlidingMaximum();
+
+    //==============================================================================
+    // Allocates for windows up to maxWindowLength samples
+    void prepare(int maxWindowLength);
+
+    // Changes the window length and clears the history
+    void setWindowLength(int length);
+    int getWindowLength() const;
+
+    void reset();
+
+    //==============================================================================
+    // Pushes one sample and returns the maximum of the last windowLength
+    // samples, including this one
+    float process(float value);
+
+    // output[i] is the window maximum ending at input[i]. output may be input.
+    void processBlock(const float* input, float* output, int numSamples);
+
+private:
+    //==============================================================================
+    std::vector<float> values;
+    std::vector<juce::uint32> positions;   // sample counter when each value was pushed
+    int mask;
+    int front;
+    int back;                              // one past the newest entry
+    int windowLength;
+    juce::uint32 counter;                  // wraps; only differences are used
+};
@@ -0,0 +1,224 @@
+#include "StepSequencer.h"
+
+//==============================================================================
+StepSequencer::StepSequencer()
+    : sampleRate(44100.0)
+    , hostBPM(120.0)                            // Default: 120 BPM
+    , numSteps(minSteps)                        // Default: 16 steps
+    , stepDivision(LFOGenerator::Sixteenth)     // Default: 1/16
+    , gateLength(0.5f)                          // Default: half a step
+    , position(0.0)
+    , blockStartPosition(0.0)
+    , currentGain(0.0f)
+    , targetGain(0.0f)
+    , rampIncrement(0.0f)
+    , rampSamplesRemaining(0)
+    , rampLength(1)
+{
+    // Default pattern: every step, accented on the beat
+    for (int i = 0; i < maxSteps; ++i)
+        setStep(i, true, i % 4 == 0 ? 1.0f : 0.6f, 0.0f);
+}
+
+StepSequencer::~StepSequencer()
+{
+}
+
+//==============================================================================
+void StepSequencer::prepareToPlay(double newSampleRate, int /*samplesPerBlock*/)
+{
+    sampleRate = newSampleRate;
+
+    // 2 ms ramps
+    rampLength = juce::jmax(1, static_cast<int>(sampleRate * 0.002));
+
+    reset();
+}
+
+void StepSequencer::reset()
+{
+    position = 0.0;
+    blockStartPosition = 0.0;
+    currentGain = 0.0f;
+    targetGain = 0.0f;
+    rampIncrement = 0.0f;
+    rampSamplesRemaining = 0;
+}
+
+void StepSequencer::renderGain(float* gain, int numSamples)
+{
+    if (numSamples <= 0)
+        return;
+
+    const double beatsPerStep = LFOGenerator::getBeatsPerCycle(getStepDivision());
+    const double gateBeats = beatsPerStep * gateLength.load();
+    const double samplesPerBeat = sampleRate * 60.0 / juce::jmax(1.0, hostBPM);
+
+    blockStartPosition = position;
+
+    // Where the block starts: which step, and whether its gate is still open.
+    // This also catches a relocated transport or an edited step.
+    double stepNumber = std::floor(position / beatsPerStep);
+    bool inGate = gateBeats < beatsPerStep && position - stepNumber * beatsPerStep < gateBeats;
+    startRamp(getGateTarget(position, beatsPerStep, gateBeats));
+
+    // Render each span between steps or gate ends in one go
+    int sample = 0;
+
+    while (sample < numSamples)
+    {
+        const double nextEvent = stepNumber * beatsPerStep + (inGate ? gateBeats : beatsPerStep);
+        const int eventSample = juce::jmax(sample, static_cast<int>(std::ceil((nextEvent - blockStartPosition) * samplesPerBeat)));
+
+        if (eventSample >= numSamples)
+        {
+            renderSpan(gain + sample, numSamples - sample);
+            break;
+        }
+
+        renderSpan(gain + sample, eventSample - sample);
+        sample = eventSample;
+
+        if (inGate)
+        {
+            // End of the gate
+            inGate = false;
+            startRamp(0.0f);
+        }
+        else
+        {
+            stepNumber += 1.0;
+            inGate = gateBeats < beatsPerStep;
+
+            const Step& step = steps[getStepIndex(stepNumber)];
+            startRamp(step.gate.load() ? step.velocity.load() : 0.0f);
+        }
+    }
+
+    position += static_cast<double>(numSamples) / samplesPerBeat;
+}
+
+void StepSequencer::renderFilterValues(float* values, int firstSample, int interval, int numValues) const
+{
+    const double beatsPerStep = LFOGenerator::getBeatsPerCycle(getStepDivision());
+    const double beatsPerSample = juce::jmax(1.0, hostBPM) / (sampleRate * 60.0);
+
+    for (int i = 0; i < numValues; ++i)
+    {
+        const double at = blockStartPosition + static_cast<double>(firstSample + i * interval) * beatsPerSample;
+        values[i] = steps[getStepIndex(std::floor(at / beatsPerStep))].filter.load();
+    }
+}
+
+//==============================================================================
+void StepSequencer::setStep(int index, bool gate, float velocity, float filter)
+{
+    if (index < 0 || index >= maxSteps)
+        return;
+
+    steps[index].gate.store(gate);
+    steps[index].velocity.store(juce::jlimit(0.0f, 1.0f, velocity));
+    steps[index].filter.store(juce::jlimit(-1.0f, 1.0f, filter));
+}
+
+bool StepSequencer::getStepGate(int index) const
+{
+    return steps[juce::jlimit(0, maxSteps - 1, index)].gate.load();
+}
+
+float StepSequencer::getStepVelocity(int index) const
+{
+    return steps[juce::jlimit(0, maxSteps - 1, index)].velocity.load();
+}
+
+float StepSequencer::getStepFilter(int index) const
+{
+    return steps[juce::jlimit(0, maxSteps - 1, index)].filter.load();
+}
+
+void StepSequencer::setNumSteps(int newNumSteps)
+{
+    numSteps.store(juce::jlimit(minSteps, maxSteps, newNumSteps));
+}
+
+void StepSequencer::setStepDivision(LFOGenerator::SyncDivision division)
+{
+    stepDivision.store(static_cast<int>(division));
+}
+
+void StepSequencer::setGateLength(float fractionOfStep)
+{
+    gateLength.store(juce::jlimit(0.05f, 1.0f, fractionOfStep));
+}
+
+int StepSequencer::getNumSteps() const
+{
+    return numSteps.load();
+}
+
+LFOGenerator::SyncDivision StepSequencer::getStepDivision() const
+{
+    return static_cast<LFOGenerator::SyncDivision>(stepDivision.load());
+}
+
+float StepSequencer::getGateLength() const
+{
+    return gateLength.load();
+}
+
+//==============================================================================
+void StepSequencer::setHostBPM(double bpm)
+{
+    hostBPM = bpm;
+}
+
+void StepSequencer::setHostPPQPosition(double ppqPosition)
+{
+    position = ppqPosition;
+}
+
+//==============================================================================
+int StepSequencer::getStepIndex(double stepNumber) const
+{
+    // Wraps before the start of the timeline too
+    const int length = numSteps.load();
+    const int index = static_cast<int>(static_cast<juce::int64>(stepNumber) % length);
+    return index < 0 ? index + length : index;
+}
+
+float StepSequencer::getGateTarget(double atPosition, double beatsPerStep, double gateBeats) const
+{
+    const double stepNumber = std::floor(atPosition / beatsPerStep);
+    const Step& step = steps[getStepIndex(stepNumber)];
+
+    const bool open = gateBeats >= beatsPerStep || atPosition - stepNumber * beatsPerStep < gateBeats;
+
+    return step.gate.load() && open ? step.velocity.load() : 0.0f;
+}
+
+void StepSequencer::startRamp(float target)
+{
+    if (target == targetGain)
+        return;
+
+    targetGain = target;
+    rampSamplesRemaining = rampLength;
+    rampIncrement = (targetGain - currentGain) / static_cast<float>(rampLength);
+}
+
+void StepSequencer::renderSpan(float* gain, int numSamples)
+{
+    const int rampSamples = juce::jmin(numSamples, rampSamplesRemaining);
+
+    for (int i = 0; i < rampSamples; ++i)
+    {
+        currentGain += rampIncrement;
+        gain[i] = currentGain;
+    }
+
+    rampSamplesRemaining -= rampSamples;
+    if (rampSamplesRemaining == 0)
+        currentGain = targetGain;
+
+    juce::FloatVectorOperations::fill(gain + rampSamples, currentGain, numSamples - rampSamples);
+}
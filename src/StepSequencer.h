@@ -0,0 +1,98 @@
+#pragma once
+
+#include <JuceHeader.h>
+#include "LFOGenerator.h"
+#include <atomic>
+
+//==============================================================================
+/**
+ * Step sequencer that gates the noise in rhythmic patterns.
+ *
+ * Each step has a gate, a velocity and a filter value. Steps run at a note
+ * division of the host tempo, locked to the host position while the
+ * transport plays and running on by themselves while it is stopped.
+ *
+ * renderGain works out once per block where the next step starts, then
+ * renders the span up to it in one go, so step boundaries are never checked
+ * per sample. Gain changes at a step or at the end of a gate ramp over a
+ * couple of milliseconds to avoid clicks.
+ */
+class StepSequencer
+{
+public:
+    //==============================================================================
+    static constexpr int minSteps = 16;
+    static constexpr int maxSteps = 64;
+
+    //==============================================================================
+    StepSequencer();
+    ~StepSequencer();
+
+    //==============================================================================
+    void prepareToPlay(double sampleRate, int samplesPerBlock);
+    void reset();
+
+    // Writes the block's gain and moves on to the next block
+    void renderGain(float* gain, int numSamples);
+
+    // Writes the filter value of the step playing at each of numValues
+    // samples, spaced interval apart from firstSample, in the block last
+    // passed to renderGain
+    void renderFilterValues(float* values, int firstSample, int interval, int numValues) const;
+
+    //==============================================================================
+    // Can be called from any thread
+    void setStep(int index, bool gate, float velocity, float filter);
+    bool getStepGate(int index) const;
+    float getStepVelocity(int index) const;
+    float getStepFilter(int index) const;
+
+    void setNumSteps(int numSteps);
+    void setStepDivision(LFOGenerator::SyncDivision division);
+    void setGateLength(float fractionOfStep);
+
+    int getNumSteps() const;
+    LFOGenerator::SyncDivision getStepDivision() const;
+    float getGateLength() const;
+
+    //==============================================================================
+    void setHostBPM(double bpm);
+
+    // The host position at the start of the next block
+    void setHostPPQPosition(double ppqPosition);
+
+private:
+    //==============================================================================
+    struct Step
+    {
+        std::atomic<bool> gate { true };
+        std::atomic<float> velocity { 1.0f };
+        std::atomic<float> filter { 0.0f };
+    };
+
+    //==============================================================================
+    double sampleRate;
+    double hostBPM;
+
+    Step steps[maxSteps];
+    std::atomic<int> numSteps;
+    std::atomic<int> stepDivision;
+    std::atomic<float> gateLength;
+
+    // Position in quarter notes, and where the last block started
+    double position;
+    double blockStartPosition;
+
+    // Gain and the ramp towards its target
+    float currentGain;
+    float targetGain;
+    float rampIncrement;
+    int rampSamplesRemaining;
+    int rampLength;
+
+    //==============================================================================
+    int getStepIndex(double stepNumber) const;
+    float getGateTarget(double atPosition, double beatsPerStep, double gateBeats) const;
+    void startRamp(float target);
+    void renderSpan(float* gain, int numSamples);
+};
@@ -0,0 +1,406 @@
+#include "StereoDelay.h"
+
+//==============================================================================
+namespace
+{
+    constexpr double fadeSeconds = 0.02;   // crossfade after a time change
+}
+
+//==============================================================================
+StereoDelay::StereoDelay()
+    : sampleRate(44100.0)
+    , mix(0.0f)                // Default: 0% (off)
+    , division(Division8th)
+    , tempo(120.0)
+    , feedback(0.4f)
+    , pingPong(true)
+    , lowCut(100.0f)
+    , highCut(6000.0f)
+    , ringMask(0)
+    , writePosition(0)
+    , delaySamples(1)
+    , fadeFromDelay(1)
+    , fadeSamplesRemaining(0)
+    , fadeLength(1)
+    , lowpassCoefficient(1.0f)
+    , highpassCoefficient(0.0f)
+    , muted(false)
+    , silenceWritten(0)
+{
+    for (int channel = 0; channel < 2; ++channel)
+    {
+        lowpassState[channel] = 0.0f;
+        highpassState[channel] = 0.0f;
+    }
+}
+
+StereoDelay::~StereoDelay()
+{
+}
+
+//==============================================================================
+void StereoDelay::prepareToPlay(double newSampleRate, int samplesPerBlock)
+{
+    sampleRate = newSampleRate;
+
+    // Sized for the maximum rate, so this only allocates the first time
+    if (ring[0].empty())
+    {
+        const int ringSize = juce::nextPowerOfTwo(static_cast<int>(std::ceil(maxDelaySeconds * maxSampleRate)) + 1);
+
+        for (auto& channelRing : ring)
+            channelRing.assign(static_cast<size_t>(ringSize), 0.0f);
+
+        ringMask = ringSize - 1;
+    }
+
+    const int scratchSize = juce::jmax(1, samplesPerBlock);
+    delayedBuffer.setSize(2, scratchSize, false, false, true);
+    fadeBuffer.setSize(2, scratchSize, false, false, true);
+    writeBuffer.setSize(2, scratchSize, false, false, true);
+
+    fadeLength = juce::jmax(1, static_cast<int>(fadeSeconds * sampleRate));
+    delaySamples = fadeFromDelay = calculateDelaySamples();
+
+    updateFilterCoefficients();
+    reset();
+}
+
+void StereoDelay::processBlock(juce::AudioBuffer<float>& buffer, int numSamples)
+{
+    if (ring[0].empty() || numSamples <= 0)
+        return;
+
+    const int maxDelay = getMaxDelaySamples();
+
+    if (mix <= 0.0f)
+    {
+        if (!muted)
+        {
+            // The echoes stop here; drop the filters and any fade
+            muted = true;
+            silenceWritten = 0;
+            fadeSamplesRemaining = 0;
+            fadeFromDelay = delaySamples;
+
+            for (int channel = 0; channel < 2; ++channel)
+            {
+                lowpassState[channel] = 0.0f;
+                highpassState[channel] = 0.0f;
+            }
+        }
+
+        if (silenceWritten < maxDelay)
+        {
+            const int silence = juce::jmin(numSamples, maxDelay - silenceWritten);
+            clearRing(writePosition, silence);
+            writePosition = (writePosition + silence) & ringMask;
+            silenceWritten += silence;
+        }
+
+        return;
+    }
+
+    if (muted)
+    {
+        // Unmuted before the silence covered every reachable delay: clear
+        // the rest, which is never more than the longest delay
+        if (silenceWritten < maxDelay)
+            clearRing(writePosition - maxDelay, maxDelay - silenceWritten);
+
+        muted = false;
+    }
+
+    updateFilterCoefficients();
+
+    // Start a crossfade to the new time. A change during a fade waits for
+    // it to finish, so at most two read positions are ever live.
+    const int targetDelay = calculateDelaySamples();
+    if (targetDelay != delaySamples && fadeSamplesRemaining == 0)
+    {
+        fadeFromDelay = delaySamples;
+        delaySamples = targetDelay;
+        fadeSamplesRemaining = fadeLength;
+    }
+
+    float* left = buffer.getWritePointer(0);
+    float* right = buffer.getNumChannels() > 1 ? buffer.getWritePointer(1) : nullptr;
+    const int maxChunk = delayedBuffer.getNumSamples();
+
+    // No chunk is longer than a live delay, so a chunk never reads samples
+    // it writes itself
+    int offset = 0;
+    while (offset < numSamples)
+    {
+        int chunk = juce::jmin(numSamples - offset, delaySamples, maxChunk);
+        if (fadeSamplesRemaining > 0)
+            chunk = juce::jmin(chunk, fadeFromDelay);
+
+        processChunk(left + offset, right != nullptr ? right + offset : nullptr, chunk);
+        offset += chunk;
+    }
+}
+
+void StereoDelay::reset()
+{
+    for (auto& channelRing : ring)
+        std::fill(channelRing.begin(), channelRing.end(), 0.0f);
+
+    writePosition = 0;
+    muted = false;
+    silenceWritten = 0;
+    fadeSamplesRemaining = 0;
+    fadeFromDelay = delaySamples;
+
+    for (int channel = 0; channel < 2; ++channel)
+    {
+        lowpassState[channel] = 0.0f;
+        highpassState[channel] = 0.0f;
+    }
+}
+
+//==============================================================================
+void StereoDelay::setMix(float newMix)
+{
+    mix = juce::jlimit(0.0f, 1.0f, newMix);
+}
+
+void StereoDelay::setDivision(Division newDivision)
+{
+    division = static_cast<Division>(juce::jlimit(0, static_cast<int>(NumDivisions) - 1, static_cast<int>(newDivision)));
+}
+
+void StereoDelay::setTempo(double bpm)
+{
+    // Hosts without a tempo report zero; keep the last valid one
+    if (bpm > 0.0)
+        tempo = juce::jlimit(20.0, 999.0, bpm);
+}
+
+void StereoDelay::setFeedback(float newFeedback)
+{
+    feedback = juce::jlimit(0.0f, 0.95f, newFeedback);
+}
+
+void StereoDelay::setPingPong(bool shouldPingPong)
+{
+    pingPong = shouldPingPong;
+}
+
+void StereoDelay::setLowCut(float frequency)
+{
+    lowCut = juce::jlimit(20.0f, 2000.0f, frequency);
+}
+
+void StereoDelay::setHighCut(float frequency)
+{
+    highCut = juce::jlimit(1000.0f, 20000.0f, frequency);
+}
+
+float StereoDelay::getMix() const
+{
+    return mix;
+}
+
+StereoDelay::Division StereoDelay::getDivision() const
+{
+    return division;
+}
+
+float StereoDelay::getFeedback() const
+{
+    return feedback;
+}
+
+bool StereoDelay::getPingPong() const
+{
+    return pingPong;
+}
+
+float StereoDelay::getLowCut() const
+{
+    return lowCut;
+}
+
+float StereoDelay::getHighCut() const
+{
+    return highCut;
+}
+
+double StereoDelay::getTailLengthSeconds() const
+{
+    if (mix <= 0.0f)
+        return 0.0;
+
+    const double delaySeconds = delaySamples / sampleRate;
+    if (feedback <= 0.0f)
+        return delaySeconds;
+
+    const double repeats = std::ceil(std::log(0.001) / std::log(static_cast<double>(feedback)));
+    return delaySeconds * (repeats + 1.0);
+}
+
+double StereoDelay::getDivisionBeats(Division noteDivision)
+{
+    switch (noteDivision)
+    {
+        case Division32nd:            return 0.125;
+        case Division16thTriplet:     return 1.0 / 6.0;
+        case Division16th:            return 0.25;
+        case Division8thTriplet:      return 1.0 / 3.0;
+        case Division16thDotted:      return 0.375;
+        case Division8th:             return 0.5;
+        case DivisionQuarterTriplet:  return 2.0 / 3.0;
+        case Division8thDotted:       return 0.75;
+        case DivisionQuarter:         return 1.0;
+        case DivisionHalfTriplet:     return 4.0 / 3.0;
+        case DivisionQuarterDotted:   return 1.5;
+        case DivisionHalf:            return 2.0;
+        case DivisionWhole:           return 4.0;
+        default:                      return 0.5;
+    }
+}
+
+//==============================================================================
+int StereoDelay::calculateDelaySamples() const
+{
+    const double seconds = juce::jmin(maxDelaySeconds, getDivisionBeats(division) * 60.0 / tempo);
+    const int samples = static_cast<int>(std::round(seconds * sampleRate));
+
+    // Above the maximum rate the ring can't hold the full time
+    return juce::jlimit(1, juce::jmax(1, ringMask), samples);
+}
+
+int StereoDelay::getMaxDelaySamples() const
+{
+    const int samples = static_cast<int>(std::round(maxDelaySeconds * sampleRate));
+    return juce::jlimit(1, juce::jmax(1, ringMask), samples);
+}
+
+void StereoDelay::updateFilterCoefficients()
+{
+    const float nyquistLimit = 0.45f * static_cast<float>(sampleRate);
+
+    lowpassCoefficient = 1.0f - std::exp(-juce::MathConstants<float>::twoPi * juce::jmin(highCut, nyquistLimit) / static_cast<float>(sampleRate));
+    highpassCoefficient = 1.0f - std::exp(-juce::MathConstants<float>::twoPi * lowCut / static_cast<float>(sampleRate));
+}
+
+void StereoDelay::readDelayed(int channel, float* dest, int delay, int numSamples) const
+{
+    const float* source = ring[channel].data();
+    const int start = (writePosition - delay) & ringMask;
+    const int firstPart = juce::jmin(numSamples, ringMask + 1 - start);
+
+    juce::FloatVectorOperations::copy(dest, source + start, firstPart);
+    if (firstPart < numSamples)
+        juce::FloatVectorOperations::copy(dest + firstPart, source, numSamples - firstPart);
+}
+
+void StereoDelay::writeRing(int channel, const float* source, int numSamples)
+{
+    float* dest = ring[channel].data();
+    const int firstPart = juce::jmin(numSamples, ringMask + 1 - writePosition);
+
+    juce::FloatVectorOperations::copy(dest + writePosition, source, firstPart);
+    if (firstPart < numSamples)
+        juce::FloatVectorOperations::copy(dest, source + firstPart, numSamples - firstPart);
+}
+
+void StereoDelay::clearRing(int start, int numSamples)
+{
+    start &= ringMask;
+    const int firstPart = juce::jmin(numSamples, ringMask + 1 - start);
+
+    for (auto& channelRing : ring)
+    {
+        juce::FloatVectorOperations::clear(channelRing.data() + start, firstPart);
+        if (firstPart < numSamples)
+            juce::FloatVectorOperations::clear(channelRing.data(), numSamples - firstPart);
+    }
+}
+
+void StereoDelay::processChunk(float* left, float* right, int numSamples)
+{
+    float* delayed[2] = { delayedBuffer.getWritePointer(0), delayedBuffer.getWritePointer(1) };
+    float* toWrite[2] = { writeBuffer.getWritePointer(0), writeBuffer.getWritePointer(1) };
+    const float* input[2] = { left, right != nullptr ? right : left };
+
+    for (int channel = 0; channel < 2; ++channel)
+        readDelayed(channel, delayed[channel], delaySamples, numSamples);
+
+    // Blend in from the old read position after a time change
+    if (fadeSamplesRemaining > 0)
+    {
+        const int fadeSamples = juce::jmin(numSamples, fadeSamplesRemaining);
+        const float step = 1.0f / static_cast<float>(fadeLength);
+        const float startGain = static_cast<float>(fadeLength - fadeSamplesRemaining) * step;
+
+        for (int channel = 0; channel < 2; ++channel)
+        {
+            float* faded = fadeBuffer.getWritePointer(channel);
+            readDelayed(channel, faded, fadeFromDelay, fadeSamples);
+
+            float* dest = delayed[channel];
+            for (int i = 0; i < fadeSamples; ++i)
+            {
+                const float gain = startGain + static_cast<float>(i + 1) * step;
+                dest[i] = faded[i] + gain * (dest[i] - faded[i]);
+            }
+        }
+
+        fadeSamplesRemaining -= fadeSamples;
+    }
+
+    // Feedback filters: one-pole lowpass, then the input minus a one-pole
+    // lowpass as the highpass. The echoes heard are the filtered ones, so
+    // every repeat is darker and thinner than the last.
+    for (int channel = 0; channel < 2; ++channel)
+    {
+        float* data = delayed[channel];
+        float lowpass = lowpassState[channel];
+        float highpass = highpassState[channel];
+
+        for (int i = 0; i < numSamples; ++i)
+        {
+            lowpass += lowpassCoefficient * (data[i] - lowpass);
+            highpass += highpassCoefficient * (lowpass - highpass);
+            data[i] = lowpass - highpass;
+        }
+
+        lowpassState[channel] = lowpass;
+        highpassState[channel] = highpass;
+    }
+
+    if (pingPong)
+    {
+        // The mono input enters on the left and each repeat crosses over
+        juce::FloatVectorOperations::add(toWrite[0], input[0], input[1], numSamples);
+        juce::FloatVectorOperations::multiply(toWrite[0], 0.5f, numSamples);
+        juce::FloatVectorOperations::addWithMultiply(toWrite[0], delayed[1], feedback, numSamples);
+        juce::FloatVectorOperations::copyWithMultiply(toWrite[1], delayed[0], feedback, numSamples);
+    }
+    else
+    {
+        for (int channel = 0; channel < 2; ++channel)
+        {
+            juce::FloatVectorOperations::copy(toWrite[channel], input[channel], numSamples);
+            juce::FloatVectorOperations::addWithMultiply(toWrite[channel], delayed[channel], feedback, numSamples);
+        }
+    }
+
+    for (int channel = 0; channel < 2; ++channel)
+        writeRing(channel, toWrite[channel], numSamples);
+
+    writePosition = (writePosition + numSamples) & ringMask;
+
+    // Output
+    const float dryGain = 1.0f - mix;
+    juce::FloatVectorOperations::multiply(left, dryGain, numSamples);
+    juce::FloatVectorOperations::addWithMultiply(left, delayed[0], mix, numSamples);
+
+    if (right != nullptr)
+    {
+        juce::FloatVectorOperations::multiply(right, dryGain, numSamples);
+        juce::FloatVectorOperations::addWithMultiply(right, delayed[1], mix, numSamples);
+    }
+}
@@ -0,0 +1,135 @@
+#pragma once
+
+#include <JuceHeader.h>
+#include <vector>
+
+//==============================================================================
+/**
+ * Tempo-synced stereo delay with ping-pong and a filtered feedback path.
+ *
+ * Each channel has a power-of-two ring buffer, sized once for the longest
+ * delay at the highest supported sample rate, so changing the sample rate
+ * never reallocates it. Delay times are whole samples. Blocks are processed
+ * in chunks no longer than the delay, so every read in a chunk comes from
+ * audio written in an earlier chunk: reads and writes are plain copies, and
+ * only the feedback filters run sample by sample.
+ *
+ * A time change (new division or tempo) crossfades from the old read
+ * position to the new one instead of sweeping a fractional read head, so
+ * there's no pitch glide and the static case stays a copy.
+ */
+class StereoDelay
+{
+public:
+    //==============================================================================
+    enum Division
+    {
+        Division32nd = 0,
+        Division16thTriplet,
+        Division16th,
+        Division8thTriplet,
+        Division16thDotted,
+        Division8th,
+        DivisionQuarterTriplet,
+        Division8thDotted,
+        DivisionQuarter,
+        DivisionHalfTriplet,
+        DivisionQuarterDotted,
+        DivisionHalf,
+        DivisionWhole,
+        NumDivisions
+    };
+
+    static constexpr double maxDelaySeconds = 4.0;
+    static constexpr double maxSampleRate = 192000.0;
+
+    //==============================================================================
+    StereoDelay();
+    ~StereoDelay();
+
+    //==============================================================================
+    void prepareToPlay(double sampleRate, int samplesPerBlock);
+    void processBlock(juce::AudioBuffer<float>& buffer, int numSamples);
+    void reset();
+
+    //==============================================================================
+    void setMix(float mix);
+    void setDivision(Division division);
+    void setTempo(double bpm);
+    void setFeedback(float feedback);
+    void setPingPong(bool shouldPingPong);
+    void setLowCut(float frequency);
+    void setHighCut(float frequency);
+
+    float getMix() const;
+    Division getDivision() const;
+    float getFeedback() const;
+    bool getPingPong() const;
+    float getLowCut() const;
+    float getHighCut() const;
+
+    // Time for the repeats to fall 60 dB, or zero when the delay is off
+    double getTailLengthSeconds() const;
+
+    // Length of a division in quarter notes
+    static double getDivisionBeats(Division noteDivision);
+
+private:
+    //==============================================================================
+    // Delay in samples for the current division and tempo, and the longest
+    // any division can reach at the current rate
+    int calculateDelaySamples() const;
+    int getMaxDelaySamples() const;
+    void updateFilterCoefficients();
+
+    // Copies numSamples from the ring, starting delay samples behind the
+    // write position, into dest
+    void readDelayed(int channel, float* dest, int delay, int numSamples) const;
+    void writeRing(int channel, const float* source, int numSamples);
+
+    // Zeroes numSamples of both rings from start onwards
+    void clearRing(int start, int numSamples);
+
+    void processChunk(float* left, float* right, int numSamples);
+
+    //==============================================================================
+    double sampleRate;
+
+    float mix;          // 0 to 1
+    Division division;
+    double tempo;       // BPM
+    float feedback;     // 0 to 0.95
+    bool pingPong;
+    float lowCut;       // Hz, highpass in the feedback path
+    float highCut;      // Hz, lowpass in the feedback path
+
+    // Ring buffers, one per channel
+    std::vector<float> ring[2];
+    int ringMask;
+    int writePosition;
+
+    // Current read offset, and the one being faded out after a change
+    int delaySamples;
+    int fadeFromDelay;
+    int fadeSamplesRemaining;
+    int fadeLength;
+
+    // One-pole feedback filters, per channel
+    float lowpassCoefficient;
+    float highpassCoefficient;
+    float lowpassState[2];
+    float highpassState[2];
+
+    // Scratch for one chunk: delayed signal, faded-out signal, and what gets
+    // written back to the ring
+    juce::AudioBuffer<float> delayedBuffer;
+    juce::AudioBuffer<float> fadeBuffer;
+    juce::AudioBuffer<float> writeBuffer;
+
+    // At zero mix processing is skipped, and silence is written instead
+    // until it covers the longest delay, a block at a time, so the ring is
+    // clear when the mix comes back without one big clear on the audio
+    // thread
+    bool muted;
+    int silenceWritten;
+};
@@ -0,0 +1,232 @@
+#include "TruePeakLimiter.h"
+
+//==============================================================================
+TruePeakLimiter::TruePeakLimiter()
+    : sampleRate(44100.0)
+    , enabled(false)        // Default: off
+    , activeEnabled(false)
+    , ceiling(-1.0f)       // Default: -1 dBTP
+    , release(100.0f)
+    , historyPosition(0)
+    , lastInterpolated(0.0f)
+    , delayMask(0)
+    , delayPosition(0)
+    , windowLength(1)
+    , latencySamples(0)
+    , averagePosition(0)
+    , averageSum(0.0)
+    , envelope(1.0f)
+{
+    // Blackman-windowed sinc, one row per fractional position. Tap t sits
+    // at sample offset t - centre from the sample being interpolated after.
+    const int centre = interpolationTaps / 2 - 1;
+
+    for (int phase = 0; phase < interpolationPhases; ++phase)
+    {
+        const double fraction = static_cast<double>(phase) / interpolationPhases;
+        double sum = 0.0;
+
+        for (int tap = 0; tap < interpolationTaps; ++tap)
+        {
+            const double x = fraction - (tap - centre);
+            const double sinc = std::abs(x) < 1.0e-9 ? 1.0 : std::sin(juce::MathConstants<double>::pi * x) / (juce::MathConstants<double>::pi * x);
+            const double u = x / (interpolationTaps / 2);
+            const double window = std::abs(u) >= 1.0 ? 0.0
+                                : 0.42 + 0.5 * std::cos(juce::MathConstants<double>::pi * u) + 0.08 * std::cos(juce::MathConstants<double>::twoPi * u);
+
+            interpolationTable[phase][tap] = static_cast<float>(sinc * window);
+            sum += sinc * window;
+        }
+
+        // Unity gain at DC for every phase
+        for (int tap = 0; tap < interpolationTaps; ++tap)
+            interpolationTable[phase][tap] = static_cast<float>(interpolationTable[phase][tap] / sum);
+    }
+
+    reset();
+}
+
+TruePeakLimiter::~TruePeakLimiter()
+{
+}
+
+//==============================================================================
+void TruePeakLimiter::prepareToPlay(double newSampleRate, int /*samplesPerBlock*/)
+{
+    sampleRate = newSampleRate;
+
+    windowLength = juce::jmax(1, static_cast<int>(std::round(lookaheadMs * 0.001 * sampleRate)));
+
+    // The interpolator finishes a sample interpolationTaps / 2 late, and the
+    // window then looks W - 1 samples ahead of the output
+    latencySamples = interpolationTaps / 2 + windowLength - 1;
+
+    const int delaySize = juce::nextPowerOfTwo(latencySamples + 1);
+    for (auto& line : delayLine)
+        line.assign(static_cast<size_t>(delaySize), 0.0f);
+    delayMask = delaySize - 1;
+
+    peakWindow.prepare(windowLength);
+    peakWindow.setWindowLength(windowLength);
+    averageRing.assign(static_cast<size_t>(windowLength), 1.0f);
+
+    activeEnabled = enabled;
+    reset();
+}
+
+void TruePeakLimiter::processBlock(juce::AudioBuffer<float>& buffer, int numSamples)
+{
+    if (!activeEnabled || delayLine[0].empty() || numSamples <= 0)
+        return;
+
+    const int numChannels = juce::jmin(buffer.getNumChannels(), 2);
+    float* channelData[2] = { buffer.getWritePointer(0),
+                              numChannels > 1 ? buffer.getWritePointer(1) : nullptr };
+
+    const float ceilingGain = juce::Decibels::decibelsToGain(ceiling);
+    const float candidateLevel = ceilingGain * juce::Decibels::decibelsToGain(-candidateRangeDb);
+    const float releaseCoefficient = std::exp(-1.0f / (release * 0.001f * static_cast<float>(sampleRate)));
+    const double averageScale = 1.0 / windowLength;
+    const int half = interpolationTaps / 2;
+
+    float previousInterpolated = lastInterpolated;
+
+    for (int i = 0; i < numSamples; ++i)
+    {
+        for (int channel = 0; channel < numChannels; ++channel)
+            history[channel][historyPosition] = channelData[channel][i];
+
+        // Sample peak of the sample leaving the interpolator, and of the next
+        const int current = (historyPosition - half) & (historySize - 1);
+        const int next = (current + 1) & (historySize - 1);
+
+        float peak = 0.0f;
+        float nextPeak = 0.0f;
+        for (int channel = 0; channel < numChannels; ++channel)
+        {
+            peak = juce::jmax(peak, std::abs(history[channel][current]));
+            nextPeak = juce::jmax(nextPeak, std::abs(history[channel][next]));
+        }
+
+        // True peak between the two, only when near the ceiling. Each sample
+        // also carries the interval before it, as its gain applies to both.
+        float interpolated = 0.0f;
+        if (juce::jmax(peak, nextPeak) > candidateLevel)
+        {
+            for (int channel = 0; channel < numChannels; ++channel)
+                interpolated = juce::jmax(interpolated, interpolatePeak(history[channel], historyPosition));
+        }
+
+        peak = juce::jmax(peak, interpolated, previousInterpolated);
+        previousInterpolated = interpolated;
+        historyPosition = (historyPosition + 1) & (historySize - 1);
+
+        // Gain for the loudest peak in the window, then its moving average
+        const float windowPeak = peakWindow.process(peak);
+        const float target = windowPeak > ceilingGain ? ceilingGain / windowPeak : 1.0f;
+
+        averageSum += target - averageRing[static_cast<size_t>(averagePosition)];
+        averageRing[static_cast<size_t>(averagePosition)] = target;
+        if (++averagePosition == windowLength)
+            averagePosition = 0;
+
+        const float average = static_cast<float>(averageSum * averageScale);
+        envelope = average < envelope ? average : average + releaseCoefficient * (envelope - average);
+
+        // Delay the audio to line up with its gain
+        const int readPosition = (delayPosition - latencySamples) & delayMask;
+        for (int channel = 0; channel < numChannels; ++channel)
+        {
+            delayLine[channel][static_cast<size_t>(delayPosition)] = channelData[channel][i];
+            channelData[channel][i] = delayLine[channel][static_cast<size_t>(readPosition)] * envelope;
+        }
+
+        delayPosition = (delayPosition + 1) & delayMask;
+    }
+
+    lastInterpolated = previousInterpolated;
+}
+
+void TruePeakLimiter::reset()
+{
+    for (int channel = 0; channel < 2; ++channel)
+    {
+        std::fill(std::begin(history[channel]), std::end(history[channel]), 0.0f);
+        std::fill(delayLine[channel].begin(), delayLine[channel].end(), 0.0f);
+    }
+
+    historyPosition = 0;
+    delayPosition = 0;
+    lastInterpolated = 0.0f;
+
+    peakWindow.reset();
+    std::fill(averageRing.begin(), averageRing.end(), 1.0f);
+    averagePosition = 0;
+    averageSum = static_cast<double>(averageRing.size());
+    envelope = 1.0f;
+}
+
+bool TruePeakLimiter::applyPendingLatency()
+{
+    if (enabled == activeEnabled)
+        return false;
+
+    activeEnabled = enabled;
+    reset();
+    return true;
+}
+
+int TruePeakLimiter::getLatencySamples() const
+{
+    return activeEnabled ? latencySamples : 0;
+}
+
+//==============================================================================
+void TruePeakLimiter::setEnabled(bool shouldBeEnabled)
+{
+    enabled = shouldBeEnabled;
+}
+
+void TruePeakLimiter::setCeiling(float ceilingDb)
+{
+    ceiling = juce::jlimit(-12.0f, 0.0f, ceilingDb);
+}
+
+void TruePeakLimiter::setRelease(float releaseMs)
+{
+    release = juce::jlimit(10.0f, 1000.0f, releaseMs);
+}
+
+bool TruePeakLimiter::isEnabled() const
+{
+    return enabled;
+}
+
+float TruePeakLimiter::getCeiling() const
+{
+    return ceiling;
+}
+
+float TruePeakLimiter::getRelease() const
+{
+    return release;
+}
+
+//==============================================================================
+float TruePeakLimiter::interpolatePeak(const float* channelHistory, int newest) const
+{
+    // Taps run from interpolationTaps - 1 samples behind the newest up to it
+    const int first = newest - (interpolationTaps - 1);
+    float peak = 0.0f;
+
+    for (int phase = 1; phase < interpolationPhases; ++phase)
+    {
+        float sum = 0.0f;
+        for (int tap = 0; tap < interpolationTaps; ++tap)
+            sum += interpolationTable[phase][tap] * channelHistory[(first + tap) & (historySize - 1)];
+
+        peak = juce::jmax(peak, std::abs(sum));
+    }
+
+    return peak;
+}
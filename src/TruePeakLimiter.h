@@ -0,0 +1,95 @@
+#pragma once
+
+#include <JuceHeader.h>
+#include "SlidingMaximum.h"
+#include <vector>
+
+//==============================================================================
+/**
+ * Lookahead true-peak limiter for the end of the chain.
+ *
+ * Each sample's stereo-linked peak is checked against the ceiling. Only
+ * where the signal comes within candidateRangeDb of it, a 4x polyphase FIR
+ * estimates the three points between that sample and the next, so the
+ * interpolator costs nothing on quiet material.
+ *
+ * The gain for each peak is the ceiling over the window maximum, found by a
+ * SlidingMaximum in amortized O(1), then smoothed by a moving average of the
+ * same length. With the audio delayed by the window, the average has fully
+ * reached each peak's gain by the time the peak is output, so the ceiling
+ * holds without overshoot. Release is a one-pole that only ever lowers the
+ * gain further.
+ */
+class TruePeakLimiter
+{
+public:
+    //==============================================================================
+    static constexpr float lookaheadMs = 1.5f;
+    static constexpr float candidateRangeDb = 6.0f;
+
+    //==============================================================================
+    TruePeakLimiter();
+    ~TruePeakLimiter();
+
+    //==============================================================================
+    void prepareToPlay(double sampleRate, int samplesPerBlock);
+    void processBlock(juce::AudioBuffer<float>& buffer, int numSamples);
+    void reset();
+
+    // Applies an enable or disable since the last call. Returns true if the
+    // latency changed.
+    bool applyPendingLatency();
+    int getLatencySamples() const;
+
+    //==============================================================================
+    void setEnabled(bool shouldBeEnabled);
+    void setCeiling(float ceilingDb);
+    void setRelease(float releaseMs);
+
+    bool isEnabled() const;
+    float getCeiling() const;
+    float getRelease() const;
+
+private:
+    //==============================================================================
+    static constexpr int interpolationTaps = 12;    // per phase, 48 taps in all
+    static constexpr int interpolationPhases = 4;
+    static constexpr int historySize = 32;          // power of two, > interpolationTaps
+
+    // Largest of the three interpolated points between the sample
+    // interpolationTaps / 2 behind the newest and the one after it
+    float interpolatePeak(const float* history, int newest) const;
+
+    //==============================================================================
+    double sampleRate;
+
+    bool enabled;
+    bool activeEnabled;    // the state the latency was last reported for
+    float ceiling;         // dB
+    float release;         // ms
+
+    // Polyphase interpolator, phases 1 to 3 (phase 0 is the sample itself)
+    float interpolationTable[interpolationPhases][interpolationTaps];
+
+    // Recent input per channel, for the interpolator
+    float history[2][historySize];
+    int historyPosition;
+    float lastInterpolated;   // true peak of the last interval, carried across blocks
+
+    // Audio delay, one power-of-two ring per channel
+    std::vector<float> delayLine[2];
+    int delayMask;
+    int delayPosition;
+
+    int windowLength;      // lookahead window W, in samples
+    int latencySamples;    // interpolator lag plus W - 1
+
+    SlidingMaximum peakWindow;
+
+    // Moving average of the window gains
+    std::vector<float> averageRing;
+    int averagePosition;
+    double averageSum;
+
+    float envelope;        // gain after release smoothing
+};
@@ -0,0 +1,421 @@
+#include "VoiceEngine.h"
+#include <climits>
+
+//==============================================================================
+namespace
+{
+    // Filter cutoff as a multiple of the note's frequency, from zero to full
+    // velocity
+    constexpr float minKeyTrackRatio = 8.0f;
+    constexpr float maxKeyTrackRatio = 16.0f;
+    constexpr float filterDamping = 1.41421356f;   // 1 / Q, Butterworth
+
+    constexpr float noiseScale = 1.0f / 2147483648.0f;
+
+    juce::uint32 makeSeed(juce::uint32 counter, int channel)
+    {
+        // Spread consecutive counters across the state space; never zero
+        juce::uint32 seed = (counter + 1) * 0x9e3779b9u ^ static_cast<juce::uint32>(channel + 1) * 0x85ebca6bu;
+        return seed != 0 ? seed : 0x5eed;
+    }
+}
+
+//==============================================================================
+VoiceEngine::VoiceEngine()
+    : sampleRate(44100.0)
+    , attackTime(10.0f)
+    , decayTime(100.0f)
+    , sustainLevel(0.7f)
+    , releaseTime(500.0f)
+    , attackCurve(0.0f)
+    , decayCurve(0.0f)
+    , releaseCurve(0.0f)
+    , oneShot(false)
+    , numActiveVoices(0)
+    , noteCounter(0)
+{
+    for (int voice = 0; voice < maxVoices; ++voice)
+    {
+        noteNumber[voice] = -1;
+        startOrder[voice] = 0;
+        stage[voice] = Finished;
+        released[voice] = false;
+        segmentSamplesRemaining[voice] = INT_MAX;
+        segmentEndLevel[voice] = 0.0f;
+        velocity[voice] = 0.0f;
+        level[voice] = 0.0f;
+        envelopeTarget[voice] = 0.0f;
+        envelopeDistance[voice] = 0.0f;
+        envelopeMultiplier[voice] = 1.0f;
+        envelopeStep[voice] = 0.0f;
+        filterA1[voice] = filterA2[voice] = filterA3[voice] = 0.0f;
+
+        for (int channel = 0; channel < 2; ++channel)
+        {
+            noiseState[channel][voice] = makeSeed(static_cast<juce::uint32>(voice), channel);
+            filterState1[channel][voice] = 0.0f;
+            filterState2[channel][voice] = 0.0f;
+        }
+    }
+}
+
+VoiceEngine::~VoiceEngine()
+{
+}
+
+//==============================================================================
+void VoiceEngine::prepareToPlay(double newSampleRate, int /*samplesPerBlock*/)
+{
+    sampleRate = newSampleRate;
+    reset();
+}
+
+void VoiceEngine::renderBlock(juce::AudioBuffer<float>& buffer, int numSamples)
+{
+    float* left = buffer.getWritePointer(0);
+    float* right = buffer.getNumChannels() > 1 ? buffer.getWritePointer(1) : nullptr;
+
+    juce::FloatVectorOperations::clear(left, numSamples);
+    if (right != nullptr)
+        juce::FloatVectorOperations::clear(right, numSamples);
+
+    int position = 0;
+
+    while (position < numSamples && numActiveVoices > 0)
+    {
+        // Run up to the next transition of any voice
+        int run = numSamples - position;
+        for (int voice = 0; voice < numActiveVoices; ++voice)
+            run = juce::jmin(run, segmentSamplesRemaining[voice]);
+
+        renderRun(left + position, right != nullptr ? right + position : nullptr, run);
+        position += run;
+
+        // Advance finished segments. Backwards, so a finished voice can be
+        // swapped with the last active one.
+        for (int voice = numActiveVoices - 1; voice >= 0; --voice)
+        {
+            if (segmentSamplesRemaining[voice] != INT_MAX)
+                segmentSamplesRemaining[voice] -= run;
+
+            if (segmentSamplesRemaining[voice] > 0)
+                continue;
+
+            level[voice] = segmentEndLevel[voice];
+
+            if (stage[voice] == Attack)
+            {
+                enterStage(voice, Decay);
+            }
+            else if (stage[voice] == Decay)
+            {
+                enterStage(voice, oneShot || released[voice] ? Release : Sustain);
+            }
+            else
+            {
+                stage[voice] = Finished;
+                swapVoices(voice, numActiveVoices - 1);
+                --numActiveVoices;
+            }
+        }
+    }
+}
+
+void VoiceEngine::reset()
+{
+    allNotesOff();
+
+    for (int voice = 0; voice < maxVoices; ++voice)
+    {
+        for (int channel = 0; channel < 2; ++channel)
+        {
+            filterState1[channel][voice] = 0.0f;
+            filterState2[channel][voice] = 0.0f;
+        }
+    }
+}
+
+//==============================================================================
+void VoiceEngine::noteOn(int midiNoteNumber, float newVelocity)
+{
+    int voice = -1;
+
+    // Retrigger a voice still holding this note
+    for (int i = 0; i < numActiveVoices; ++i)
+    {
+        if (noteNumber[i] == midiNoteNumber && !released[i])
+        {
+            voice = i;
+            break;
+        }
+    }
+
+    if (voice < 0 && numActiveVoices < maxVoices)
+    {
+        voice = numActiveVoices++;
+        level[voice] = 0.0f;
+
+        for (int channel = 0; channel < 2; ++channel)
+        {
+            filterState1[channel][voice] = 0.0f;
+            filterState2[channel][voice] = 0.0f;
+        }
+    }
+
+    // A stolen voice keeps its level and filter state, so the attack starts
+    // from where it was instead of clicking to zero
+    if (voice < 0)
+        voice = findVoiceToSteal();
+
+    startVoice(voice, midiNoteNumber, newVelocity);
+}
+
+void VoiceEngine::noteOff(int midiNoteNumber)
+{
+    for (int voice = 0; voice < numActiveVoices; ++voice)
+    {
+        if (noteNumber[voice] != midiNoteNumber || released[voice])
+            continue;
+
+        released[voice] = true;
+
+        // Attack and decay run to the end first, as in EnvelopeGenerator
+        if (stage[voice] == Sustain)
+            enterStage(voice, Release);
+    }
+}
+
+void VoiceEngine::allNotesOff()
+{
+    for (int voice = 0; voice < numActiveVoices; ++voice)
+    {
+        stage[voice] = Finished;
+        level[voice] = 0.0f;
+    }
+
+    numActiveVoices = 0;
+}
+
+//==============================================================================
+void VoiceEngine::setParameters(float attackTimeMs, float decayTimeMs, float newSustainLevel, float releaseTimeMs)
+{
+    // Takes effect from each voice's next segment
+    attackTime = attackTimeMs;
+    decayTime = decayTimeMs;
+    sustainLevel = juce::jlimit(0.0f, 1.0f, newSustainLevel);
+    releaseTime = releaseTimeMs;
+}
+
+void VoiceEngine::setCurves(float newAttackCurve, float newDecayCurve, float newReleaseCurve)
+{
+    attackCurve = juce::jlimit(-1.0f, 1.0f, newAttackCurve);
+    decayCurve = juce::jlimit(-1.0f, 1.0f, newDecayCurve);
+    releaseCurve = juce::jlimit(-1.0f, 1.0f, newReleaseCurve);
+}
+
+void VoiceEngine::setOneShot(bool isOneShot)
+{
+    oneShot = isOneShot;
+}
+
+int VoiceEngine::getNumActiveVoices() const
+{
+    return numActiveVoices;
+}
+
+//==============================================================================
+void VoiceEngine::enterStage(int voice, Stage newStage)
+{
+    stage[voice] = newStage;
+    const float samplesPerMs = static_cast<float>(sampleRate) * 0.001f;
+
+    switch (newStage)
+    {
+        case Attack:
+            beginSegment(voice, 1.0f, 1.0f / (attackTime * samplesPerMs), attackCurve);
+            break;
+
+        case Decay:
+            beginSegment(voice, sustainLevel, (1.0f - sustainLevel) / (decayTime * samplesPerMs), decayCurve);
+            break;
+
+        case Release:
+            beginSegment(voice, 0.0f, 1.0f / (releaseTime * samplesPerMs), releaseCurve);
+            break;
+
+        case Sustain:
+        case Finished:
+            // Hold the level until released
+            envelopeTarget[voice] = 0.0f;
+            envelopeDistance[voice] = level[voice];
+            envelopeMultiplier[voice] = 1.0f;
+            envelopeStep[voice] = 0.0f;
+            segmentSamplesRemaining[voice] = INT_MAX;
+            break;
+    }
+}
+
+void VoiceEngine::beginSegment(int voice, float endLevel, float rate, float curve)
+{
+    const float startLevel = level[voice];
+    const float distance = endLevel - startLevel;
+
+    // Same timing and curve shapes as EnvelopeGenerator::beginSegment
+    const int numSamples = rate > 0.0f
+        ? juce::jmax(1, static_cast<int>(std::ceil(std::abs(distance) / rate)))
+        : 1;
+
+    segmentSamplesRemaining[voice] = numSamples;
+    segmentEndLevel[voice] = endLevel;
+
+    if (std::abs(curve) < 0.01f || std::abs(distance) <= 1.0e-6f)
+    {
+        envelopeTarget[voice] = 0.0f;
+        envelopeDistance[voice] = startLevel;
+        envelopeMultiplier[voice] = 1.0f;
+        envelopeStep[voice] = distance / static_cast<float>(numSamples);
+        return;
+    }
+
+    const float overshoot = 1.0f / (std::exp(8.0f * std::abs(curve)) - 1.0f);
+    const float target = curve > 0.0f ? endLevel + distance * overshoot
+                                      : startLevel - distance * overshoot;
+
+    envelopeTarget[voice] = target;
+    envelopeDistance[voice] = startLevel - target;
+    envelopeMultiplier[voice] = std::pow((endLevel - target) / (startLevel - target), 1.0f / static_cast<float>(numSamples));
+    envelopeStep[voice] = 0.0f;
+}
+
+void VoiceEngine::startVoice(int voice, int midiNoteNumber, float newVelocity)
+{
+    noteNumber[voice] = midiNoteNumber;
+    velocity[voice] = juce::jlimit(0.0f, 1.0f, newVelocity);
+    startOrder[voice] = noteCounter;
+    released[voice] = false;
+
+    for (int channel = 0; channel < 2; ++channel)
+        noiseState[channel][voice] = makeSeed(noteCounter, channel);
+
+    ++noteCounter;
+
+    // Key-tracked lowpass, brighter with velocity (TPT state variable filter)
+    const float noteFrequency = static_cast<float>(juce::MidiMessage::getMidiNoteInHertz(midiNoteNumber));
+    const float ratio = minKeyTrackRatio + (maxKeyTrackRatio - minKeyTrackRatio) * velocity[voice];
+    const float cutoff = juce::jlimit(20.0f, 0.45f * static_cast<float>(sampleRate), noteFrequency * ratio);
+
+    const float g = std::tan(juce::MathConstants<float>::pi * cutoff / static_cast<float>(sampleRate));
+    filterA1[voice] = 1.0f / (1.0f + g * (g + filterDamping));
+    filterA2[voice] = g * filterA1[voice];
+    filterA3[voice] = g * filterA2[voice];
+
+    enterStage(voice, Attack);
+}
+
+void VoiceEngine::swapVoices(int a, int b)
+{
+    if (a == b)
+        return;
+
+    std::swap(noteNumber[a], noteNumber[b]);
+    std::swap(startOrder[a], startOrder[b]);
+    std::swap(stage[a], stage[b]);
+    std::swap(released[a], released[b]);
+    std::swap(segmentSamplesRemaining[a], segmentSamplesRemaining[b]);
+    std::swap(segmentEndLevel[a], segmentEndLevel[b]);
+    std::swap(velocity[a], velocity[b]);
+    std::swap(level[a], level[b]);
+    std::swap(envelopeTarget[a], envelopeTarget[b]);
+    std::swap(envelopeDistance[a], envelopeDistance[b]);
+    std::swap(envelopeMultiplier[a], envelopeMultiplier[b]);
+    std::swap(envelopeStep[a], envelopeStep[b]);
+    std::swap(filterA1[a], filterA1[b]);
+    std::swap(filterA2[a], filterA2[b]);
+    std::swap(filterA3[a], filterA3[b]);
+
+    for (int channel = 0; channel < 2; ++channel)
+    {
+        std::swap(noiseState[channel][a], noiseState[channel][b]);
+        std::swap(filterState1[channel][a], filterState1[channel][b]);
+        std::swap(filterState2[channel][a], filterState2[channel][b]);
+    }
+}
+
+int VoiceEngine::findVoiceToSteal() const
+{
+    // The quietest released voice, or failing that the oldest
+    int quietest = -1;
+    int oldest = 0;
+
+    for (int voice = 0; voice < numActiveVoices; ++voice)
+    {
+        if (released[voice] && (quietest < 0 || level[voice] < level[quietest]))
+            quietest = voice;
+
+        // Unsigned difference, so the counter can wrap
+        if (noteCounter - startOrder[voice] > noteCounter - startOrder[oldest])
+            oldest = voice;
+    }
+
+    return quietest >= 0 ? quietest : oldest;
+}
+
+void VoiceEngine::renderRun(float* left, float* right, int numSamples)
+{
+    const int lanes = numActiveVoices;
+
+    for (int i = 0; i < numSamples; ++i)
+    {
+        alignas(32) float gain[maxVoices];
+        alignas(32) float output[2][maxVoices];
+
+        // Envelopes: one multiply and one add per voice
+        for (int voice = 0; voice < lanes; ++voice)
+        {
+            envelopeDistance[voice] = envelopeDistance[voice] * envelopeMultiplier[voice] + envelopeStep[voice];
+            gain[voice] = (envelopeTarget[voice] + envelopeDistance[voice]) * velocity[voice];
+        }
+
+        // Noise (xorshift) through each voice's filter
+        for (int channel = 0; channel < 2; ++channel)
+        {
+            juce::uint32* state = noiseState[channel];
+            float* s1 = filterState1[channel];
+            float* s2 = filterState2[channel];
+
+            for (int voice = 0; voice < lanes; ++voice)
+            {
+                juce::uint32 x = state[voice];
+                x ^= x << 13;
+                x ^= x >> 17;
+                x ^= x << 5;
+                state[voice] = x;
+
+                const float noise = static_cast<float>(static_cast<juce::int32>(x)) * noiseScale;
+
+                const float v3 = noise - s2[voice];
+                const float v1 = filterA1[voice] * s1[voice] + filterA2[voice] * v3;
+                const float v2 = s2[voice] + filterA2[voice] * s1[voice] + filterA3[voice] * v3;
+                s1[voice] = 2.0f * v1 - s1[voice];
+                s2[voice] = 2.0f * v2 - s2[voice];
+
+                output[channel][voice] = v2 * gain[voice];
+            }
+        }
+
+        float sumLeft = 0.0f;
+        float sumRight = 0.0f;
+        for (int voice = 0; voice < lanes; ++voice)
+        {
+            sumLeft += output[0][voice];
+            sumRight += output[1][voice];
+        }
+
+        left[i] = sumLeft;
+        if (right != nullptr)
+            right[i] = sumRight;
+    }
+
+    for (int voice = 0; voice < lanes; ++voice)
+        level[voice] = envelopeTarget[voice] + envelopeDistance[voice];
+}
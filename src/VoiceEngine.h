@@ -0,0 +1,112 @@
+#pragma once
+
+#include <JuceHeader.h>
+
+//==============================================================================
+/**
+ * Fixed-capacity polyphonic noise voices.
+ *
+ * Each voice has its own noise seed, ADSR envelope, key-tracked lowpass and
+ * velocity. Voice state is stored as structure-of-arrays and the active
+ * voices are kept packed at the front, so every per-sample update runs
+ * across voices as SIMD lanes and idle voices are never touched. A voice
+ * that finishes is swapped with the last active one.
+ *
+ * Blocks are rendered in runs that end at the next envelope transition of
+ * any voice. Within a run every envelope is the same recurrence,
+ * distance = distance * multiplier + step, which covers linear (multiplier
+ * 1) and curved (step 0) segments alike, so the lanes never branch.
+ *
+ * Voices are white noise, stereo, shaped only by their own filter; the
+ * global noise type applies to the mono source.
+ */
+class VoiceEngine
+{
+public:
+    //==============================================================================
+    static constexpr int maxVoices = 16;
+
+    //==============================================================================
+    VoiceEngine();
+    ~VoiceEngine();
+
+    //==============================================================================
+    void prepareToPlay(double sampleRate, int samplesPerBlock);
+
+    // Overwrites the first two channels with the sum of the active voices
+    void renderBlock(juce::AudioBuffer<float>& buffer, int numSamples);
+    void reset();
+
+    //==============================================================================
+    // Starts a voice, retriggering one already playing this note or stealing
+    // one if all are in use
+    void noteOn(int midiNoteNumber, float velocity);
+    void noteOff(int midiNoteNumber);
+    void allNotesOff();
+
+    //==============================================================================
+    void setParameters(float attackTimeMs, float decayTimeMs, float sustainLevel, float releaseTimeMs);
+    void setCurves(float attackCurve, float decayCurve, float releaseCurve);
+    void setOneShot(bool isOneShot);
+
+    int getNumActiveVoices() const;
+
+private:
+    //==============================================================================
+    enum Stage
+    {
+        Attack,
+        Decay,
+        Sustain,
+        Release,
+        Finished
+    };
+
+    // Sets up a voice's next envelope segment from its current level
+    void enterStage(int voice, Stage newStage);
+    void beginSegment(int voice, float endLevel, float rate, float curve);
+
+    // Renders numSamples in which no voice changes stage
+    void renderRun(float* left, float* right, int numSamples);
+    void startVoice(int voice, int midiNoteNumber, float velocity);
+    void swapVoices(int a, int b);
+    int findVoiceToSteal() const;
+
+    //==============================================================================
+    double sampleRate;
+
+    float attackTime;   // ms
+    float decayTime;    // ms
+    float sustainLevel; // 0 to 1
+    float releaseTime;  // ms
+    float attackCurve;  // -1 to 1, as in EnvelopeGenerator
+    float decayCurve;
+    float releaseCurve;
+    bool oneShot;
+
+    int numActiveVoices;
+    juce::uint32 noteCounter;   // for stealing the oldest voice
+
+    // Per-voice state, active voices packed into [0, numActiveVoices)
+    int noteNumber[maxVoices];
+    juce::uint32 startOrder[maxVoices];
+    Stage stage[maxVoices];
+    bool released[maxVoices];
+    int segmentSamplesRemaining[maxVoices];   // large while sustaining
+    float segmentEndLevel[maxVoices];
+
+    alignas(32) float velocity[maxVoices];
+    alignas(32) float level[maxVoices];
+    alignas(32) float envelopeTarget[maxVoices];
+    alignas(32) float envelopeDistance[maxVoices];   // level - target
+    alignas(32) float envelopeMultiplier[maxVoices];
+    alignas(32) float envelopeStep[maxVoices];
+
+    // Noise and filter, one lane per voice for each channel
+    alignas(32) juce::uint32 noiseState[2][maxVoices];
+    alignas(32) float filterA1[maxVoices];
+    alignas(32) float filterA2[maxVoices];
+    alignas(32) float filterA3[maxVoices];
+    alignas(32) float filterState1[2][maxVoices];
+    alignas(32) float filterState2[2][maxVoices];
+};
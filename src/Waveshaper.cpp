@@ -0,0 +1,222 @@
+#include "Waveshaper.h"
+
+//==============================================================================
+Waveshaper::Waveshaper()
+    : writeIndex(0)
+    , readIndex(1)
+    , publishedIndex(2)
+    , currentCurve(Tanh)
+    , drive(0.0f)
+    , morphing(false)
+    , morphPosition(0.0f)
+{
+    morphDrive[0] = morphDrive[1] = 0.0f;
+    
+    bakeTable(edited.drive, drive.load());
+    bakeTable(edited.morphA, morphDrive[0]);
+    bakeTable(edited.morphB, morphDrive[1]);
+    publish();
+    applyPendingTable();
+}
+
+Waveshaper::~Waveshaper()
+{
+}
+
+//==============================================================================
+void Waveshaper::setCurve(Curve curve)
+{
+    if (curve != getCurve())
+    {
+        currentCurve.store(curve);
+        
+        bakeTable(edited.drive, drive.load());
+        bakeTable(edited.morphA, morphDrive[0]);
+        bakeTable(edited.morphB, morphDrive[1]);
+        publish();
+    }
+}
+
+void Waveshaper::setDrive(float newDrive)
+{
+    newDrive = juce::jlimit(0.0f, 1.0f, newDrive);
+    
+    if (newDrive != drive.load())
+    {
+        drive.store(newDrive);
+        bakeTable(edited.drive, newDrive);
+        publish();
+    }
+}
+
+void Waveshaper::setMorphDrives(float driveA, float driveB)
+{
+    driveA = juce::jlimit(0.0f, 1.0f, driveA);
+    driveB = juce::jlimit(0.0f, 1.0f, driveB);
+    
+    if (driveA != morphDrive[0] || driveB != morphDrive[1])
+    {
+        morphDrive[0] = driveA;
+        morphDrive[1] = driveB;
+        
+        bakeTable(edited.morphA, driveA);
+        bakeTable(edited.morphB, driveB);
+        publish();
+    }
+}
+
+Waveshaper::Curve Waveshaper::getCurve() const
+{
+    return static_cast<Curve>(currentCurve.load());
+}
+
+float Waveshaper::getDrive() const
+{
+    return drive.load();
+}
+
+//==============================================================================
+void Waveshaper::applyPendingTable()
+{
+    if ((publishedIndex.load(std::memory_order_relaxed) & newTableFlag) == 0)
+        return;
+    
+    readIndex = publishedIndex.exchange(readIndex, std::memory_order_acq_rel) & ~newTableFlag;
+}
+
+void Waveshaper::setMorphPosition(float position)
+{
+    morphing = true;
+    morphPosition = juce::jlimit(0.0f, 1.0f, position);
+}
+
+void Waveshaper::endMorph()
+{
+    morphing = false;
+}
+
+void Waveshaper::bakeTable(float* table, float tableDrive) const
+{
+    const float step = 2.0f * inputRange / static_cast<float>(tableSize);
+    
+    // The drive stage is bypassed at zero drive, so a morph to or from it
+    // fades towards the dry signal
+    if (tableDrive <= 0.0f)
+    {
+        for (int i = 0; i <= tableSize; ++i)
+            table[i] = -inputRange + step * static_cast<float>(i);
+    }
+    else
+    {
+        // Same gain staging as the analytic tanh drive: 1x to 10x into the
+        // curve, with makeup gain to compensate for the level increase
+        const float driveAmount = 1.0f + tableDrive * 9.0f;
+        const float makeupGain = 1.0f / (0.5f * tableDrive + 0.5f);
+        const Curve curve = getCurve();
+        
+        for (int i = 0; i <= tableSize; ++i)
+        {
+            const float x = -inputRange + step * static_cast<float>(i);
+            table[i] = evaluateCurve(curve, x * driveAmount) * makeupGain;
+        }
+    }
+    
+    table[tableSize + 1] = table[tableSize];
+}
+
+void Waveshaper::publish()
+{
+    tables[writeIndex] = edited;
+    
+    // Publish, and take back whichever slot was published before
+    writeIndex = publishedIndex.exchange(writeIndex | newTableFlag, std::memory_order_acq_rel) & ~newTableFlag;
+}
+
+float Waveshaper::lookup(const float* table, int index, float fraction)
+{
+    const float a = table[index];
+    const float b = table[index + 1];
+    return a + fraction * (b - a);
+}
+
+void Waveshaper::processBlock(float* data, int numSamples) const
+{
+    const float scale = static_cast<float>(tableSize) / (2.0f * inputRange);
+    const float offset = inputRange * scale;
+    const float maxPosition = static_cast<float>(tableSize);
+    const Tables& current = tables[readIndex];
+    
+    // Branch-free: clamp, split into index and fraction, interpolate
+    if (!morphing)
+    {
+        for (int i = 0; i < numSamples; ++i)
+        {
+            const float position = juce::jlimit(0.0f, maxPosition, data[i] * scale + offset);
+            const int index = static_cast<int>(position);
+            data[i] = lookup(current.drive, index, position - static_cast<float>(index));
+        }
+        
+        return;
+    }
+    
+    // Mid-morph, both snapshot tables share the index and fraction
+    for (int i = 0; i < numSamples; ++i)
+    {
+        const float position = juce::jlimit(0.0f, maxPosition, data[i] * scale + offset);
+        const int index = static_cast<int>(position);
+        const float fraction = position - static_cast<float>(index);
+        
+        const float a = lookup(current.morphA, index, fraction);
+        const float b = lookup(current.morphB, index, fraction);
+        data[i] = a + morphPosition * (b - a);
+    }
+}
+
+//==============================================================================
+float Waveshaper::evaluateCurve(Curve curve, float x)
+{
+    switch (curve)
+    {
+        case SoftClip:
+        {
+            // Cubic soft clipper, smooth at the +/-1 knee
+            if (std::abs(x) >= 1.0f)
+                return x > 0.0f ? 1.0f : -1.0f;
+            
+            return 1.5f * (x - x * x * x / 3.0f);
+        }
+        
+        case HardClip:
+            return juce::jlimit(-1.0f, 1.0f, x);
+        
+        case Tube:
+        {
+            // Biased tanh: the bias makes the curve asymmetric for even
+            // harmonics, and subtracting tanh(bias) keeps silence silent
+            const float bias = 0.35f;
+            return std::tanh(x + bias) - std::tanh(bias);
+        }
+        
+        case Foldback:
+        {
+            // Triangle wavefolder: identity inside +/-1, reflected beyond
+            const float wrapped = std::fmod(x + 1.0f, 4.0f);
+            const float phase = wrapped < 0.0f ? wrapped + 4.0f : wrapped;
+            return 1.0f - std::abs(phase - 2.0f);
+        }
+        
+        case Diode:
+        {
+            // Single diode: the forward half saturates softly, the reverse
+            // half only leaks through
+            if (x >= 0.0f)
+                return 1.0f - std::exp(-x);
+            
+            return 0.2f * (std::exp(x) - 1.0f);
+        }
+        
+        case Tanh:
+        default:
+            return std::tanh(x);
+    }
+}
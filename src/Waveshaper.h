@@ -0,0 +1,105 @@
+#pragma once
+
+#include <JuceHeader.h>
+#include <atomic>
+
+//==============================================================================
+/**
+ * Table-driven waveshaper for the drive stage.
+ *
+ * The selected curve, including the drive gain and makeup gain, is baked into
+ * a lookup table whenever the curve or drive changes. Processing is then a
+ * linear interpolation into that table, so every curve costs the same no
+ * matter how expensive its formula is.
+ *
+ * The tables are baked on the message thread and published to the audio
+ * thread through a triple buffer, as the multi-stage envelope's shapes are.
+ * The audio thread only picks up the latest set.
+ *
+ * For the preset morph, two more tables are baked at snapshot A's and B's
+ * drive. While a morph is running the audio thread crossfades their
+ * outputs instead of baking a table for every drive in between.
+ */
+class Waveshaper
+{
+public:
+    //==============================================================================
+    enum Curve
+    {
+        Tanh = 0,
+        SoftClip,
+        HardClip,
+        Tube,
+        Foldback,
+        Diode,
+        NumCurves
+    };
+
+    //==============================================================================
+    Waveshaper();
+    ~Waveshaper();
+
+    //==============================================================================
+    // Bake and publish new tables. Message thread only.
+    void setCurve(Curve curve);
+    void setDrive(float drive);
+    void setMorphDrives(float driveA, float driveB);
+    
+    Curve getCurve() const;
+    float getDrive() const;
+
+    //==============================================================================
+    // Picks up a table published since the last call. Audio thread only,
+    // once per block before processBlock.
+    void applyPendingTable();
+    
+    // Crossfades the tables baked by setMorphDrives, 0 being A and 1 being
+    // B, until endMorph. Audio thread only.
+    void setMorphPosition(float position);
+    void endMorph();
+    
+    void processBlock(float* data, int numSamples) const;
+    
+    //==============================================================================
+    // Unscaled transfer function of a curve, used to bake the table
+    static float evaluateCurve(Curve curve, float x);
+
+private:
+    //==============================================================================
+    // The table spans [-inputRange, inputRange] in tableSize steps, so zero
+    // falls exactly on a point. Inputs outside the range are clamped.
+    static constexpr int tableSize = 4096;
+    static constexpr float inputRange = 4.0f;
+    
+    // Triple buffer slots: the writer owns one, the reader one, and the
+    // third is the latest published. newTableFlag marks it as not yet read.
+    static constexpr int newTableFlag = 4;
+    
+    // One guard point past the end so interpolation never reads out of range
+    struct Tables
+    {
+        float drive[tableSize + 2];
+        float morphA[tableSize + 2];
+        float morphB[tableSize + 2];
+    };
+    
+    // Bakes the current curve at the given drive into one table
+    void bakeTable(float* table, float tableDrive) const;
+    void publish();
+    
+    static float lookup(const float* table, int index, float fraction);
+    
+    Tables edited;                    // the writer's copy
+    Tables tables[3];
+    int writeIndex;                   // owned by the writer
+    int readIndex;                    // owned by the audio thread
+    std::atomic<int> publishedIndex;  // slot index, plus newTableFlag
+    
+    std::atomic<int> currentCurve;
+    std::atomic<float> drive;   // 0 to 1
+    float morphDrive[2];        // message thread only
+    
+    // Audio thread only
+    bool morphing;
+    float morphPosition;
+};